@@ -3,9 +3,11 @@
 #include <WiFi.h>
 
 #include "config/AppConfig.h"
-#include "gps/GpsService.h"
+#include "logging/Log.h"
 #include "modem/ModemCommands.h"
 #include "net/GeoUploader.h"
+#include "power/PowerManager.h"
+#include "tasks/AppTasks.h"
 #include "wifi/WifiManager.h"
 
 namespace {
@@ -24,13 +26,6 @@ void initializeModemDiagnostics() {
   sim_at_cmd("AT+CIMI");
 }
 
-// 将 USB 串口输入透传到模组串口，方便直接发送 AT 指令
-void forwardUsbToModem() {
-  if (Serial.available()) {
-    AppConfig::modemSerial().write(Serial.read());
-  }
-}
-
 }  // namespace
 
 void setup() {
@@ -40,6 +35,8 @@ void setup() {
   delay(500);
 
   Serial.begin(115200);
+  Log::begin();
+  PowerManager::begin();
   pinMode(AppConfig::MCU_LED, OUTPUT);
   digitalWrite(AppConfig::MCU_LED, HIGH);
   Serial.println("\n\n\n\n-----------------------\nSystem started!!!!");
@@ -53,19 +50,17 @@ void setup() {
     Serial.println("WiFi unavailable, will retry in loop");
   }
 
-  // 配置与蜂窝模组的串口并执行自检，再预热 GPS
+  // 配置与蜂窝模组的串口并执行自检
   AppConfig::modemSerial().begin(
     AppConfig::MCU_SIM_BAUDRATE, SERIAL_8N1, AppConfig::MCU_SIM_RX_PIN, AppConfig::MCU_SIM_TX_PIN);
   initializeModemDiagnostics();
   WifiManager::ensureConnected();
-  GpsService::warmup();
+
+  // 启动 FreeRTOS 任务：模组串口(含 USB 透传)、GNSS 采样(负责预热)、上传、联网/配置门户
+  AppTasks::start();
 }
 
 void loop() {
-  // 主循环中保持串口转发、网络连通以及上传逻辑
-  forwardUsbToModem();
-  WifiManager::ensureConnected();
-  WifiManager::loop();
-  GeoUploader::flushBuffer();
-  GeoUploader::handleUpdate();
+  // 所有业务都已拆分到独立任务中，Arduino 主循环任务不再需要
+  vTaskDelete(nullptr);
 }
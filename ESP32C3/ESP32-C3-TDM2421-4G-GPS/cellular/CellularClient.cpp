@@ -3,7 +3,9 @@
 #include <cstring>
 
 #include "../config/AppConfig.h"
+#include "../logging/Log.h"
 #include "../modem/ModemCommands.h"
+#include "../modem/ModemTask.h"
 #include "../net/GeoPayload.h"
 #include "../net/UrlParser.h"
 
@@ -12,6 +14,7 @@ namespace {
 bool cellularContextReady = false;
 bool cellularSocketOpen = false;
 unsigned long lastCellularReadyCheck = 0;
+uint32_t cellularReadyGeneration = 0;
 
 bool qiactResponseHasContext(const String& response) {
     String needle = "+QIACT: " + String(AppConfig::CELL_CONTEXT_ID) + ",";
@@ -23,12 +26,13 @@ bool waitForSimReady(uint32_t timeoutMs) {
     while (millis() - start < timeoutMs) {
         String response;
         if (sim_at_cmd_with_response("AT+CPIN?", response, 2000) && response.indexOf("READY") != -1) {
-            Serial.println("SIM ready");
+            LOG_I(Cellular, "SIM ready");
             return true;
         }
+        ModemTask::yieldToUrgent();
         delay(1000);
     }
-    Serial.println("SIM not ready before timeout");
+    LOG_W(Cellular, "SIM not ready before timeout");
     return false;
 }
 
@@ -43,13 +47,14 @@ bool waitForCellularRegistration(uint32_t timeoutMs) {
         for (size_t i = 0; i < sizeof(REG_COMMANDS) / sizeof(REG_COMMANDS[0]); ++i) {
             String response;
             if (sim_at_cmd_with_response(REG_COMMANDS[i], response, 3000) && registrationIndicatesAttached(response)) {
-                Serial.printf("Network attached via %s -> %s\n", REG_COMMANDS[i], response.c_str());
+                LOG_I(Cellular, "Network attached via %s -> %s", REG_COMMANDS[i], response.c_str());
                 return true;
             }
         }
+        ModemTask::yieldToUrgent();
         delay(AppConfig::CELL_REG_CHECK_INTERVAL_MS);
     }
-    Serial.println("Network registration timeout");
+    LOG_W(Cellular, "Network registration timeout");
     return false;
 }
 
@@ -70,13 +75,13 @@ bool cellularOpenSocket(const ParsedUrl& parsed) {
                      ",\"TCP\",\"" + parsed.host + "\"," + String(parsed.port) + ",0,1";
     String response;
     if (!sim_at_cmd_with_response(openCmd, response, AppConfig::CELL_SOCKET_OP_TIMEOUT_MS)) {
-        Serial.println("AT+QIOPEN command failed");
+        LOG_W(Cellular, "AT+QIOPEN command failed");
         return false;
     }
     if (!waitForSubstring("+QIOPEN: " + String(AppConfig::CELL_SOCKET_ID) + ",0",
                           AppConfig::CELL_SOCKET_OP_TIMEOUT_MS,
                           nullptr)) {
-        Serial.println("Socket open URC not received");
+        LOG_W(Cellular, "Socket open URC not received");
         return false;
     }
     cellularSocketOpen = true;
@@ -85,13 +90,13 @@ bool cellularOpenSocket(const ParsedUrl& parsed) {
 
 bool cellularSendRequest(const String& request) {
     if (!sim_at_cmd_expect("AT+QISEND=" + String(AppConfig::CELL_SOCKET_ID), ">", 5000, nullptr)) {
-        Serial.println("QISEND prompt not received");
+        LOG_W(Cellular, "QISEND prompt not received");
         return false;
     }
     AppConfig::modemSerial().print(request);
     AppConfig::modemSerial().write(0x1A);
     if (!waitForSubstring("SEND OK", AppConfig::CELL_SOCKET_OP_TIMEOUT_MS, nullptr)) {
-        Serial.println("SEND OK not received");
+        LOG_W(Cellular, "SEND OK not received");
         return false;
     }
     return true;
@@ -188,12 +193,12 @@ bool ensureReady() {
     }
     String response;
     if (!sim_at_cmd_with_response("AT", response, 2000)) {
-        Serial.println("Cellular module not responding to AT");
+        LOG_W(Cellular, "Cellular module not responding to AT");
         return false;
     }
     sim_at_cmd_with_response("ATE0", response, 2000);
     if (!sim_at_cmd_with_response("AT+CFUN=1", response, 10000)) {
-        Serial.println("Failed to set CFUN=1");
+        LOG_W(Cellular, "Failed to set CFUN=1");
         return false;
     }
     sim_at_cmd_with_response("AT+QCFG=\"roamservice\",2", response, 5000);
@@ -213,51 +218,57 @@ bool ensureReady() {
         String pdpCmd =
             "AT+CGDCONT=" + String(AppConfig::CELL_CONTEXT_ID) + ",\"IP\",\"" + String(AppConfig::CELL_APN) + "\"";
         if (!sim_at_cmd_with_response(pdpCmd, response, 5000)) {
-            Serial.println("Failed to set PDP context");
+            LOG_W(Cellular, "Failed to set PDP context");
             return false;
         }
         String apnCmd = "AT+QICSGP=" + String(AppConfig::CELL_CONTEXT_ID) + ",1,\"" + String(AppConfig::CELL_APN) +
                         "\",\"" + String(AppConfig::CELL_APN_USER) + "\",\"" + String(AppConfig::CELL_APN_PASS) +
                         "\",1";
         if (!sim_at_cmd_with_response(apnCmd, response, 5000)) {
-            Serial.println("Failed to configure APN");
+            LOG_W(Cellular, "Failed to configure APN");
             return false;
         }
         String actCmd = "AT+QIACT=" + String(AppConfig::CELL_CONTEXT_ID);
         if (!sim_at_cmd_with_response(actCmd, response, AppConfig::CELL_ATTACH_TIMEOUT_MS)) {
-            Serial.println("Failed to activate PDP context");
+            LOG_W(Cellular, "Failed to activate PDP context");
             return false;
         }
         if (!sim_at_cmd_with_response("AT+QIACT?", response, 5000) || !qiactResponseHasContext(response)) {
-            Serial.println("PDP context not active after QIACT");
+            LOG_W(Cellular, "PDP context not active after QIACT");
             return false;
         }
     }
     cellularContextReady = true;
     lastCellularReadyCheck = millis();
-    Serial.println("Cellular context ready");
+    ++cellularReadyGeneration;
+    LOG_I(Cellular, "Cellular context ready");
     return true;
 }
 
+uint32_t readyGeneration() {
+    return cellularReadyGeneration;
+}
+
 bool upload(const GpsFix& fix) {
     if (AppConfig::CELL_APN[0] == '\0') {
-        Serial.println("CELL_APN not configured, skip cellular upload");
+        LOG_W(Cellular, "CELL_APN not configured, skip cellular upload");
         return false;
     }
     String fullUrl =
         String(AppConfig::GEO_SENSOR_API_BASE_URL) + "/device/geoSensor/" + String(AppConfig::GEO_SENSOR_ID) + "/";
     ParsedUrl parsed;
     if (!parseUrl(fullUrl, parsed)) {
-        Serial.println("Failed to parse geoSensor URL");
+        LOG_W(Cellular, "Failed to parse geoSensor URL");
         return false;
     }
     if (parsed.https) {
-        Serial.println("Cellular fallback currently supports HTTP only");
+        LOG_W(Cellular, "Cellular fallback currently supports HTTP only");
         return false;
     }
     if (!ensureReady()) {
         return false;
     }
+    ModemTask::yieldToUrgent();
     if (!cellularOpenSocket(parsed)) {
         return false;
     }
@@ -276,18 +287,18 @@ bool upload(const GpsFix& fix) {
     bool success = false;
     if (cellularSendRequest(request)) {
         if (!waitForCellularRecv(AppConfig::CELL_SOCKET_OP_TIMEOUT_MS)) {
-            Serial.println("Timed out waiting for HTTP response over cellular");
+            LOG_W(Cellular, "Timed out waiting for HTTP response over cellular");
         }
         String httpResponse;
         if (readCellularHttpResponse(httpResponse)) {
             int statusCode = parseHttpStatusCode(httpResponse);
-            Serial.printf("Cellular geoSensor HTTP status: %d\n", statusCode);
+            LOG_DEFERRED(Info, Cellular, "Cellular geoSensor HTTP status: %d", statusCode);
             success = statusCode >= 200 && statusCode < 300;
             if (!success) {
-                Serial.println(httpResponse);
+                LOG_W(Cellular, "%s", httpResponse.c_str());
             }
         } else {
-            Serial.println("Failed to read HTTP payload from modem");
+            LOG_W(Cellular, "Failed to read HTTP payload from modem");
         }
     }
     cellularCloseSocket();
@@ -5,6 +5,9 @@
 namespace CellularClient {
 
 bool ensureReady();
+// Bumped each time ensureReady() runs the full modem bring-up; sessions opened under an
+// older generation may not have survived it.
+uint32_t readyGeneration();
 bool upload(const GpsFix& fix);
 
 }  // namespace CellularClient
@@ -0,0 +1,476 @@
+#include "CoapClient.h"
+
+#include <string.h>
+
+#include "../config/AppConfig.h"
+#include "../logging/Log.h"
+#include "../modem/ModemCommands.h"
+#include "../modem/ModemTask.h"
+#include "../net/CborWriter.h"
+#include "../net/GeoPayload.h"
+#include "CellularClient.h"
+
+namespace {
+
+// RFC 7252 / RFC 7959 wire constants.
+constexpr uint8_t COAP_VERSION = 1;
+constexpr uint8_t COAP_TYPE_CON = 0;
+constexpr uint8_t COAP_TYPE_ACK = 2;
+constexpr uint8_t COAP_TYPE_RST = 3;
+constexpr uint8_t COAP_CODE_EMPTY = 0x00;
+constexpr uint8_t COAP_CODE_POST = 0x02;
+constexpr uint8_t COAP_CODE_CONTINUE = 0x5F;  // 2.31
+constexpr uint16_t COAP_OPTION_URI_PATH = 11;
+constexpr uint16_t COAP_OPTION_CONTENT_FORMAT = 12;
+constexpr uint16_t COAP_OPTION_URI_QUERY = 15;
+constexpr uint16_t COAP_OPTION_BLOCK1 = 27;
+constexpr uint16_t COAP_CONTENT_FORMAT_CBOR = 60;
+constexpr uint8_t COAP_PAYLOAD_MARKER = 0xFF;
+constexpr uint8_t COAP_TOKEN_LENGTH = 4;
+constexpr size_t COAP_BLOCK_SIZE = static_cast<size_t>(1) << (AppConfig::COAP_BLOCK_SZX + 4);
+
+static_assert(AppConfig::COAP_BLOCK_SZX <= 6, "CoAP block size exponent must be 0..6");
+static_assert(COAP_BLOCK_SIZE + 128 <= AppConfig::COAP_MAX_DATAGRAM, "datagram buffer too small for one block");
+
+struct CoapResponse {
+    uint8_t type;
+    uint8_t code;
+    uint16_t messageId;
+    uint8_t token[8];
+    uint8_t tokenLength;
+};
+
+bool coapSocketOpen = false;
+bool coapMessageIdSeeded = false;
+uint16_t coapNextMessageId = 0;
+uint8_t coapDatagram[AppConfig::COAP_MAX_DATAGRAM];
+uint8_t coapInbound[AppConfig::COAP_MAX_DATAGRAM];
+uint8_t coapBody[AppConfig::COAP_MAX_BODY];
+
+String coapSocketId() {
+    return String(AppConfig::COAP_SOCKET_ID);
+}
+
+uint16_t takeCoapMessageId() {
+    if (!coapMessageIdSeeded) {
+        coapNextMessageId = static_cast<uint16_t>(esp_random());
+        coapMessageIdSeeded = true;
+    }
+    return coapNextMessageId++;
+}
+
+bool coapOpenSocket() {
+    if (coapSocketOpen) {
+        return true;
+    }
+    if (!CellularClient::ensureReady()) {
+        return false;
+    }
+    String openCmd = "AT+QIOPEN=" + String(AppConfig::CELL_CONTEXT_ID) + "," + coapSocketId() + ",\"UDP\",\"" +
+                     String(AppConfig::COAP_SERVER_HOST) + "\"," + String(AppConfig::COAP_SERVER_PORT) + ",0,0";
+    String response;
+    if (!sim_at_cmd_with_response(openCmd, response, AppConfig::CELL_SOCKET_OP_TIMEOUT_MS)) {
+        LOG_W(Cellular, "AT+QIOPEN (UDP) command failed");
+        return false;
+    }
+    String result;
+    if (!waitForUrcLine("+QIOPEN: " + coapSocketId() + ",", AppConfig::CELL_SOCKET_OP_TIMEOUT_MS, result) ||
+        result.toInt() != 0) {
+        LOG_W(Cellular, "UDP socket open failed: %s", result.c_str());
+        return false;
+    }
+    coapSocketOpen = true;
+    return true;
+}
+
+bool coapSendDatagram(const uint8_t* data, size_t length) {
+    String sendCmd = "AT+QISEND=" + coapSocketId() + "," + String(static_cast<unsigned>(length));
+    if (!sim_at_cmd_expect(sendCmd, ">", 5000, nullptr)) {
+        LOG_W(Cellular, "QISEND (UDP) prompt not received");
+        return false;
+    }
+    AppConfig::modemSerial().write(data, length);
+    if (!waitForSubstring("SEND OK", AppConfig::CELL_SOCKET_OP_TIMEOUT_MS, nullptr)) {
+        LOG_W(Cellular, "SEND OK not received for CoAP datagram");
+        return false;
+    }
+    return true;
+}
+
+int readModemByte(unsigned long deadline) {
+    while (static_cast<long>(deadline - millis()) > 0) {
+        if (AppConfig::modemSerial().available()) {
+            return AppConfig::modemSerial().read();
+        }
+        delay(1);
+    }
+    return -1;
+}
+
+// The datagram is binary, so it cannot go through the String based helpers: read the
+// "+QIRD: <len>" header as text, then exactly <len> raw bytes.
+bool coapReadDatagram(uint8_t* out, size_t capacity, size_t& length) {
+    length = 0;
+    LOG_D(Modem, "> AT+QIRD=%u,%u", static_cast<unsigned>(AppConfig::COAP_SOCKET_ID), static_cast<unsigned>(capacity));
+    AppConfig::modemSerial().println("AT+QIRD=" + coapSocketId() + "," + String(static_cast<unsigned>(capacity)));
+    unsigned long deadline = millis() + AppConfig::CELL_SOCKET_OP_TIMEOUT_MS;
+    String header;
+    while (true) {
+        int c = readModemByte(deadline);
+        if (c < 0) {
+            return false;
+        }
+        header += static_cast<char>(c);
+        int marker = header.indexOf("+QIRD: ");
+        if (marker != -1 && header.endsWith("\n")) {
+            length = static_cast<size_t>(header.substring(marker + 7).toInt());
+            break;
+        }
+        if (header.indexOf("ERROR") != -1) {
+            return false;
+        }
+    }
+    if (length > capacity) {
+        return false;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        int c = readModemByte(deadline);
+        if (c < 0) {
+            return false;
+        }
+        out[i] = static_cast<uint8_t>(c);
+    }
+    waitForSubstring("OK", 1000, nullptr);
+    return length > 0;
+}
+
+bool parseCoapResponse(const uint8_t* data, size_t length, CoapResponse& response) {
+    if (length < 4 || (data[0] >> 6) != COAP_VERSION) {
+        return false;
+    }
+    response.type = (data[0] >> 4) & 0x03;
+    response.tokenLength = data[0] & 0x0F;
+    response.code = data[1];
+    response.messageId = static_cast<uint16_t>((data[2] << 8) | data[3]);
+    if (response.tokenLength > sizeof(response.token) || 4 + response.tokenLength > length) {
+        return false;
+    }
+    memcpy(response.token, data + 4, response.tokenLength);
+    return true;
+}
+
+class CoapMessageBuilder {
+public:
+    CoapMessageBuilder(uint8_t* buffer, size_t capacity) : buffer_(buffer), capacity_(capacity) {}
+
+    void header(uint8_t type, uint8_t code, uint16_t messageId, const uint8_t* token, uint8_t tokenLength) {
+        put(static_cast<uint8_t>((COAP_VERSION << 6) | (type << 4) | tokenLength));
+        put(code);
+        put(static_cast<uint8_t>(messageId >> 8));
+        put(static_cast<uint8_t>(messageId));
+        putBytes(token, tokenLength);
+    }
+
+    // Options must be added in ascending number order (delta encoding).
+    void option(uint16_t number, const uint8_t* value, size_t valueLength) {
+        uint16_t delta = number - lastOption_;
+        lastOption_ = number;
+        size_t headerIndex = length_;
+        put(0);
+        uint8_t deltaNibble = extendedNibble(delta);
+        uint8_t lengthNibble = extendedNibble(valueLength);
+        if (headerIndex < capacity_) {
+            buffer_[headerIndex] = static_cast<uint8_t>((deltaNibble << 4) | lengthNibble);
+        }
+        putExtended(deltaNibble, delta);
+        putExtended(lengthNibble, valueLength);
+        putBytes(value, valueLength);
+    }
+
+    void option(uint16_t number, const char* text) {
+        option(number, reinterpret_cast<const uint8_t*>(text), strlen(text));
+    }
+
+    void optionUint(uint16_t number, uint32_t value) {
+        uint8_t bytes[4];
+        size_t count = 0;
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            uint8_t b = static_cast<uint8_t>(value >> shift);
+            if (count > 0 || b != 0) {
+                bytes[count++] = b;
+            }
+        }
+        option(number, bytes, count);
+    }
+
+    void payload(const uint8_t* data, size_t dataLength) {
+        if (dataLength == 0) {
+            return;
+        }
+        put(COAP_PAYLOAD_MARKER);
+        putBytes(data, dataLength);
+    }
+
+    bool ok() const {
+        return !overflow_;
+    }
+
+    size_t length() const {
+        return length_;
+    }
+
+private:
+    static uint8_t extendedNibble(size_t value) {
+        return value < 13 ? static_cast<uint8_t>(value) : value < 269 ? 13 : 14;
+    }
+
+    void putExtended(uint8_t nibble, size_t value) {
+        if (nibble == 13) {
+            put(static_cast<uint8_t>(value - 13));
+        } else if (nibble == 14) {
+            put(static_cast<uint8_t>((value - 269) >> 8));
+            put(static_cast<uint8_t>(value - 269));
+        }
+    }
+
+    void put(uint8_t value) {
+        putBytes(&value, 1);
+    }
+
+    void putBytes(const uint8_t* data, size_t dataLength) {
+        if (overflow_ || dataLength > capacity_ - length_) {
+            overflow_ = true;
+            return;
+        }
+        memcpy(buffer_ + length_, data, dataLength);
+        length_ += dataLength;
+    }
+
+    uint8_t* buffer_;
+    size_t capacity_;
+    size_t length_ = 0;
+    uint16_t lastOption_ = 0;
+    bool overflow_ = false;
+};
+
+size_t buildCoapPost(const char* resource, const uint8_t* token, uint16_t messageId, const uint8_t* body,
+                     size_t bodyLength, bool blockwise, uint32_t blockNumber, bool moreBlocks) {
+    static const String authQuery = "k=" + String(AppConfig::GEO_SENSOR_KEY);
+    CoapMessageBuilder message(coapDatagram, sizeof(coapDatagram));
+    message.header(COAP_TYPE_CON, COAP_CODE_POST, messageId, token, COAP_TOKEN_LENGTH);
+    message.option(COAP_OPTION_URI_PATH, "device");
+    message.option(COAP_OPTION_URI_PATH, "geoSensor");
+    message.option(COAP_OPTION_URI_PATH, AppConfig::GEO_SENSOR_ID);
+    if (resource != nullptr) {
+        message.option(COAP_OPTION_URI_PATH, resource);
+    }
+    message.optionUint(COAP_OPTION_CONTENT_FORMAT, COAP_CONTENT_FORMAT_CBOR);
+    message.option(COAP_OPTION_URI_QUERY, authQuery.c_str());
+    if (blockwise) {
+        message.optionUint(COAP_OPTION_BLOCK1,
+                           (blockNumber << 4) | (moreBlocks ? 0x08 : 0x00) | AppConfig::COAP_BLOCK_SZX);
+    }
+    message.payload(body, bodyLength);
+    return message.ok() ? message.length() : 0;
+}
+
+void sendCoapEmptyAck(uint16_t messageId) {
+    uint8_t ack[4];
+    CoapMessageBuilder message(ack, sizeof(ack));
+    message.header(COAP_TYPE_ACK, COAP_CODE_EMPTY, messageId, nullptr, 0);
+    coapSendDatagram(ack, message.length());
+}
+
+bool coapTokenMatches(const CoapResponse& response, const uint8_t* token) {
+    return response.tokenLength == COAP_TOKEN_LENGTH && memcmp(response.token, token, COAP_TOKEN_LENGTH) == 0;
+}
+
+bool waitForCoapDatagram(uint32_t timeoutMs, size_t& length) {
+    String marker = "+QIURC: \"recv\"," + coapSocketId();
+    if (!waitForSubstring(marker, timeoutMs, nullptr)) {
+        return false;
+    }
+    return coapReadDatagram(coapInbound, sizeof(coapInbound), length);
+}
+
+// Sends one confirmable request and returns the response code, or 0 when no response
+// arrived after COAP_MAX_RETRANSMIT retransmissions. Handles both piggybacked responses
+// and an empty ACK followed by a separate CON response.
+uint8_t coapExchange(size_t requestLength, uint16_t messageId, const uint8_t* token) {
+    uint32_t timeoutMs = AppConfig::COAP_ACK_TIMEOUT_MS + esp_random() % (AppConfig::COAP_ACK_TIMEOUT_MS / 2 + 1);
+    bool acknowledged = false;
+    for (uint8_t attempt = 0; attempt <= AppConfig::COAP_MAX_RETRANSMIT && !acknowledged; ++attempt) {
+        if (attempt > 0) {
+            LOG_DEFERRED(Debug, Cellular, "CoAP retransmit %d of message %u", attempt, messageId);
+        }
+        if (!coapSendDatagram(coapDatagram, requestLength)) {
+            return 0;
+        }
+        unsigned long sentAt = millis();
+        while (true) {
+            unsigned long elapsed = millis() - sentAt;
+            if (elapsed >= timeoutMs) {
+                break;
+            }
+            size_t length = 0;
+            CoapResponse response;
+            if (!waitForCoapDatagram(timeoutMs - elapsed, length) ||
+                !parseCoapResponse(coapInbound, length, response)) {
+                continue;
+            }
+            // Our ACK was lost but the separate response already came back.
+            if (response.type == COAP_TYPE_CON && coapTokenMatches(response, token) &&
+                response.code != COAP_CODE_EMPTY) {
+                sendCoapEmptyAck(response.messageId);
+                return response.code;
+            }
+            if (response.messageId == messageId && response.type == COAP_TYPE_RST) {
+                LOG_W(Cellular, "CoAP message %u reset by server", static_cast<unsigned>(messageId));
+                return 0;
+            }
+            if (response.messageId == messageId && response.type == COAP_TYPE_ACK) {
+                if (response.code != COAP_CODE_EMPTY) {
+                    return response.code;
+                }
+                acknowledged = true;
+                break;
+            }
+        }
+        timeoutMs *= 2;
+    }
+    if (!acknowledged) {
+        return 0;
+    }
+    unsigned long waitStart = millis();
+    while (true) {
+        unsigned long elapsed = millis() - waitStart;
+        if (elapsed >= AppConfig::COAP_SEPARATE_RESPONSE_TIMEOUT_MS) {
+            break;
+        }
+        size_t length = 0;
+        CoapResponse response;
+        if (!waitForCoapDatagram(AppConfig::COAP_SEPARATE_RESPONSE_TIMEOUT_MS - elapsed, length) ||
+            !parseCoapResponse(coapInbound, length, response)) {
+            continue;
+        }
+        if (coapTokenMatches(response, token) && response.code != COAP_CODE_EMPTY) {
+            if (response.type == COAP_TYPE_CON) {
+                sendCoapEmptyAck(response.messageId);
+            }
+            return response.code;
+        }
+    }
+    return 0;
+}
+
+bool coapCodeIsSuccess(uint8_t code) {
+    return (code >> 5) == 2;
+}
+
+// Bodies up to one block go out as a single datagram; larger ones use Block1 with the
+// server answering 2.31 Continue for every block but the last.
+bool coapPost(const char* resource, const uint8_t* body, size_t bodyLength) {
+    if (!coapOpenSocket()) {
+        return false;
+    }
+    uint8_t token[COAP_TOKEN_LENGTH];
+    uint32_t tokenBits = esp_random();
+    memcpy(token, &tokenBits, sizeof(token));
+    bool blockwise = bodyLength > COAP_BLOCK_SIZE;
+    size_t offset = 0;
+    uint32_t blockNumber = 0;
+    do {
+        size_t chunk = blockwise ? min(COAP_BLOCK_SIZE, bodyLength - offset) : bodyLength;
+        bool moreBlocks = blockwise && offset + chunk < bodyLength;
+        uint16_t messageId = takeCoapMessageId();
+        size_t requestLength =
+            buildCoapPost(resource, token, messageId, body + offset, chunk, blockwise, blockNumber, moreBlocks);
+        if (requestLength == 0) {
+            LOG_W(Cellular, "CoAP request does not fit datagram buffer");
+            return false;
+        }
+        uint8_t code = coapExchange(requestLength, messageId, token);
+        if (code == 0) {
+            LOG_W(Cellular, "CoAP message %u not acknowledged, closing socket", static_cast<unsigned>(messageId));
+            CoapClient::closeSocket();
+            return false;
+        }
+        if (moreBlocks ? code != COAP_CODE_CONTINUE : !coapCodeIsSuccess(code)) {
+            LOG_W(Cellular, "CoAP block %u rejected with %u.%02u", static_cast<unsigned>(blockNumber),
+                  static_cast<unsigned>(code >> 5), static_cast<unsigned>(code & 0x1F));
+            return false;
+        }
+        offset += chunk;
+        ++blockNumber;
+        ModemTask::yieldToUrgent();
+    } while (offset < bodyLength);
+    LOG_DEFERRED(Info, Cellular, "CoAP upload done, %u bytes in %u block(s)", static_cast<unsigned>(bodyLength),
+                 static_cast<unsigned>(blockNumber));
+    return true;
+}
+
+}  // namespace
+
+namespace CoapClient {
+
+bool upload(const GpsFix& fix) {
+    bool encodeFailed = false;
+    return uploadBatch(&fix, 1, encodeFailed) == 1;
+}
+
+size_t uploadBatch(const GpsFix* fixes, size_t count, bool& encodeFailed) {
+    encodeFailed = false;
+    if (count == 0) {
+        return 0;
+    }
+    // The items go after room for the largest array header; once we know how many fit, the
+    // (possibly shorter) header for that count is written directly in front of them.
+    uint8_t header[9];
+    CborWriter headerWriter(header, sizeof(header));
+    headerWriter.writeArrayHeader(count);
+    size_t reserved = headerWriter.length();
+    CborWriter writer(coapBody + reserved, sizeof(coapBody) - reserved);
+    size_t fitted = 0;
+    size_t firstLength = 0;
+    size_t itemsLength = 0;
+    while (fitted < count) {
+        encodeGeoSensorCbor(writer, fixes[fitted], "4g");
+        if (!writer.ok()) {
+            break;
+        }
+        itemsLength = writer.length();
+        if (fitted == 0) {
+            firstLength = itemsLength;
+        }
+        ++fitted;
+    }
+    if (fitted == 0) {
+        LOG_W(Cellular, "CBOR payload overflow, fix cannot be encoded");
+        encodeFailed = true;
+        return 0;
+    }
+    if (fitted < count) {
+        LOG_DEFERRED(Info, Cellular, "CBOR batch holds %u of %u fixes, sending prefix", static_cast<unsigned>(fitted),
+                     static_cast<unsigned>(count));
+    }
+    // A single fix goes to the plain resource as a bare map, like a live upload.
+    if (fitted == 1) {
+        return coapPost(nullptr, coapBody + reserved, firstLength) ? 1 : 0;
+    }
+    CborWriter fittedHeader(header, sizeof(header));
+    fittedHeader.writeArrayHeader(fitted);
+    size_t start = reserved - fittedHeader.length();
+    memcpy(coapBody + start, header, fittedHeader.length());
+    return coapPost("fixes", coapBody + start, fittedHeader.length() + itemsLength) ? fitted : 0;
+}
+
+void closeSocket() {
+    if (!coapSocketOpen) {
+        return;
+    }
+    String response;
+    sim_at_cmd_with_response("AT+QICLOSE=" + coapSocketId(), response, 5000);
+    coapSocketOpen = false;
+}
+
+}  // namespace CoapClient
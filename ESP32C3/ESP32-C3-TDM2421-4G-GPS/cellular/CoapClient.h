@@ -0,0 +1,13 @@
+#pragma once
+
+#include "../gps/GpsTypes.h"
+
+namespace CoapClient {
+
+bool upload(const GpsFix& fix);
+// Sends the longest prefix of fixes whose CBOR encoding fits COAP_MAX_BODY and returns how many
+// were delivered. encodeFailed is set when not even fixes[0] fits; nothing is sent then.
+size_t uploadBatch(const GpsFix* fixes, size_t count, bool& encodeFailed);
+void closeSocket();
+
+}  // namespace CoapClient
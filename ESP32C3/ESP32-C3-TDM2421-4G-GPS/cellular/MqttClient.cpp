@@ -0,0 +1,200 @@
+#include "MqttClient.h"
+
+#include "../config/AppConfig.h"
+#include "../logging/Log.h"
+#include "../modem/ModemCommands.h"
+#include "../modem/ModemTask.h"
+#include "../net/GeoPayload.h"
+#include "CellularClient.h"
+
+namespace {
+
+static_assert(2 + AppConfig::MQTT_BATCH_SIZE * (AppConfig::MQTT_FIX_MAX_JSON + 1) <= AppConfig::MQTT_MAX_PAYLOAD,
+              "a full MQTT batch must fit the QMTPUBEX payload limit");
+
+bool mqttSessionUp = false;
+uint32_t mqttSessionGeneration = 0;
+uint16_t mqttNextMessageId = 1;
+
+String mqttClientIndex() {
+    return String(AppConfig::MQTT_CLIENT_INDEX);
+}
+
+String mqttTopic(const char* suffix) {
+    return String(AppConfig::MQTT_TOPIC_PREFIX) + String(AppConfig::GEO_SENSOR_ID) + suffix;
+}
+
+uint16_t takeMqttMessageId() {
+    uint16_t id = mqttNextMessageId;
+    mqttNextMessageId = mqttNextMessageId == 0xFFFF ? 1 : mqttNextMessageId + 1;
+    return id;
+}
+
+void configureMqttClient() {
+    String response;
+    String idx = mqttClientIndex();
+    sim_at_cmd_with_response("AT+QMTCFG=\"version\"," + idx + ",4", response);
+    sim_at_cmd_with_response("AT+QMTCFG=\"pdpcid\"," + idx + "," + String(AppConfig::CELL_CONTEXT_ID), response);
+    sim_at_cmd_with_response("AT+QMTCFG=\"keepalive\"," + idx + "," + String(AppConfig::MQTT_KEEPALIVE_S), response);
+    // clean_session=0: the broker keeps our QoS1 state across reconnects.
+    sim_at_cmd_with_response("AT+QMTCFG=\"session\"," + idx + ",0", response);
+}
+
+bool openMqttNetwork() {
+    String idx = mqttClientIndex();
+    String openCmd = "AT+QMTOPEN=" + idx + ",\"" + String(AppConfig::MQTT_BROKER_HOST) + "\"," +
+                     String(AppConfig::MQTT_BROKER_PORT);
+    String response;
+    if (!sim_at_cmd_with_response(openCmd, response, 5000)) {
+        LOG_W(Cellular, "AT+QMTOPEN command failed");
+        return false;
+    }
+    String result;
+    if (!waitForUrcLine("+QMTOPEN: " + idx + ",", AppConfig::MQTT_CONNECT_TIMEOUT_MS, result)) {
+        LOG_W(Cellular, "MQTT open URC not received");
+        return false;
+    }
+    // 2 = identifier already open, which is fine after a lost CONNECT.
+    int code = result.toInt();
+    if (code != 0 && code != 2) {
+        LOG_DEFERRED(Warn, Cellular, "MQTT open failed with code %d", code);
+        return false;
+    }
+    return true;
+}
+
+bool connectMqttClient() {
+    String idx = mqttClientIndex();
+    String connCmd = "AT+QMTCONN=" + idx + ",\"" + String(AppConfig::GEO_SENSOR_ID) + "\",\"" +
+                     String(AppConfig::GEO_SENSOR_ID) + "\",\"" + String(AppConfig::GEO_SENSOR_KEY) + "\"";
+    String response;
+    if (!sim_at_cmd_with_response(connCmd, response, 5000)) {
+        LOG_W(Cellular, "AT+QMTCONN command failed");
+        return false;
+    }
+    String result;
+    if (!waitForUrcLine("+QMTCONN: " + idx + ",", AppConfig::MQTT_CONNECT_TIMEOUT_MS, result)) {
+        LOG_W(Cellular, "MQTT connect URC not received");
+        return false;
+    }
+    if (!result.startsWith("0,0")) {
+        LOG_W(Cellular, "MQTT connect rejected: %s", result.c_str());
+        return false;
+    }
+    return true;
+}
+
+// AT+QMTCONN? lists "+QMTCONN: <idx>,<state>" for open clients; state 3 is connected.
+bool mqttClientConnected() {
+    String response;
+    if (!sim_at_cmd_with_response("AT+QMTCONN?", response, 5000)) {
+        return false;
+    }
+    return response.indexOf("+QMTCONN: " + mqttClientIndex() + ",3") != -1;
+}
+
+bool publishMqttPayload(const String& topic, const String& payload) {
+    if (!MqttClient::ensureSession()) {
+        return false;
+    }
+    String idx = mqttClientIndex();
+    uint16_t messageId = takeMqttMessageId();
+    String pubCmd = "AT+QMTPUBEX=" + idx + "," + String(messageId) + ",1,0,\"" + topic + "\"," +
+                    String(payload.length());
+    if (!sim_at_cmd_expect(pubCmd, ">", 5000, nullptr)) {
+        LOG_W(Cellular, "QMTPUBEX prompt not received");
+        MqttClient::closeSession();
+        return false;
+    }
+    AppConfig::modemSerial().print(payload);
+    String urcPrefix = "+QMTPUBEX: " + idx + "," + String(messageId) + ",";
+    String result;
+    // result 1 means the modem is retransmitting; a final 0 or 2 follows.
+    for (uint8_t attempt = 0; attempt <= AppConfig::MQTT_PUBLISH_RETRANSMIT_WAITS; ++attempt) {
+        if (!waitForUrcLine(urcPrefix, AppConfig::MQTT_PUBLISH_TIMEOUT_MS, result)) {
+            break;
+        }
+        int code = result.toInt();
+        if (code == 0) {
+            return true;
+        }
+        if (code != 1) {
+            break;
+        }
+    }
+    LOG_W(Cellular, "MQTT publish %u not acknowledged (%s)", static_cast<unsigned>(messageId), result.c_str());
+    MqttClient::closeSession();
+    return false;
+}
+
+}  // namespace
+
+namespace MqttClient {
+
+bool ensureSession() {
+    if (takeMqttLinkDropped() && mqttSessionUp) {
+        LOG_W(Cellular, "MQTT connection closed by modem (+QMTSTAT), reconnecting");
+        closeSession();
+    }
+    if (!CellularClient::ensureReady()) {
+        return false;
+    }
+    if (mqttSessionUp && mqttSessionGeneration != CellularClient::readyGeneration()) {
+        // The modem was brought up again since the session opened; ask whether it survived.
+        if (mqttClientConnected()) {
+            mqttSessionGeneration = CellularClient::readyGeneration();
+        } else {
+            LOG_W(Cellular, "MQTT session lost across modem re-init, reconnecting");
+            closeSession();
+        }
+    }
+    if (mqttSessionUp) {
+        return true;
+    }
+    ModemTask::yieldToUrgent();
+    configureMqttClient();
+    if (!openMqttNetwork() || !connectMqttClient()) {
+        closeSession();
+        return false;
+    }
+    // A +QMTSTAT read while reconnecting belongs to the session just replaced.
+    takeMqttLinkDropped();
+    mqttSessionUp = true;
+    mqttSessionGeneration = CellularClient::readyGeneration();
+    LOG_I(Cellular, "MQTT session established with %s", AppConfig::MQTT_BROKER_HOST);
+    return true;
+}
+
+bool publish(const GpsFix& fix) {
+    return publishMqttPayload(mqttTopic("/fix"), buildGeoSensorPayload(fix, "4g"));
+}
+
+bool publishBatch(const GpsFix* fixes, size_t count) {
+    if (count == 0) {
+        return true;
+    }
+    if (count == 1) {
+        return publish(fixes[0]);
+    }
+    String payload;
+    payload.reserve(2 + count * (AppConfig::MQTT_FIX_MAX_JSON + 1));
+    payload = "[";
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) {
+            payload += ",";
+        }
+        payload += buildGeoSensorPayload(fixes[i], "4g");
+    }
+    payload += "]";
+    return publishMqttPayload(mqttTopic("/fixes"), payload);
+}
+
+void closeSession() {
+    String idx = mqttClientIndex();
+    String response;
+    sim_at_cmd_with_response("AT+QMTDISC=" + idx, response, 5000);
+    sim_at_cmd_with_response("AT+QMTCLOSE=" + idx, response, 5000);
+    mqttSessionUp = false;
+}
+
+}  // namespace MqttClient
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "../gps/GpsTypes.h"
+
+namespace MqttClient {
+
+bool ensureSession();
+bool publish(const GpsFix& fix);
+bool publishBatch(const GpsFix* fixes, size_t count);
+void closeSession();
+
+}  // namespace MqttClient
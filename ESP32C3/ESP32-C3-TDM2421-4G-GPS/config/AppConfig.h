@@ -5,6 +5,12 @@
 
 namespace AppConfig {
 
+enum class CellularTransport : uint8_t {
+    Http,
+    Mqtt,
+    Coap,
+};
+
 inline HardwareSerial& modemSerial() {
     return Serial0;
 }
@@ -14,6 +20,7 @@ inline constexpr uint8_t MCU_SIM_TX_PIN = 21;
 inline constexpr uint8_t MCU_SIM_RX_PIN = 20;
 inline constexpr uint8_t MCU_SIM_EN_PIN = 2;
 inline constexpr uint8_t MCU_LED = 10;
+inline constexpr int8_t MCU_SIM_DTR_PIN = -1;  // modem DTR for AT+QSCLK=1 sleep; -1 when not wired
 
 inline constexpr char PHONE_NUMBER[] = "0...";
 
@@ -29,9 +36,20 @@ inline constexpr uint8_t WIFI_MAX_ATTEMPTS = 5;
 inline constexpr uint32_t WIFI_CONNECT_TIMEOUT_MS = 15000;
 inline constexpr uint32_t WIFI_RETRY_COOLDOWN_MS = 60000;
 
-inline constexpr unsigned long GEO_SENSOR_BACKOFF_DELAYS_MS[] = {5000UL, 60000UL, 300000UL};
-inline constexpr size_t GEO_SENSOR_BACKOFF_STAGE_COUNT =
-    sizeof(GEO_SENSOR_BACKOFF_DELAYS_MS) / sizeof(GEO_SENSOR_BACKOFF_DELAYS_MS[0]);
+// Per-transport circuit breakers (net/LinkHealth): retry delays grow with decorrelated jitter
+// between BREAKER_BACKOFF_BASE_MS and BREAKER_BACKOFF_CAP_MS; BREAKER_FAILURE_THRESHOLD failures
+// in a row open the breaker until a half-open probe succeeds.
+inline constexpr uint32_t BREAKER_BACKOFF_BASE_MS = 5000;
+inline constexpr uint32_t BREAKER_BACKOFF_CAP_MS = 300000UL;
+inline constexpr uint8_t BREAKER_FAILURE_THRESHOLD = 3;
+// Hedging: if a Wi-Fi upload runs past the HEDGE_PERCENTILE of recent Wi-Fi latencies, the same
+// fixes are also sent over cellular. The server sees a duplicate PATCH when both succeed.
+inline constexpr bool HEDGE_ENABLED = true;
+inline constexpr uint8_t HEDGE_PERCENTILE = 95;
+inline constexpr uint8_t HEDGE_LATENCY_WINDOW = 16;
+inline constexpr uint8_t HEDGE_MIN_SAMPLES = 5;
+inline constexpr uint32_t HEDGE_MIN_DELAY_MS = 1500;
+inline constexpr uint32_t HEDGE_DEFAULT_DELAY_MS = 6000;
 
 inline constexpr char CELL_APN[] = "CMNET";
 inline constexpr char CELL_APN_USER[] = "";
@@ -45,7 +63,123 @@ inline constexpr uint32_t CELL_READY_REFRESH_MS = 300000;
 inline constexpr uint32_t CELL_SOCKET_OP_TIMEOUT_MS = 20000;
 inline constexpr uint16_t CELL_HTTP_READ_CHUNK = 512;
 
+// Http: one PATCH per fix over a fresh TCP socket. Mqtt: persistent session on the modem's
+// MQTT stack, QoS1 publishes, buffered fixes sent MQTT_BATCH_SIZE at a time. Coap: confirmable
+// POSTs over a UDP socket with CBOR bodies; batches above one block use Block1 transfer.
+inline constexpr CellularTransport CELL_TRANSPORT = CellularTransport::Http;
+inline constexpr char MQTT_BROKER_HOST[] = "manage.gogotrans.com";
+inline constexpr uint16_t MQTT_BROKER_PORT = 1883;
+inline constexpr char MQTT_TOPIC_PREFIX[] = "device/geoSensor/";
+inline constexpr uint8_t MQTT_CLIENT_INDEX = 0;
+inline constexpr uint16_t MQTT_KEEPALIVE_S = 120;
+inline constexpr uint32_t MQTT_CONNECT_TIMEOUT_MS = 30000;
+inline constexpr uint32_t MQTT_PUBLISH_TIMEOUT_MS = 15000;
+inline constexpr uint8_t MQTT_PUBLISH_RETRANSMIT_WAITS = 2;
+inline constexpr uint8_t MQTT_BATCH_SIZE = 10;
+// Worst-case buildGeoSensorPayload() is 261 bytes (a cell fix with positionSource/accuracy);
+// a full batch must stay within the AT+QMTPUBEX payload limit.
+inline constexpr size_t MQTT_FIX_MAX_JSON = 280;
+inline constexpr size_t MQTT_MAX_PAYLOAD = 4096;
+inline constexpr char COAP_SERVER_HOST[] = "manage.gogotrans.com";
+inline constexpr uint16_t COAP_SERVER_PORT = 5683;
+inline constexpr uint8_t COAP_SOCKET_ID = 1;
+inline constexpr uint32_t COAP_ACK_TIMEOUT_MS = 2000;
+inline constexpr uint8_t COAP_MAX_RETRANSMIT = 4;
+inline constexpr uint32_t COAP_SEPARATE_RESPONSE_TIMEOUT_MS = 30000;
+inline constexpr uint8_t COAP_BLOCK_SZX = 4;  // 2^(4+4) = 256-byte blocks
+inline constexpr size_t COAP_MAX_DATAGRAM = 512;
+inline constexpr uint8_t COAP_BATCH_SIZE = 16;
+// Worst-case encodeGeoSensorCbor() size: a cell fix with the 25-character ISO 8601 timestamp,
+// networkSource and keys 8/9 is 73 bytes. The body holds a full batch of those plus the
+// array header; a batch that still overflows (e.g. longer legacy timestamps) sends its prefix.
+inline constexpr size_t COAP_FIX_MAX_CBOR = 80;
+inline constexpr size_t COAP_MAX_BODY = 3 + COAP_BATCH_SIZE * COAP_FIX_MAX_CBOR;
+
 inline constexpr uint16_t GEO_SENSOR_BUFFER_CAPACITY = 512;
+// Fixes deferred between upload slots are held in RAM and written to the NVS backlog only when
+// a slot fails, this many are already waiting, or on restart. A power cut loses at most these.
+inline constexpr uint8_t UPLOAD_DEFER_RAM_CAPACITY = 16;
+
+inline constexpr uint32_t GPS_WARMUP_MS = 60000;
+inline constexpr float GNSS_UERE_M = 5.0f;  // accuracy estimate = HDOP * UERE
+
+// Cell-tower fallback (gps/CellLocator) when GNSS has no fix. Off until gps/CellTable.h has been
+// generated for the operating region with tools/build_cell_table.py; the build refuses to
+// enable it against the empty table that ships in the repo.
+inline constexpr bool CELL_POS_ENABLED = false;
+inline constexpr double CELL_POS_NEIGHBOUR_MAX_M = 30000.0;
+inline constexpr uint16_t CELL_POS_DEFAULT_RANGE_M = 2000;
+inline constexpr float CELL_POS_MIN_ACCURACY_M = 300.0f;
+
+// Speed-adaptive sampling (gps/SamplingScheduler). While moving the interval targets one point
+// every SAMPLING_TARGET_SPACING_M, bounded by SAMPLING_MIN_INTERVAL_MS and
+// GEO_SENSOR_UPLOAD_INTERVAL_MS; a parked asset drops to SAMPLING_STATIONARY_INTERVAL_MS.
+inline constexpr bool SAMPLING_ADAPTIVE_ENABLED = true;
+inline constexpr uint32_t SAMPLING_MIN_INTERVAL_MS = 10000;
+inline constexpr uint32_t SAMPLING_STATIONARY_INTERVAL_MS = 900000UL;
+inline constexpr float SAMPLING_TARGET_SPACING_M = 250.0f;
+inline constexpr float SAMPLING_TURN_DEGREES = 30.0f;
+inline constexpr float SAMPLING_HEADING_MIN_SPEED_KMH = 5.0f;
+inline constexpr float SAMPLING_STATIONARY_SPEED_KMH = 2.0f;
+inline constexpr float SAMPLING_STATIONARY_RADIUS_M = 40.0f;
+inline constexpr uint8_t SAMPLING_STATIONARY_FIXES = 3;
+inline constexpr uint32_t SAMPLING_UPLOAD_CADENCE_MOVING_MS = 60000;
+
+// FreeRTOS task layout: higher number = higher priority. The modem task owns the UART and
+// runs one job at a time; a cellular upload yields to queued GNSS/cell-fix jobs only at its
+// safe points (see ModemTask::yieldToUrgent), so a fix can still wait for one complete
+// request/response exchange, up to CELL_SOCKET_OP_TIMEOUT_MS or MQTT_PUBLISH_TIMEOUT_MS.
+inline constexpr uint8_t MODEM_TASK_PRIORITY = 5;
+inline constexpr uint8_t GNSS_TASK_PRIORITY = 4;
+inline constexpr uint8_t UPLOADER_TASK_PRIORITY = 3;
+inline constexpr uint8_t CONNECTIVITY_TASK_PRIORITY = 2;
+inline constexpr uint32_t MODEM_TASK_STACK_BYTES = 6144;
+inline constexpr uint32_t GNSS_TASK_STACK_BYTES = 4096;
+inline constexpr uint32_t UPLOADER_TASK_STACK_BYTES = 10240;
+inline constexpr uint32_t CONNECTIVITY_TASK_STACK_BYTES = 6144;
+inline constexpr uint8_t MODEM_URGENT_QUEUE_DEPTH = 2;
+inline constexpr uint8_t MODEM_BULK_QUEUE_DEPTH = 4;
+inline constexpr uint8_t GNSS_FIX_QUEUE_DEPTH = 8;
+inline constexpr uint32_t MODEM_TASK_POLL_MS = 10;
+inline constexpr uint32_t UPLOADER_TASK_POLL_MS = 1000;
+inline constexpr uint32_t CONNECTIVITY_TASK_POLL_MS = 20;
+
+// Low-power duty cycling (power/PowerManager). When disabled the GNSS engine, modem and Wi-Fi
+// stay on between samples as before; the energy accounting runs either way for comparison.
+inline constexpr bool POWER_SAVE_ENABLED = false;
+inline constexpr bool POWER_MODEM_EDRX_ENABLED = true;
+inline constexpr char POWER_MODEM_EDRX_CYCLE[] = "0101";  // 81.92 s
+// PSM stops the modem answering AT until its next TAU unless PSM_EINT is wired; off by default.
+inline constexpr bool POWER_MODEM_PSM_ENABLED = false;
+inline constexpr char POWER_MODEM_PSM_TAU[] = "00100001";          // T3412: 1 h
+inline constexpr char POWER_MODEM_PSM_ACTIVE_TIME[] = "00000101";  // T3324: 10 s
+inline constexpr uint32_t POWER_BOOT_AWAKE_MS = 180000;
+inline constexpr uint32_t POWER_BURST_MAX_MS = 90000;
+inline constexpr uint32_t POWER_MIN_SLEEP_MS = 2000;
+inline constexpr uint32_t POWER_AWAKE_RECHECK_MS = 1000;
+inline constexpr uint32_t POWER_UART_WAKE_AWAKE_MS = 3000;
+inline constexpr int POWER_UART_WAKE_THRESHOLD = 3;
+inline constexpr uint32_t POWER_WIFI_PARK_TIMEOUT_MS = 2000;
+inline constexpr uint32_t POWER_MODEM_WAKE_GUARD_MS = 100;
+inline constexpr uint32_t POWER_GNSS_FIX_TIMEOUT_MS = 60000;
+inline constexpr uint32_t POWER_GNSS_POLL_MS = 2000;
+// Nominal currents behind the energy-per-fix estimate, in microamps.
+inline constexpr uint64_t POWER_MCU_ACTIVE_UA = 25000;
+inline constexpr uint64_t POWER_MCU_SLEEP_UA = 200;
+inline constexpr uint64_t POWER_MODEM_ACTIVE_UA = 90000;
+inline constexpr uint64_t POWER_MODEM_IDLE_UA = 15000;
+inline constexpr uint64_t POWER_MODEM_SLEEP_UA = 1500;
+inline constexpr uint64_t POWER_GNSS_ACTIVE_UA = 30000;
+
+// Logging: levels above LOG_LEVEL (1=error ... 5=verbose) and categories outside the mask
+// are compiled out. Bit order follows Log::Category.
+inline constexpr uint8_t LOG_LEVEL = 3;
+inline constexpr uint32_t LOG_CATEGORY_MASK = 0xFFFFFFFFUL;
+inline constexpr uint32_t LOG_RING_CAPACITY = 64;
+inline constexpr size_t LOG_TEXT_CAPACITY = 96;
+inline constexpr uint32_t LOG_DRAIN_INTERVAL_MS = 20;
+inline constexpr uint8_t LOG_DRAIN_TASK_PRIORITY = 1;
+inline constexpr uint32_t LOG_DRAIN_TASK_STACK_BYTES = 3072;
 
 }  // namespace AppConfig
 
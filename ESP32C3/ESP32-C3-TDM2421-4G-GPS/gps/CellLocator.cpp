@@ -0,0 +1,229 @@
+#include "CellLocator.h"
+
+#include <math.h>
+
+#include "../config/AppConfig.h"
+#include "../logging/Log.h"
+#include "../modem/ModemCommands.h"
+#include "../utils/StringUtils.h"
+#include "CellTable.h"
+
+static_assert(!AppConfig::CELL_POS_ENABLED || CellTable::TOWER_COUNT > 0,
+              "CELL_POS_ENABLED needs gps/CellTable.h generated by tools/build_cell_table.py");
+
+namespace {
+
+constexpr size_t MAX_OBSERVED_CELLS = 8;
+constexpr double CELL_EARTH_RADIUS_M = 6371000.0;
+constexpr double CELL_DEG_TO_RAD = 0.017453292519943295;
+
+struct ObservedCell {
+    const CellTable::Tower* tower;
+    int rsrp;
+};
+
+String unquote(String value) {
+    value.trim();
+    value.replace("\"", "");
+    return value;
+}
+
+int compareKey(const CellTable::Tower& tower, uint16_t mcc, uint16_t mnc, uint32_t cellId) {
+    if (tower.mcc != mcc) {
+        return tower.mcc < mcc ? -1 : 1;
+    }
+    if (tower.mnc != mnc) {
+        return tower.mnc < mnc ? -1 : 1;
+    }
+    if (tower.cellId != cellId) {
+        return tower.cellId < cellId ? -1 : 1;
+    }
+    return 0;
+}
+
+const CellTable::Tower* findServingTower(uint16_t mcc, uint16_t mnc, uint32_t cellId) {
+    size_t low = 0;
+    size_t high = CellTable::TOWER_COUNT;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        int order = compareKey(CellTable::TOWERS[mid], mcc, mnc, cellId);
+        if (order == 0) {
+            return &CellTable::TOWERS[mid];
+        }
+        if (order < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return nullptr;
+}
+
+double towerDistanceMeters(const CellTable::Tower& a, const CellTable::Tower& b) {
+    double latA = a.latitudeE7 * 1e-7 * CELL_DEG_TO_RAD;
+    double latB = b.latitudeE7 * 1e-7 * CELL_DEG_TO_RAD;
+    double dx = (b.longitudeE7 - a.longitudeE7) * 1e-7 * CELL_DEG_TO_RAD * cos((latA + latB) * 0.5);
+    double dy = latB - latA;
+    return sqrt(dx * dx + dy * dy) * CELL_EARTH_RADIUS_M;
+}
+
+// Neighbour reports only carry the PCI, which repeats across a network; take the closest
+// cell with that PCI to the serving cell, if it is within CELL_POS_NEIGHBOUR_MAX_M.
+const CellTable::Tower* findNeighbourTower(const CellTable::Tower& serving, uint16_t pci) {
+    const CellTable::Tower* best = nullptr;
+    double bestDistance = AppConfig::CELL_POS_NEIGHBOUR_MAX_M;
+    for (size_t i = 0; i < CellTable::TOWER_COUNT; ++i) {
+        const CellTable::Tower& candidate = CellTable::TOWERS[i];
+        if (candidate.pci != pci || candidate.mcc != serving.mcc || candidate.mnc != serving.mnc ||
+            candidate.cellId == serving.cellId) {
+            continue;
+        }
+        double distance = towerDistanceMeters(serving, candidate);
+        if (distance <= bestDistance) {
+            bestDistance = distance;
+            best = &CellTable::TOWERS[i];
+        }
+    }
+    return best;
+}
+
+// +QENG: "servingcell",<state>,"LTE",<is_tdd>,<mcc>,<mnc>,<cellID>,<pcid>,<earfcn>,<band>,
+//        <ul_bw>,<dl_bw>,<tac>,<rsrp>,...
+bool readServingCell(uint16_t& mcc, uint16_t& mnc, uint32_t& cellId, int& rsrp) {
+    String response;
+    if (!sim_at_cmd_with_response("AT+QENG=\"servingcell\"", response, 3000)) {
+        return false;
+    }
+    int tagPos = response.indexOf("+QENG:");
+    if (tagPos == -1) {
+        return false;
+    }
+    int lineEnd = response.indexOf('\n', tagPos);
+    String data = response.substring(tagPos + 6, lineEnd == -1 ? response.length() : lineEnd);
+    const size_t FIELD_COUNT = 14;
+    String fields[FIELD_COUNT];
+    if (!StringUtils::splitCsvFields(data, fields, FIELD_COUNT) || unquote(fields[2]) != "LTE") {
+        LOG_D(Gnss, "No LTE serving cell: %s", data.c_str());
+        return false;
+    }
+    mcc = static_cast<uint16_t>(fields[4].toInt());
+    mnc = static_cast<uint16_t>(fields[5].toInt());
+    cellId = static_cast<uint32_t>(strtoul(unquote(fields[6]).c_str(), nullptr, 16));
+    rsrp = fields[13].toInt();
+    return true;
+}
+
+// +QENG: "neighbourcell intra"|"neighbourcell inter","LTE",<earfcn>,<pcid>,<rsrq>,<rsrp>,...
+size_t readNeighbourCells(const CellTable::Tower& serving, ObservedCell* cells, size_t capacity) {
+    String response;
+    if (!sim_at_cmd_with_response("AT+QENG=\"neighbourcell\"", response, 3000)) {
+        return 0;
+    }
+    size_t count = 0;
+    int cursor = 0;
+    while (count < capacity) {
+        int tagPos = response.indexOf("+QENG:", cursor);
+        if (tagPos == -1) {
+            break;
+        }
+        int lineEnd = response.indexOf('\n', tagPos);
+        if (lineEnd == -1) {
+            lineEnd = response.length();
+        }
+        cursor = lineEnd;
+        String data = response.substring(tagPos + 6, lineEnd);
+        const size_t FIELD_COUNT = 6;
+        String fields[FIELD_COUNT];
+        if (!StringUtils::splitCsvFields(data, fields, FIELD_COUNT) || unquote(fields[1]) != "LTE") {
+            continue;
+        }
+        const CellTable::Tower* tower = findNeighbourTower(serving, static_cast<uint16_t>(fields[3].toInt()));
+        if (tower != nullptr) {
+            cells[count++] = {tower, static_cast<int>(fields[5].toInt())};
+        }
+    }
+    return count;
+}
+
+// +CCLK: "yy/MM/dd,hh:mm:ss+zz" with zz in quarter hours.
+String networkTimestamp() {
+    String response;
+    if (!sim_at_cmd_with_response("AT+CCLK?", response, 2000)) {
+        return "";
+    }
+    int start = response.indexOf("+CCLK: \"");
+    if (start == -1 || response.length() < static_cast<unsigned>(start + 28)) {
+        return "";
+    }
+    String clock = response.substring(start + 8, start + 28);
+    int year = 2000 + clock.substring(0, 2).toInt();
+    if (year < 2020) {
+        return "";  // modem clock not set by the network yet
+    }
+    int quarterHours = clock.substring(18, 20).toInt();
+    bool negative = clock.charAt(17) == '-';
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%04d-%s-%sT%s%c%02d:%02d", year, clock.substring(3, 5).c_str(),
+             clock.substring(6, 8).c_str(), clock.substring(9, 17).c_str(), negative ? '-' : '+', quarterHours / 4,
+             (quarterHours % 4) * 15);
+    return String(buffer);
+}
+
+}  // namespace
+
+namespace CellLocator {
+
+bool locate(GpsFix& fix) {
+    if (CellTable::TOWER_COUNT == 0) {
+        return false;
+    }
+    uint16_t mcc = 0;
+    uint16_t mnc = 0;
+    uint32_t cellId = 0;
+    int servingRsrp = 0;
+    if (!readServingCell(mcc, mnc, cellId, servingRsrp)) {
+        return false;
+    }
+    const CellTable::Tower* servingEntry = findServingTower(mcc, mnc, cellId);
+    if (servingEntry == nullptr) {
+        LOG_DEFERRED(Info, Gnss, "Serving cell %u-%u-%lu not in cell table", mcc, mnc,
+                     static_cast<unsigned long>(cellId));
+        return false;
+    }
+    String timestamp = networkTimestamp();
+    if (timestamp.isEmpty()) {
+        LOG_W(Gnss, "Network time unavailable, cannot timestamp cell fix");
+        return false;
+    }
+    ObservedCell cells[MAX_OBSERVED_CELLS];
+    cells[0] = {servingEntry, servingRsrp};
+    size_t count = 1 + readNeighbourCells(*servingEntry, cells + 1, MAX_OBSERVED_CELLS - 1);
+
+    // RSRP-weighted centroid (amplitude weighting, so the strongest cell leads without
+    // drowning out the others); accuracy is the weighted mean of the cells' coverage radii.
+    double weightSum = 0.0;
+    double lat = 0.0;
+    double lon = 0.0;
+    double range = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        const CellTable::Tower& tower = *cells[i].tower;
+        double weight = pow(10.0, cells[i].rsrp / 20.0);
+        uint16_t towerRange = tower.rangeMeters > 0 ? tower.rangeMeters : AppConfig::CELL_POS_DEFAULT_RANGE_M;
+        weightSum += weight;
+        lat += weight * tower.latitudeE7 * 1e-7;
+        lon += weight * tower.longitudeE7 * 1e-7;
+        range += weight * towerRange;
+    }
+    fix = GpsFix();
+    fix.latitude = static_cast<float>(lat / weightSum);
+    fix.longitude = static_cast<float>(lon / weightSum);
+    fix.dataAcquiredAt = timestamp;
+    fix.source = PositionSource::Cell;
+    float accuracy = static_cast<float>(range / weightSum);
+    fix.accuracyMeters = accuracy < AppConfig::CELL_POS_MIN_ACCURACY_M ? AppConfig::CELL_POS_MIN_ACCURACY_M : accuracy;
+    LOG_DEFERRED(Info, Gnss, "Cell fix from %u cell(s), accuracy %.0f m", static_cast<unsigned>(count),
+                 fix.accuracyMeters);
+    return true;
+}
+
+}  // namespace CellLocator
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "GpsTypes.h"
+
+// Coarse position from the serving/neighbour LTE cells and the flash-resident CellTable.
+// Talks to the modem directly, so call it from a ModemTask job.
+namespace CellLocator {
+
+bool locate(GpsFix& fix);
+
+}  // namespace CellLocator
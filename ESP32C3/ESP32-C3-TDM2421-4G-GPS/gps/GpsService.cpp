@@ -2,6 +2,7 @@
 
 #include <math.h>
 
+#include "../config/AppConfig.h"
 #include "../modem/ModemCommands.h"
 #include "../utils/StringUtils.h"
 
@@ -57,7 +58,9 @@ bool parseGpsResponse(const String& raw, GpsFix& fix) {
     }
     fix.latitude = convertNmeaToDecimal(fields[1]);
     fix.longitude = convertNmeaToDecimal(fields[2]);
+    fix.accuracyMeters = fields[3].toFloat() * AppConfig::GNSS_UERE_M;
     fix.altitude = fields[4].toFloat();
+    fix.course = fields[6].toFloat();
     fix.speed = fields[7].toFloat();
     fix.dataAcquiredAt = buildIso8601UtcFromGps(fields[9], fields[0]);
     fix.satelliteCount = static_cast<uint8_t>(fields[10].toInt());
@@ -68,11 +71,12 @@ bool parseGpsResponse(const String& raw, GpsFix& fix) {
 
 namespace GpsService {
 
-void warmup() {
+void enable() {
     sim_at_cmd("AT+QGPS=1");
-    delay(60000);
-    sim_at_cmd("AT+QGPS?");
-    sim_at_cmd("AT+QGPSLOC=0");
+}
+
+void disable() {
+    sim_at_cmd("AT+QGPSEND");
 }
 
 bool fetchFix(GpsFix& fix) {
@@ -4,7 +4,8 @@
 
 namespace GpsService {
 
-void warmup();
+void enable();
+void disable();
 bool fetchFix(GpsFix& fix);
 
 }  // namespace GpsService
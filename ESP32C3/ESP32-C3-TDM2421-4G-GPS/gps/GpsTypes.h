@@ -2,12 +2,20 @@
 
 #include <Arduino.h>
 
+enum class PositionSource : uint8_t {
+    Gnss,
+    Cell,
+};
+
 struct GpsFix {
     float latitude = 0.0f;
     float longitude = 0.0f;
     float altitude = 0.0f;
     float speed = 0.0f;
+    float course = 0.0f;
     uint8_t satelliteCount = 0;
     String dataAcquiredAt;
+    PositionSource source = PositionSource::Gnss;
+    float accuracyMeters = 0.0f;  // horizontal, ~1 sigma; 0 = unknown
 };
 
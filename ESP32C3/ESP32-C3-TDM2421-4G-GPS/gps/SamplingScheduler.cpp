@@ -0,0 +1,156 @@
+#include "SamplingScheduler.h"
+
+#include <freertos/FreeRTOS.h>
+#include <math.h>
+
+#include "../config/AppConfig.h"
+#include "../logging/Log.h"
+#include "../metrics/Metrics.h"
+
+namespace {
+
+constexpr float EARTH_RADIUS_M = 6371000.0f;
+constexpr float DEG_TO_RAD_F = 0.017453292f;
+
+struct SamplingState {
+    bool hasHistory;
+    GpsFix lastFix;
+    GpsFix anchor;
+    uint8_t stillCount;
+    bool stationary;
+    uint32_t intervalMs;
+};
+
+SamplingState samplingState = {false, GpsFix(), GpsFix(), 0, false, AppConfig::GEO_SENSOR_UPLOAD_INTERVAL_MS};
+
+// Shared with the uploader task.
+portMUX_TYPE uploadSlotLock = portMUX_INITIALIZER_UNLOCKED;
+bool uploadRequested = true;
+uint32_t uploadCadenceMs = 0;
+unsigned long lastUploadSlotAt = 0;
+
+// Equirectangular approximation; plenty for the tens-to-hundreds of metres compared here.
+float distanceMeters(const GpsFix& a, const GpsFix& b) {
+    float meanLat = (a.latitude + b.latitude) * 0.5f * DEG_TO_RAD_F;
+    float dx = (b.longitude - a.longitude) * DEG_TO_RAD_F * cosf(meanLat);
+    float dy = (b.latitude - a.latitude) * DEG_TO_RAD_F;
+    return sqrtf(dx * dx + dy * dy) * EARTH_RADIUS_M;
+}
+
+float headingChangeDegrees(const GpsFix& previous, const GpsFix& current) {
+    // Course over ground is noise below walking pace.
+    if (previous.speed < AppConfig::SAMPLING_HEADING_MIN_SPEED_KMH ||
+        current.speed < AppConfig::SAMPLING_HEADING_MIN_SPEED_KMH) {
+        return 0.0f;
+    }
+    float delta = fabsf(current.course - previous.course);
+    return delta > 180.0f ? 360.0f - delta : delta;
+}
+
+uint32_t clampInterval(uint32_t intervalMs, uint32_t maxMs) {
+    if (intervalMs < AppConfig::SAMPLING_MIN_INTERVAL_MS) {
+        return AppConfig::SAMPLING_MIN_INTERVAL_MS;
+    }
+    return intervalMs > maxMs ? maxMs : intervalMs;
+}
+
+void requestUpload(bool immediate, uint32_t cadenceMs) {
+    portENTER_CRITICAL(&uploadSlotLock);
+    uploadCadenceMs = cadenceMs;
+    if (immediate) {
+        uploadRequested = true;
+    }
+    portEXIT_CRITICAL(&uploadSlotLock);
+}
+
+uint32_t publishInterval(uint32_t intervalMs) {
+    samplingState.intervalMs = intervalMs;
+    Metrics::setGauge(Metrics::Gauge::SampleIntervalSeconds, intervalMs / 1000);
+    return intervalMs;
+}
+
+}  // namespace
+
+namespace SamplingScheduler {
+
+uint32_t onFix(const GpsFix& fix) {
+    if (!AppConfig::SAMPLING_ADAPTIVE_ENABLED) {
+        return AppConfig::GEO_SENSOR_UPLOAD_INTERVAL_MS;
+    }
+    SamplingState& state = samplingState;
+    if (!state.hasHistory) {
+        state.hasHistory = true;
+        state.lastFix = fix;
+        state.anchor = fix;
+        requestUpload(true, AppConfig::SAMPLING_UPLOAD_CADENCE_MOVING_MS);
+        return publishInterval(AppConfig::GEO_SENSOR_UPLOAD_INTERVAL_MS);
+    }
+
+    float turn = headingChangeDegrees(state.lastFix, fix);
+    // Stationary = slow and still inside the radius around where we stopped, for a few samples
+    // in a row; GNSS drift alone must not read as movement.
+    bool still = fix.speed < AppConfig::SAMPLING_STATIONARY_SPEED_KMH &&
+                 distanceMeters(state.anchor, fix) < AppConfig::SAMPLING_STATIONARY_RADIUS_M;
+    if (still) {
+        if (state.stillCount < 0xFF) {
+            ++state.stillCount;
+        }
+    } else {
+        state.stillCount = 0;
+        state.anchor = fix;
+    }
+    bool wasStationary = state.stationary;
+    state.stationary = state.stillCount >= AppConfig::SAMPLING_STATIONARY_FIXES;
+
+    uint32_t intervalMs;
+    if (state.stationary) {
+        intervalMs = AppConfig::SAMPLING_STATIONARY_INTERVAL_MS;
+    } else {
+        // Aim for one point every SAMPLING_TARGET_SPACING_M along the track; tighten after a turn.
+        float metersPerSecond = fix.speed / 3.6f;
+        intervalMs = metersPerSecond > 0.5f
+                         ? static_cast<uint32_t>(AppConfig::SAMPLING_TARGET_SPACING_M / metersPerSecond * 1000.0f)
+                         : AppConfig::GEO_SENSOR_UPLOAD_INTERVAL_MS;
+        if (turn >= AppConfig::SAMPLING_TURN_DEGREES) {
+            intervalMs = AppConfig::SAMPLING_MIN_INTERVAL_MS;
+        }
+        intervalMs = clampInterval(intervalMs, AppConfig::GEO_SENSOR_UPLOAD_INTERVAL_MS);
+    }
+
+    // Starting, stopping and turning are what the track consumer cares about: send right away.
+    // While parked every (rare) fix goes out; while moving fixes are batched per cadence.
+    bool event = wasStationary != state.stationary || turn >= AppConfig::SAMPLING_TURN_DEGREES;
+    requestUpload(event, state.stationary ? 0 : AppConfig::SAMPLING_UPLOAD_CADENCE_MOVING_MS);
+    if (wasStationary != state.stationary) {
+        LOG_I(Gnss, "Asset %s", state.stationary ? "stationary" : "moving");
+    }
+    LOG_DEFERRED(Debug, Gnss, "speed %.1f km/h, turn %.0f deg, next sample in %lu ms",
+                 fix.speed, turn, static_cast<unsigned long>(intervalMs));
+    state.lastFix = fix;
+    return publishInterval(intervalMs);
+}
+
+uint32_t onFixFailed() {
+    if (!AppConfig::SAMPLING_ADAPTIVE_ENABLED) {
+        return AppConfig::GEO_SENSOR_UPLOAD_INTERVAL_MS;
+    }
+    // Keep the cadence we had; a parked asset does not need a quick retry, a moving one does.
+    return samplingState.intervalMs;
+}
+
+bool takeUploadSlot() {
+    if (!AppConfig::SAMPLING_ADAPTIVE_ENABLED) {
+        return true;
+    }
+    unsigned long now = millis();
+    portENTER_CRITICAL(&uploadSlotLock);
+    bool due = uploadRequested || now - lastUploadSlotAt >= uploadCadenceMs;
+    if (due) {
+        uploadRequested = false;
+        lastUploadSlotAt = now;
+    }
+    portEXIT_CRITICAL(&uploadSlotLock);
+    return due;
+}
+
+}  // namespace SamplingScheduler
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "GpsTypes.h"
+
+namespace SamplingScheduler {
+
+// GNSS task: feed every sample, get the delay until the next one.
+uint32_t onFix(const GpsFix& fix);
+uint32_t onFixFailed();
+
+// Uploader task: whether buffered and new fixes should go out now. Claiming a slot
+// restarts the upload cadence.
+bool takeUploadSlot();
+
+}  // namespace SamplingScheduler
@@ -0,0 +1,280 @@
+#include "Log.h"
+
+#include <atomic>
+#include <stdarg.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+namespace {
+
+enum class RecordKind : uint8_t {
+    Text,
+    Deferred,
+};
+
+struct LogRecord {
+    uint32_t timestampMs;
+    Log::Level level;
+    Log::Category category;
+    RecordKind kind;
+    uint8_t argc;
+    union {
+        char text[AppConfig::LOG_TEXT_CAPACITY];
+        struct {
+            const char* fmt;
+            Log::DeferredArg args[Log::MAX_DEFERRED_ARGS];
+        } deferred;
+    };
+};
+
+// Bounded MPSC ring (Vyukov): producers claim a slot with one CAS and publish it through the
+// slot sequence; the drain task is the only consumer, so dequeue needs no CAS at all.
+struct LogSlot {
+    std::atomic<uint32_t> sequence;
+    LogRecord record;
+};
+
+static_assert((AppConfig::LOG_RING_CAPACITY & (AppConfig::LOG_RING_CAPACITY - 1)) == 0,
+              "LOG_RING_CAPACITY must be a power of two");
+
+LogSlot logRing[AppConfig::LOG_RING_CAPACITY];
+std::atomic<uint32_t> logEnqueuePos{0};
+std::atomic<uint32_t> logDropped{0};
+uint32_t logDequeuePos = 0;
+uint32_t logDroppedReported = 0;
+bool logRingReady = false;
+TaskHandle_t logDrainTask = nullptr;
+
+constexpr const char* LOG_CATEGORY_NAMES[] = {"modem", "gnss", "4g", "wifi", "upload", "buffer", "tasks", "power"};
+static_assert(sizeof(LOG_CATEGORY_NAMES) / sizeof(LOG_CATEGORY_NAMES[0]) ==
+                  static_cast<size_t>(Log::Category::Count),
+              "category name table out of sync");
+
+LogRecord* claimLogSlot(uint32_t& position) {
+    position = logEnqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        LogSlot& slot = logRing[position & (AppConfig::LOG_RING_CAPACITY - 1)];
+        uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+        int32_t diff = static_cast<int32_t>(sequence - position);
+        if (diff == 0) {
+            if (logEnqueuePos.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                return &slot.record;
+            }
+        } else if (diff < 0) {
+            logDropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            position = logEnqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void publishLogSlot(uint32_t position) {
+    logRing[position & (AppConfig::LOG_RING_CAPACITY - 1)].sequence.store(position + 1, std::memory_order_release);
+}
+
+bool popLogRecord(LogRecord& out) {
+    LogSlot& slot = logRing[logDequeuePos & (AppConfig::LOG_RING_CAPACITY - 1)];
+    uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (static_cast<int32_t>(sequence - (logDequeuePos + 1)) < 0) {
+        return false;
+    }
+    out = slot.record;
+    slot.sequence.store(logDequeuePos + AppConfig::LOG_RING_CAPACITY, std::memory_order_release);
+    ++logDequeuePos;
+    return true;
+}
+
+bool isIntegerConversion(char c) {
+    return strchr("diouxXc", c) != nullptr;
+}
+
+bool isFloatConversion(char c) {
+    return strchr("fFeEgGaA", c) != nullptr;
+}
+
+// Expands a deferred record: each conversion is re-issued to snprintf with a normalised
+// length modifier, since the original va_list is long gone.
+size_t formatDeferred(char* out, size_t capacity, const char* fmt, const Log::DeferredArg* args, uint8_t argc) {
+    size_t used = 0;
+    uint8_t argIndex = 0;
+    for (const char* p = fmt; *p != '\0' && used + 1 < capacity; ++p) {
+        if (*p != '%') {
+            out[used++] = *p;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[used++] = '%';
+            ++p;
+            continue;
+        }
+        char spec[16] = "%";
+        size_t specLen = 1;
+        ++p;
+        while (*p != '\0' && strchr("-+ #0123456789.", *p) != nullptr && specLen < sizeof(spec) - 4) {
+            spec[specLen++] = *p++;
+        }
+        while (*p != '\0' && strchr("hlLqjzt", *p) != nullptr) {
+            ++p;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        char conversion = *p;
+        int written = 0;
+        if (argIndex < argc && isIntegerConversion(conversion)) {
+            const Log::DeferredArg& arg = args[argIndex++];
+            spec[specLen++] = 'l';
+            spec[specLen++] = 'l';
+            spec[specLen++] = conversion;
+            spec[specLen] = '\0';
+            long long value = arg.isFloat ? static_cast<long long>(arg.f) : static_cast<long long>(arg.i);
+            written = snprintf(out + used, capacity - used, spec, value);
+        } else if (argIndex < argc && isFloatConversion(conversion)) {
+            const Log::DeferredArg& arg = args[argIndex++];
+            spec[specLen++] = conversion;
+            spec[specLen] = '\0';
+            double value = arg.isFloat ? arg.f : static_cast<double>(arg.i);
+            written = snprintf(out + used, capacity - used, spec, value);
+        } else {
+            written = snprintf(out + used, capacity - used, "%s", "<?>");
+        }
+        if (written > 0) {
+            used += static_cast<size_t>(written) < capacity - used ? static_cast<size_t>(written) : capacity - used - 1;
+        }
+    }
+    out[used] = '\0';
+    return used;
+}
+
+char levelTag(Log::Level level) {
+    switch (level) {
+        case Log::Level::Error:
+            return 'E';
+        case Log::Level::Warn:
+            return 'W';
+        case Log::Level::Info:
+            return 'I';
+        case Log::Level::Debug:
+            return 'D';
+        default:
+            return 'V';
+    }
+}
+
+void emitLogRecord(const LogRecord& record) {
+    char line[AppConfig::LOG_TEXT_CAPACITY + 48];
+    int prefix = snprintf(line,
+                          sizeof(line),
+                          "[%lu] %c/%s: ",
+                          static_cast<unsigned long>(record.timestampMs),
+                          levelTag(record.level),
+                          LOG_CATEGORY_NAMES[static_cast<size_t>(record.category)]);
+    size_t used = prefix > 0 ? static_cast<size_t>(prefix) : 0;
+    if (record.kind == RecordKind::Deferred) {
+        used += formatDeferred(line + used, sizeof(line) - used - 1, record.deferred.fmt, record.deferred.args, record.argc);
+    } else {
+        used += snprintf(line + used, sizeof(line) - used - 1, "%s", record.text);
+        if (used > sizeof(line) - 2) {
+            used = sizeof(line) - 2;
+        }
+    }
+    line[used++] = '\n';
+    Serial.write(reinterpret_cast<const uint8_t*>(line), used);
+}
+
+void reportDroppedRecords() {
+    uint32_t dropped = logDropped.load(std::memory_order_relaxed);
+    if (dropped != logDroppedReported) {
+        Serial.printf("[log] ring full, dropped %lu records\n", static_cast<unsigned long>(dropped - logDroppedReported));
+        logDroppedReported = dropped;
+    }
+}
+
+void drainLogRing() {
+    LogRecord record;
+    while (popLogRecord(record)) {
+        emitLogRecord(record);
+    }
+    reportDroppedRecords();
+}
+
+void logDrainMain(void*) {
+    for (;;) {
+        drainLogRing();
+        vTaskDelay(pdMS_TO_TICKS(AppConfig::LOG_DRAIN_INTERVAL_MS));
+    }
+}
+
+LogRecord* beginLogRecord(Log::Level level, Log::Category category, RecordKind kind, uint32_t& position) {
+    if (!logRingReady) {
+        return nullptr;
+    }
+    LogRecord* record = claimLogSlot(position);
+    if (record == nullptr) {
+        return nullptr;
+    }
+    record->timestampMs = millis();
+    record->level = level;
+    record->category = category;
+    record->kind = kind;
+    record->argc = 0;
+    return record;
+}
+
+}  // namespace
+
+namespace Log {
+
+void begin() {
+    if (logRingReady) {
+        return;
+    }
+    for (uint32_t i = 0; i < AppConfig::LOG_RING_CAPACITY; ++i) {
+        logRing[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    logRingReady = true;
+    if (xTaskCreate(logDrainMain,
+                    "logDrain",
+                    AppConfig::LOG_DRAIN_TASK_STACK_BYTES,
+                    nullptr,
+                    AppConfig::LOG_DRAIN_TASK_PRIORITY,
+                    &logDrainTask) != pdPASS) {
+        Serial.println("Failed to start log drain task");
+        logDrainTask = nullptr;
+    }
+}
+
+uint32_t droppedRecords() {
+    return logDropped.load(std::memory_order_relaxed);
+}
+
+void write(Level level, Category category, const char* fmt, ...) {
+    uint32_t position = 0;
+    LogRecord* record = beginLogRecord(level, category, RecordKind::Text, position);
+    if (record == nullptr) {
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(record->text, sizeof(record->text), fmt, args);
+    va_end(args);
+    publishLogSlot(position);
+}
+
+void writeDeferredPacked(Level level, Category category, const char* fmt, const DeferredArg* args, uint8_t argc) {
+    uint32_t position = 0;
+    LogRecord* record = beginLogRecord(level, category, RecordKind::Deferred, position);
+    if (record == nullptr) {
+        return;
+    }
+    record->argc = argc;
+    record->deferred.fmt = fmt;
+    for (uint8_t i = 0; i < argc; ++i) {
+        record->deferred.args[i] = args[i];
+    }
+    publishLogSlot(position);
+}
+
+}  // namespace Log
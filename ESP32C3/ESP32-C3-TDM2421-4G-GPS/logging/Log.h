@@ -0,0 +1,93 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <type_traits>
+
+#include "../config/AppConfig.h"
+
+namespace Log {
+
+enum class Level : uint8_t {
+    Error = 1,
+    Warn = 2,
+    Info = 3,
+    Debug = 4,
+    Verbose = 5,
+};
+
+enum class Category : uint8_t {
+    Modem,
+    Gnss,
+    Cellular,
+    Wifi,
+    Upload,
+    Buffer,
+    Tasks,
+    Power,
+    Count,
+};
+
+struct DeferredArg {
+    bool isFloat;
+    union {
+        int64_t i;
+        double f;
+    };
+};
+
+constexpr uint8_t MAX_DEFERRED_ARGS = 4;
+
+constexpr bool compiledIn(Level level, Category category) {
+    return static_cast<uint8_t>(level) <= AppConfig::LOG_LEVEL &&
+           (AppConfig::LOG_CATEGORY_MASK & (1UL << static_cast<uint8_t>(category))) != 0;
+}
+
+void begin();
+uint32_t droppedRecords();
+void write(Level level, Category category, const char* fmt, ...) __attribute__((format(printf, 3, 4)));
+void writeDeferredPacked(Level level, Category category, const char* fmt, const DeferredArg* args, uint8_t argc);
+
+template <typename T>
+DeferredArg deferredArg(T value) {
+    static_assert(std::is_arithmetic<T>::value, "deferred log arguments must be numeric");
+    DeferredArg arg;
+    arg.isFloat = std::is_floating_point<T>::value;
+    if (arg.isFloat) {
+        arg.f = static_cast<double>(value);
+    } else {
+        arg.i = static_cast<int64_t>(value);
+    }
+    return arg;
+}
+
+// fmt must outlive the record (use a string literal); it is only expanded by the drain task.
+template <typename... Args>
+void writeDeferred(Level level, Category category, const char* fmt, Args... args) {
+    static_assert(sizeof...(Args) <= MAX_DEFERRED_ARGS, "too many deferred log arguments");
+    DeferredArg packed[sizeof...(Args) + 1] = {deferredArg(args)...};
+    writeDeferredPacked(level, category, fmt, packed, sizeof...(Args));
+}
+
+}  // namespace Log
+
+// Disabled levels/categories fold to `if (false)`, so their arguments are never evaluated.
+#define LOG_AT(level, category, ...)                                   \
+    do {                                                               \
+        if (Log::compiledIn(level, category)) {                        \
+            Log::write(level, category, __VA_ARGS__);                  \
+        }                                                              \
+    } while (0)
+
+#define LOG_E(category, ...) LOG_AT(Log::Level::Error, Log::Category::category, __VA_ARGS__)
+#define LOG_W(category, ...) LOG_AT(Log::Level::Warn, Log::Category::category, __VA_ARGS__)
+#define LOG_I(category, ...) LOG_AT(Log::Level::Info, Log::Category::category, __VA_ARGS__)
+#define LOG_D(category, ...) LOG_AT(Log::Level::Debug, Log::Category::category, __VA_ARGS__)
+#define LOG_V(category, ...) LOG_AT(Log::Level::Verbose, Log::Category::category, __VA_ARGS__)
+
+#define LOG_DEFERRED(level, category, ...)                                                          \
+    do {                                                                                            \
+        if (Log::compiledIn(Log::Level::level, Log::Category::category)) {                          \
+            Log::writeDeferred(Log::Level::level, Log::Category::category, __VA_ARGS__);            \
+        }                                                                                           \
+    } while (0)
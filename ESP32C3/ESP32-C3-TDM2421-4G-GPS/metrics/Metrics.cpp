@@ -0,0 +1,262 @@
+#include "Metrics.h"
+
+#include <freertos/FreeRTOS.h>
+#include <stdarg.h>
+
+#include "../logging/Log.h"
+
+namespace {
+
+constexpr uint32_t LATENCY_BUCKETS_MS[] = {5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 30000, 60000};
+constexpr size_t LATENCY_BUCKET_COUNT = sizeof(LATENCY_BUCKETS_MS) / sizeof(LATENCY_BUCKETS_MS[0]);
+constexpr size_t COUNTER_COUNT = static_cast<size_t>(Metrics::Counter::Count);
+constexpr size_t HISTOGRAM_COUNT = static_cast<size_t>(Metrics::Histogram::Count);
+constexpr size_t GAUGE_COUNT = static_cast<size_t>(Metrics::Gauge::Count);
+
+// key: /stats JSON field, family + labels: Prometheus series. Entries sharing a family must be adjacent.
+struct MetricDescriptor {
+    const char* key;
+    const char* family;
+    const char* labels;
+};
+
+constexpr MetricDescriptor COUNTER_DESCRIPTORS[COUNTER_COUNT] = {
+    {"atCommandOk", "tracker_at_commands_total", "result=\"ok\""},
+    {"atCommandFailed", "tracker_at_commands_total", "result=\"error\""},
+    {"gpsFixOk", "tracker_gps_fixes_total", "result=\"ok\""},
+    {"gpsFixFailed", "tracker_gps_fixes_total", "result=\"error\""},
+    {"wifiUploadOk", "tracker_uploads_total", "transport=\"wifi\",result=\"ok\""},
+    {"wifiUploadFailed", "tracker_uploads_total", "transport=\"wifi\",result=\"error\""},
+    {"cellularUploadOk", "tracker_uploads_total", "transport=\"4g\",result=\"ok\""},
+    {"cellularUploadFailed", "tracker_uploads_total", "transport=\"4g\",result=\"error\""},
+    {"fixQueueDropped", "tracker_fix_queue_dropped_total", ""},
+    {"backlogOverflow", "tracker_backlog_overflow_total", ""},
+    {"lightSleepCycles", "tracker_light_sleep_cycles_total", ""},
+    {"uartWakeups", "tracker_uart_wakeups_total", ""},
+    {"wifiBreakerOpened", "tracker_breaker_opened_total", "transport=\"wifi\""},
+    {"cellularBreakerOpened", "tracker_breaker_opened_total", "transport=\"4g\""},
+    {"hedgeLaunched", "tracker_hedged_uploads_total", "result=\"launched\""},
+    {"hedgeWon", "tracker_hedged_uploads_total", "result=\"won\""},
+    {"cellFixOk", "tracker_cell_fixes_total", "result=\"ok\""},
+    {"cellFixFailed", "tracker_cell_fixes_total", "result=\"error\""},
+};
+
+constexpr MetricDescriptor HISTOGRAM_DESCRIPTORS[HISTOGRAM_COUNT] = {
+    {"atCommand", "tracker_at_command_seconds", ""},
+    {"gpsFix", "tracker_gps_fix_seconds", ""},
+    {"wifiUpload", "tracker_upload_seconds", "transport=\"wifi\""},
+    {"cellularUpload", "tracker_upload_seconds", "transport=\"4g\""},
+    {"nvsWrite", "tracker_nvs_write_seconds", ""},
+    {"modemTask", "tracker_task_iteration_seconds", "task=\"modem\""},
+    {"gnssTask", "tracker_task_iteration_seconds", "task=\"gnss\""},
+    {"uploaderTask", "tracker_task_iteration_seconds", "task=\"uploader\""},
+    {"connectivityTask", "tracker_task_iteration_seconds", "task=\"connectivity\""},
+};
+
+constexpr MetricDescriptor GAUGE_DESCRIPTORS[GAUGE_COUNT] = {
+    {"backlogDepth", "tracker_backlog_depth", ""},
+    {"awakeSeconds", "tracker_duty_cycle_seconds", "state=\"awake\""},
+    {"sleepSeconds", "tracker_duty_cycle_seconds", "state=\"sleep\""},
+    {"fixesDelivered", "tracker_fixes_delivered", ""},
+    {"energyUah", "tracker_energy_uah", ""},
+    {"energyPerFixUah", "tracker_energy_per_fix_uah", ""},
+    {"sampleIntervalSeconds", "tracker_sample_interval_seconds", ""},
+    {"wifiBreakerState", "tracker_breaker_state", "transport=\"wifi\""},
+    {"cellularBreakerState", "tracker_breaker_state", "transport=\"4g\""},
+};
+
+struct LatencyHistogram {
+    uint32_t buckets[LATENCY_BUCKET_COUNT + 1];
+    uint32_t count;
+    uint32_t maxMs;
+    uint64_t sumMs;
+};
+
+struct MetricsState {
+    uint32_t counters[COUNTER_COUNT];
+    LatencyHistogram histograms[HISTOGRAM_COUNT];
+    uint32_t gauges[GAUGE_COUNT];
+};
+
+MetricsState metricsState = {};
+portMUX_TYPE metricsLock = portMUX_INITIALIZER_UNLOCKED;
+
+MetricsState snapshotMetrics() {
+    portENTER_CRITICAL(&metricsLock);
+    MetricsState copy = metricsState;
+    portEXIT_CRITICAL(&metricsLock);
+    return copy;
+}
+
+// Small stack buffer flushed to the sink as it fills, so a scrape never builds the whole
+// document in a heap String.
+struct ChunkWriter {
+    Metrics::Sink sink;
+    char buffer[256];
+    size_t used;
+};
+
+void flushChunk(ChunkWriter& writer) {
+    if (writer.used > 0) {
+        writer.sink(writer.buffer, writer.used);
+        writer.used = 0;
+    }
+}
+
+void writeFormatted(ChunkWriter& writer, const char* format, ...) {
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(writer.buffer + writer.used, sizeof(writer.buffer) - writer.used, format, args);
+        va_end(args);
+        if (length < 0) {
+            return;
+        }
+        if (writer.used + static_cast<size_t>(length) < sizeof(writer.buffer)) {
+            writer.used += length;
+            return;
+        }
+        // Did not fit: flush what was there and format again into the empty buffer.
+        flushChunk(writer);
+    }
+}
+
+// Prometheus wants base units: milliseconds are written as seconds with trailing zeros trimmed.
+const char* formatSeconds(uint64_t ms, char* out, size_t capacity) {
+    snprintf(out, capacity, "%llu.%03u", static_cast<unsigned long long>(ms / 1000), static_cast<unsigned>(ms % 1000));
+    size_t length = strlen(out);
+    while (out[length - 1] == '0') {
+        out[--length] = '\0';
+    }
+    if (out[length - 1] == '.') {
+        out[--length] = '\0';
+    }
+    return out;
+}
+
+void writePromType(ChunkWriter& writer, const MetricDescriptor* descriptors, size_t index, const char* type) {
+    if (index > 0 && strcmp(descriptors[index - 1].family, descriptors[index].family) == 0) {
+        return;
+    }
+    writeFormatted(writer, "# TYPE %s %s\n", descriptors[index].family, type);
+}
+
+void writePromSample(ChunkWriter& writer, const MetricDescriptor& descriptor, const char* suffix,
+                     const char* extraLabel, const char* value) {
+    bool hasLabels = descriptor.labels[0] != '\0';
+    bool hasExtra = extraLabel[0] != '\0';
+    writeFormatted(writer, "%s%s%s%s%s%s%s %s\n", descriptor.family, suffix, hasLabels || hasExtra ? "{" : "",
+                   descriptor.labels, hasLabels && hasExtra ? "," : "", extraLabel, hasLabels || hasExtra ? "}" : "",
+                   value);
+}
+
+}  // namespace
+
+namespace Metrics {
+
+void increment(Counter counter) {
+    portENTER_CRITICAL(&metricsLock);
+    ++metricsState.counters[static_cast<size_t>(counter)];
+    portEXIT_CRITICAL(&metricsLock);
+}
+
+void observe(Histogram histogram, uint32_t elapsedMs) {
+    size_t bucket = 0;
+    while (bucket < LATENCY_BUCKET_COUNT && elapsedMs > LATENCY_BUCKETS_MS[bucket]) {
+        ++bucket;
+    }
+    portENTER_CRITICAL(&metricsLock);
+    LatencyHistogram& target = metricsState.histograms[static_cast<size_t>(histogram)];
+    ++target.buckets[bucket];
+    ++target.count;
+    target.sumMs += elapsedMs;
+    if (elapsedMs > target.maxMs) {
+        target.maxMs = elapsedMs;
+    }
+    portEXIT_CRITICAL(&metricsLock);
+}
+
+void setGauge(Gauge gauge, uint32_t value) {
+    portENTER_CRITICAL(&metricsLock);
+    metricsState.gauges[static_cast<size_t>(gauge)] = value;
+    portEXIT_CRITICAL(&metricsLock);
+}
+
+void writePrometheus(Sink sink) {
+    MetricsState state = snapshotMetrics();
+    ChunkWriter writer{sink, {}, 0};
+    char value[24];
+    for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+        writePromType(writer, COUNTER_DESCRIPTORS, i, "counter");
+        snprintf(value, sizeof(value), "%lu", static_cast<unsigned long>(state.counters[i]));
+        writePromSample(writer, COUNTER_DESCRIPTORS[i], "", "", value);
+    }
+    for (size_t i = 0; i < HISTOGRAM_COUNT; ++i) {
+        const LatencyHistogram& histogram = state.histograms[i];
+        writePromType(writer, HISTOGRAM_DESCRIPTORS, i, "histogram");
+        uint32_t cumulative = 0;
+        for (size_t b = 0; b <= LATENCY_BUCKET_COUNT; ++b) {
+            cumulative += histogram.buckets[b];
+            char seconds[16];
+            char le[32];
+            snprintf(le, sizeof(le), "le=\"%s\"",
+                     b < LATENCY_BUCKET_COUNT ? formatSeconds(LATENCY_BUCKETS_MS[b], seconds, sizeof(seconds)) : "+Inf");
+            snprintf(value, sizeof(value), "%lu", static_cast<unsigned long>(cumulative));
+            writePromSample(writer, HISTOGRAM_DESCRIPTORS[i], "_bucket", le, value);
+        }
+        writePromSample(writer, HISTOGRAM_DESCRIPTORS[i], "_sum", "", formatSeconds(histogram.sumMs, value, sizeof(value)));
+        snprintf(value, sizeof(value), "%lu", static_cast<unsigned long>(histogram.count));
+        writePromSample(writer, HISTOGRAM_DESCRIPTORS[i], "_count", "", value);
+    }
+    for (size_t i = 0; i < GAUGE_COUNT; ++i) {
+        writePromType(writer, GAUGE_DESCRIPTORS, i, "gauge");
+        snprintf(value, sizeof(value), "%lu", static_cast<unsigned long>(state.gauges[i]));
+        writePromSample(writer, GAUGE_DESCRIPTORS[i], "", "", value);
+    }
+    writeFormatted(writer, "# TYPE tracker_heap_free_bytes gauge\ntracker_heap_free_bytes %lu\n",
+                   static_cast<unsigned long>(ESP.getFreeHeap()));
+    writeFormatted(writer, "# TYPE tracker_heap_min_free_bytes gauge\ntracker_heap_min_free_bytes %lu\n",
+                   static_cast<unsigned long>(ESP.getMinFreeHeap()));
+    writeFormatted(writer, "# TYPE tracker_uptime_seconds gauge\ntracker_uptime_seconds %lu\n",
+                   static_cast<unsigned long>(millis() / 1000UL));
+    writeFormatted(writer, "# TYPE tracker_log_dropped_total counter\ntracker_log_dropped_total %lu\n",
+                   static_cast<unsigned long>(Log::droppedRecords()));
+    flushChunk(writer);
+}
+
+void writeJson(Sink sink) {
+    MetricsState state = snapshotMetrics();
+    ChunkWriter writer{sink, {}, 0};
+    writeFormatted(writer, "{\"uptimeMs\":%lu,\"heap\":{\"free\":%lu,\"minFree\":%lu},\"logDropped\":%lu",
+                   static_cast<unsigned long>(millis()), static_cast<unsigned long>(ESP.getFreeHeap()),
+                   static_cast<unsigned long>(ESP.getMinFreeHeap()), static_cast<unsigned long>(Log::droppedRecords()));
+    writeFormatted(writer, ",\"counters\":{");
+    for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+        writeFormatted(writer, "%s\"%s\":%lu", i == 0 ? "" : ",", COUNTER_DESCRIPTORS[i].key,
+                       static_cast<unsigned long>(state.counters[i]));
+    }
+    writeFormatted(writer, "},\"gauges\":{");
+    for (size_t i = 0; i < GAUGE_COUNT; ++i) {
+        writeFormatted(writer, "%s\"%s\":%lu", i == 0 ? "" : ",", GAUGE_DESCRIPTORS[i].key,
+                       static_cast<unsigned long>(state.gauges[i]));
+    }
+    writeFormatted(writer, "},\"latencyBucketsMs\":[");
+    for (size_t b = 0; b < LATENCY_BUCKET_COUNT; ++b) {
+        writeFormatted(writer, "%s%lu", b == 0 ? "" : ",", static_cast<unsigned long>(LATENCY_BUCKETS_MS[b]));
+    }
+    writeFormatted(writer, "],\"histograms\":{");
+    for (size_t i = 0; i < HISTOGRAM_COUNT; ++i) {
+        const LatencyHistogram& histogram = state.histograms[i];
+        writeFormatted(writer, "%s\"%s\":{\"count\":%lu,\"sumMs\":%llu,\"maxMs\":%lu,\"buckets\":[",
+                       i == 0 ? "" : ",", HISTOGRAM_DESCRIPTORS[i].key, static_cast<unsigned long>(histogram.count),
+                       static_cast<unsigned long long>(histogram.sumMs), static_cast<unsigned long>(histogram.maxMs));
+        for (size_t b = 0; b <= LATENCY_BUCKET_COUNT; ++b) {
+            writeFormatted(writer, "%s%lu", b == 0 ? "" : ",", static_cast<unsigned long>(histogram.buckets[b]));
+        }
+        writeFormatted(writer, "]}");
+    }
+    writeFormatted(writer, "}}");
+    flushChunk(writer);
+}
+
+}  // namespace Metrics
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace Metrics {
+
+enum class Counter : uint8_t {
+    AtCommandOk,
+    AtCommandFailed,
+    GpsFixOk,
+    GpsFixFailed,
+    WifiUploadOk,
+    WifiUploadFailed,
+    CellularUploadOk,
+    CellularUploadFailed,
+    FixQueueDropped,
+    BacklogOverflow,
+    LightSleepCycles,
+    UartWakeups,
+    WifiBreakerOpened,
+    CellularBreakerOpened,
+    HedgeLaunched,
+    HedgeWon,
+    CellFixOk,
+    CellFixFailed,
+    Count,
+};
+
+enum class Histogram : uint8_t {
+    AtCommand,
+    GpsFix,
+    WifiUpload,
+    CellularUpload,
+    NvsWrite,
+    ModemTaskIteration,
+    GnssTaskIteration,
+    UploaderTaskIteration,
+    ConnectivityTaskIteration,
+    Count,
+};
+
+enum class Gauge : uint8_t {
+    BacklogDepth,
+    AwakeSeconds,
+    SleepSeconds,
+    FixesDelivered,
+    EnergyMicroAmpHours,
+    EnergyPerFixMicroAmpHours,
+    SampleIntervalSeconds,
+    WifiBreakerState,
+    CellularBreakerState,
+    Count,
+};
+
+void increment(Counter counter);
+void observe(Histogram histogram, uint32_t elapsedMs);
+void setGauge(Gauge gauge, uint32_t value);
+
+// Both renderers stream through sink in small chunks; nothing document-sized is allocated.
+using Sink = void (*)(const char* data, size_t length);
+void writePrometheus(Sink sink);
+void writeJson(Sink sink);
+
+}  // namespace Metrics
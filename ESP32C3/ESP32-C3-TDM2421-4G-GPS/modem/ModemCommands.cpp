@@ -3,6 +3,8 @@
 #include <HardwareSerial.h>
 
 #include "../config/AppConfig.h"
+#include "../logging/Log.h"
+#include "../metrics/Metrics.h"
 
 namespace {
 
@@ -10,18 +12,38 @@ HardwareSerial& modemPort() {
     return AppConfig::modemSerial();
 }
 
+// URCs land in whichever response is being read when they arrive, so every helper scans
+// what it read. +QMTSTAT means the broker or network closed the MQTT client.
+bool mqttLinkDropped = false;
+
+void noteUnsolicited(const String& text) {
+    if (text.indexOf("+QMTSTAT:") != -1) {
+        mqttLinkDropped = true;
+    }
+}
+
+bool recordAtCommand(unsigned long startedAt, bool ok) {
+    Metrics::observe(Metrics::Histogram::AtCommand, millis() - startedAt);
+    Metrics::increment(ok ? Metrics::Counter::AtCommandOk : Metrics::Counter::AtCommandFailed);
+    return ok;
+}
+
 }  // namespace
 
 void sim_at_wait() {
     delay(500);
+    String response;
     while (modemPort().available()) {
-        Serial.write(modemPort().read());
+        response += static_cast<char>(modemPort().read());
+    }
+    if (!response.isEmpty()) {
+        LOG_I(Modem, "< %s", response.c_str());
     }
+    noteUnsolicited(response);
 }
 
 bool sim_at_cmd(const String& cmd) {
-    Serial.print("Sending command: ");
-    Serial.println(cmd);
+    LOG_I(Modem, "> %s", cmd.c_str());
     modemPort().println(cmd);
     delay(500);
     sim_at_wait();
@@ -34,8 +56,7 @@ bool sim_at_send(char c) {
 }
 
 bool sim_at_cmd_with_response(const String& cmd, String& response, uint32_t timeoutMs) {
-    Serial.print("Sending command: ");
-    Serial.println(cmd);
+    LOG_D(Modem, "> %s", cmd.c_str());
     modemPort().println(cmd);
     response = "";
     unsigned long start = millis();
@@ -49,9 +70,9 @@ bool sim_at_cmd_with_response(const String& cmd, String& response, uint32_t time
         }
         delay(10);
     }
-    Serial.print("Received: ");
-    Serial.println(response);
-    return response.indexOf("OK") != -1;
+    LOG_D(Modem, "< %s", response.c_str());
+    noteUnsolicited(response);
+    return recordAtCommand(start, response.indexOf("OK") != -1);
 }
 
 bool waitForSubstring(const String& expect, uint32_t timeoutMs, String* response) {
@@ -60,15 +81,16 @@ bool waitForSubstring(const String& expect, uint32_t timeoutMs, String* response
     while (millis() - start < timeoutMs) {
         while (modemPort().available()) {
             char c = modemPort().read();
-            Serial.write(c);
             buffer += c;
             if (buffer.indexOf("ERROR") != -1) {
+                noteUnsolicited(buffer);
                 if (response) {
                     *response = buffer;
                 }
                 return false;
             }
             if (buffer.indexOf(expect) != -1) {
+                noteUnsolicited(buffer);
                 if (response) {
                     *response = buffer;
                 }
@@ -77,19 +99,52 @@ bool waitForSubstring(const String& expect, uint32_t timeoutMs, String* response
         }
         delay(10);
     }
+    LOG_V(Modem, "< (timeout) %s", buffer.c_str());
+    noteUnsolicited(buffer);
     if (response) {
         *response = buffer;
     }
     return false;
 }
 
+// Waits for a URC and returns whatever follows the prefix up to the end of that line,
+// e.g. prefix "+QMTOPEN: 0," yields the result code.
+bool waitForUrcLine(const String& prefix, uint32_t timeoutMs, String& line) {
+    String buffer;
+    line = "";
+    if (!waitForSubstring(prefix, timeoutMs, &buffer)) {
+        return false;
+    }
+    line = buffer.substring(buffer.indexOf(prefix) + prefix.length());
+    unsigned long start = millis();
+    while (line.indexOf('\n') == -1 && millis() - start < timeoutMs) {
+        while (modemPort().available()) {
+            line += static_cast<char>(modemPort().read());
+        }
+        delay(5);
+    }
+    int lineEnd = line.indexOf('\n');
+    if (lineEnd != -1) {
+        line = line.substring(0, lineEnd);
+    }
+    line.trim();
+    LOG_D(Modem, "< %s%s", prefix.c_str(), line.c_str());
+    return lineEnd != -1;
+}
+
+bool takeMqttLinkDropped() {
+    bool dropped = mqttLinkDropped;
+    mqttLinkDropped = false;
+    return dropped;
+}
+
 bool sim_at_cmd_expect(const String& cmd,
                        const String& expect,
                        uint32_t timeoutMs,
                        String* response) {
-    Serial.print("Sending command: ");
-    Serial.println(cmd);
+    LOG_D(Modem, "> %s", cmd.c_str());
+    unsigned long start = millis();
     modemPort().println(cmd);
-    return waitForSubstring(expect, timeoutMs, response);
+    return recordAtCommand(start, waitForSubstring(expect, timeoutMs, response));
 }
 
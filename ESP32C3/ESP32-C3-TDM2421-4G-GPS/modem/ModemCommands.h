@@ -7,6 +7,9 @@ bool sim_at_cmd(const String& cmd);
 bool sim_at_send(char c);
 bool sim_at_cmd_with_response(const String& cmd, String& response, uint32_t timeoutMs = 5000);
 bool waitForSubstring(const String& expect, uint32_t timeoutMs, String* response = nullptr);
+bool waitForUrcLine(const String& prefix, uint32_t timeoutMs, String& line);
+// True when a +QMTSTAT URC (MQTT client closed by the broker or network) was read since the last call.
+bool takeMqttLinkDropped();
 bool sim_at_cmd_expect(const String& cmd,
                        const String& expect,
                        uint32_t timeoutMs = 5000,
@@ -0,0 +1,136 @@
+#include "ModemTask.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+#include "../config/AppConfig.h"
+#include "../logging/Log.h"
+#include "../metrics/Metrics.h"
+#include "../power/PowerManager.h"
+
+namespace {
+
+struct ModemRequest {
+    ModemTask::Job job;
+    void* context;
+    TaskHandle_t requester;
+    bool* result;
+};
+
+QueueHandle_t modemUrgentQueue = nullptr;
+QueueHandle_t modemBulkQueue = nullptr;
+TaskHandle_t modemTaskHandle = nullptr;
+// Time spent in urgent jobs run inline by yieldToUrgent(), so the enclosing bulk job is not
+// billed for it twice.
+uint32_t inlineJobMs = 0;
+bool runningInline = false;
+
+void forwardUsbToModem() {
+    while (Serial.available()) {
+        AppConfig::modemSerial().write(Serial.read());
+    }
+}
+
+bool nextModemRequest(ModemRequest& request) {
+    if (xQueueReceive(modemUrgentQueue, &request, 0) == pdTRUE) {
+        return true;
+    }
+    return xQueueReceive(modemBulkQueue, &request, pdMS_TO_TICKS(AppConfig::MODEM_TASK_POLL_MS)) == pdTRUE;
+}
+
+uint32_t executeModemRequest(const ModemRequest& request) {
+    unsigned long jobStart = millis();
+    bool result = request.job(request.context);
+    if (request.requester != nullptr) {
+        *request.result = result;
+        xTaskNotifyGive(request.requester);
+    }
+    return millis() - jobStart;
+}
+
+void modemTaskMain(void*) {
+    for (;;) {
+        forwardUsbToModem();
+        ModemRequest request;
+        if (!nextModemRequest(request)) {
+            continue;
+        }
+        inlineJobMs = 0;
+        uint32_t jobMs = executeModemRequest(request) - inlineJobMs;
+        Metrics::observe(Metrics::Histogram::ModemTaskIteration, jobMs);
+        PowerManager::addModemActiveMs(jobMs);
+    }
+}
+
+}  // namespace
+
+namespace ModemTask {
+
+void start() {
+    if (modemTaskHandle != nullptr) {
+        return;
+    }
+    modemUrgentQueue = xQueueCreate(AppConfig::MODEM_URGENT_QUEUE_DEPTH, sizeof(ModemRequest));
+    modemBulkQueue = xQueueCreate(AppConfig::MODEM_BULK_QUEUE_DEPTH, sizeof(ModemRequest));
+    if (modemUrgentQueue == nullptr || modemBulkQueue == nullptr) {
+        LOG_E(Tasks, "Failed to allocate modem job queues");
+        return;
+    }
+    if (xTaskCreate(modemTaskMain,
+                    "modem",
+                    AppConfig::MODEM_TASK_STACK_BYTES,
+                    nullptr,
+                    AppConfig::MODEM_TASK_PRIORITY,
+                    &modemTaskHandle) != pdPASS) {
+        LOG_E(Tasks, "Failed to start modem task");
+        modemTaskHandle = nullptr;
+    }
+}
+
+bool running() {
+    return modemTaskHandle != nullptr;
+}
+
+bool run(Job job, void* context, Lane lane, uint32_t enqueueTimeoutMs) {
+    // Before the task exists (setup diagnostics) the caller still owns the UART.
+    if (!running()) {
+        return job(context);
+    }
+    bool result = false;
+    ModemRequest request{job, context, xTaskGetCurrentTaskHandle(), &result};
+    QueueHandle_t queue = lane == Lane::Urgent ? modemUrgentQueue : modemBulkQueue;
+    if (xQueueSend(queue, &request, pdMS_TO_TICKS(enqueueTimeoutMs)) != pdTRUE) {
+        LOG_W(Tasks, "Modem job queue full, request dropped");
+        return false;
+    }
+    // The job writes through pointers into this stack frame, so wait for it unconditionally.
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    return result;
+}
+
+void yieldToUrgent() {
+    if (!running() || runningInline || xTaskGetCurrentTaskHandle() != modemTaskHandle) {
+        return;
+    }
+    runningInline = true;
+    ModemRequest request;
+    while (xQueueReceive(modemUrgentQueue, &request, 0) == pdTRUE) {
+        uint32_t jobMs = executeModemRequest(request);
+        inlineJobMs += jobMs;
+        Metrics::observe(Metrics::Histogram::ModemTaskIteration, jobMs);
+        PowerManager::addModemActiveMs(jobMs);
+    }
+    runningInline = false;
+}
+
+bool post(Job job, void* context, Lane lane) {
+    if (!running()) {
+        return false;
+    }
+    ModemRequest request{job, context, nullptr, nullptr};
+    QueueHandle_t queue = lane == Lane::Urgent ? modemUrgentQueue : modemBulkQueue;
+    return xQueueSend(queue, &request, 0) == pdTRUE;
+}
+
+}  // namespace ModemTask
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace ModemTask {
+
+enum class Lane : uint8_t {
+    Urgent,
+    Bulk,
+};
+
+using Job = bool (*)(void* context);
+
+void start();
+bool running();
+bool run(Job job, void* context, Lane lane, uint32_t enqueueTimeoutMs = 1000);
+// Fire-and-forget: never blocks, the job owns (and frees) its context.
+bool post(Job job, void* context, Lane lane);
+// Called by long bulk jobs at points where no modem reply is outstanding (between polls,
+// between request/response exchanges): runs any queued urgent jobs inline. No-op elsewhere.
+void yieldToUrgent();
+
+}  // namespace ModemTask
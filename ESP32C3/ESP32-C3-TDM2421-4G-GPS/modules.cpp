@@ -1,11 +1,22 @@
 #include "cellular/CellularClient.cpp"
+#include "cellular/CoapClient.cpp"
+#include "cellular/MqttClient.cpp"
+#include "gps/CellLocator.cpp"
 #include "gps/GpsService.cpp"
+#include "gps/SamplingScheduler.cpp"
+#include "logging/Log.cpp"
+#include "metrics/Metrics.cpp"
 #include "modem/ModemCommands.cpp"
+#include "modem/ModemTask.cpp"
+#include "net/CborWriter.cpp"
 #include "net/GeoPayload.cpp"
 #include "net/GeoUploader.cpp"
+#include "net/LinkHealth.cpp"
 #include "net/UrlParser.cpp"
 #include "net/WifiUploader.cpp"
+#include "power/PowerManager.cpp"
 #include "storage/GeoBuffer.cpp"
+#include "tasks/AppTasks.cpp"
 #include "utils/StringUtils.cpp"
 #include "wifi/WifiManager.cpp"
 
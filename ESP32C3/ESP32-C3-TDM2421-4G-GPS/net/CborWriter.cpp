@@ -0,0 +1,94 @@
+#include "CborWriter.h"
+
+#include <string.h>
+
+namespace {
+
+constexpr uint8_t CBOR_MAJOR_UNSIGNED = 0;
+constexpr uint8_t CBOR_MAJOR_NEGATIVE = 1;
+constexpr uint8_t CBOR_MAJOR_TEXT = 3;
+constexpr uint8_t CBOR_MAJOR_ARRAY = 4;
+constexpr uint8_t CBOR_MAJOR_MAP = 5;
+constexpr uint8_t CBOR_MAJOR_TAG = 6;
+constexpr uint8_t CBOR_FLOAT32 = 0xFA;
+
+}  // namespace
+
+CborWriter::CborWriter(uint8_t* buffer, size_t capacity) : buffer_(buffer), capacity_(capacity) {}
+
+void CborWriter::writeUnsigned(uint64_t value) {
+    writeTypeAndValue(CBOR_MAJOR_UNSIGNED, value);
+}
+
+void CborWriter::writeSigned(int64_t value) {
+    if (value >= 0) {
+        writeTypeAndValue(CBOR_MAJOR_UNSIGNED, static_cast<uint64_t>(value));
+    } else {
+        writeTypeAndValue(CBOR_MAJOR_NEGATIVE, static_cast<uint64_t>(-1 - value));
+    }
+}
+
+void CborWriter::writeFloat(float value) {
+    uint32_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    writeByte(CBOR_FLOAT32);
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        writeByte(static_cast<uint8_t>(bits >> shift));
+    }
+}
+
+void CborWriter::writeText(const char* text, size_t length) {
+    writeTypeAndValue(CBOR_MAJOR_TEXT, length);
+    writeBytes(reinterpret_cast<const uint8_t*>(text), length);
+}
+
+void CborWriter::writeText(const String& text) {
+    writeText(text.c_str(), text.length());
+}
+
+void CborWriter::writeArrayHeader(size_t count) {
+    writeTypeAndValue(CBOR_MAJOR_ARRAY, count);
+}
+
+void CborWriter::writeMapHeader(size_t count) {
+    writeTypeAndValue(CBOR_MAJOR_MAP, count);
+}
+
+void CborWriter::writeTag(uint64_t tag) {
+    writeTypeAndValue(CBOR_MAJOR_TAG, tag);
+}
+
+bool CborWriter::ok() const {
+    return !overflow_;
+}
+
+size_t CborWriter::length() const {
+    return length_;
+}
+
+void CborWriter::writeTypeAndValue(uint8_t majorType, uint64_t value) {
+    uint8_t initial = static_cast<uint8_t>(majorType << 5);
+    if (value < 24) {
+        writeByte(initial | static_cast<uint8_t>(value));
+        return;
+    }
+    uint8_t extraBytes = value <= 0xFF ? 1 : value <= 0xFFFF ? 2 : value <= 0xFFFFFFFFULL ? 4 : 8;
+    uint8_t additional = extraBytes == 1 ? 24 : extraBytes == 2 ? 25 : extraBytes == 4 ? 26 : 27;
+    writeByte(initial | additional);
+    for (int shift = (extraBytes - 1) * 8; shift >= 0; shift -= 8) {
+        writeByte(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+void CborWriter::writeByte(uint8_t value) {
+    writeBytes(&value, 1);
+}
+
+void CborWriter::writeBytes(const uint8_t* data, size_t length) {
+    if (overflow_ || length > capacity_ - length_) {
+        overflow_ = true;
+        return;
+    }
+    memcpy(buffer_ + length_, data, length);
+    length_ += length;
+}
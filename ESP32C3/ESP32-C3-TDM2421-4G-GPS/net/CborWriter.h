@@ -0,0 +1,32 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Minimal RFC 8949 encoder writing definite-length items into a caller-owned buffer.
+// Once the buffer would overflow every further write is ignored and ok() turns false.
+class CborWriter {
+public:
+    CborWriter(uint8_t* buffer, size_t capacity);
+
+    void writeUnsigned(uint64_t value);
+    void writeSigned(int64_t value);
+    void writeFloat(float value);
+    void writeText(const char* text, size_t length);
+    void writeText(const String& text);
+    void writeArrayHeader(size_t count);
+    void writeMapHeader(size_t count);
+    void writeTag(uint64_t tag);
+
+    bool ok() const;
+    size_t length() const;
+
+private:
+    void writeTypeAndValue(uint8_t majorType, uint64_t value);
+    void writeByte(uint8_t value);
+    void writeBytes(const uint8_t* data, size_t length);
+
+    uint8_t* buffer_;
+    size_t capacity_;
+    size_t length_ = 0;
+    bool overflow_ = false;
+};
@@ -35,7 +35,42 @@ String buildGeoSensorPayload(const GpsFix& fix, const char* networkSource) {
         payload += "\"networkSource\":\"" + String(networkSource) + "\",";
     }
     payload += "\"dataAcquiredAt\":\"" + fix.dataAcquiredAt + "\"";
+    if (fix.source == PositionSource::Cell) {
+        payload += ",\"positionSource\":\"cell\",\"accuracy\":" + String(fix.accuracyMeters, 0);
+    }
     payload += "}";
     return payload;
 }
 
+// Compact form for the CoAP path: integer keys, float32 values, sensor id carried in the URI.
+// 1 latitude, 2 longitude, 3 altitude, 4 speed, 5 satelliteCount, 6 dataAcquiredAt, 7 networkSource,
+// and for cell fixes 8 accuracy (m), 9 positionSource
+void encodeGeoSensorCbor(CborWriter& writer, const GpsFix& fix, const char* networkSource) {
+    bool hasSource = networkSource != nullptr && networkSource[0] != '\0';
+    bool cellFix = fix.source == PositionSource::Cell;
+    writer.writeMapHeader(6 + (hasSource ? 1 : 0) + (cellFix ? 2 : 0));
+    writer.writeUnsigned(1);
+    writer.writeFloat(fix.latitude);
+    writer.writeUnsigned(2);
+    writer.writeFloat(fix.longitude);
+    writer.writeUnsigned(3);
+    writer.writeFloat(fix.altitude);
+    writer.writeUnsigned(4);
+    writer.writeFloat(fix.speed);
+    writer.writeUnsigned(5);
+    writer.writeUnsigned(fix.satelliteCount);
+    writer.writeUnsigned(6);
+    writer.writeTag(0);
+    writer.writeText(fix.dataAcquiredAt);
+    if (hasSource) {
+        writer.writeUnsigned(7);
+        writer.writeText(networkSource, strlen(networkSource));
+    }
+    if (cellFix) {
+        writer.writeUnsigned(8);
+        writer.writeFloat(fix.accuracyMeters);
+        writer.writeUnsigned(9);
+        writer.writeText("cell", 4);
+    }
+}
+
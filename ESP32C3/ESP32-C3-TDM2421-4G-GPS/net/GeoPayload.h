@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../gps/GpsTypes.h"
+#include "CborWriter.h"
 
 String buildGeoSensorPayload(const GpsFix& fix, const char* networkSource = nullptr);
+void encodeGeoSensorCbor(CborWriter& writer, const GpsFix& fix, const char* networkSource = nullptr);
 
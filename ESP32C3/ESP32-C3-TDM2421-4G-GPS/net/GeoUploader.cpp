@@ -1,48 +1,318 @@
 #include "GeoUploader.h"
 
 #include <WiFi.h>
+#include <esp_system.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/timers.h>
 
 #include "../cellular/CellularClient.h"
+#include "../cellular/CoapClient.h"
+#include "../cellular/MqttClient.h"
 #include "../config/AppConfig.h"
-#include "../gps/GpsService.h"
+#include "../logging/Log.h"
+#include "../metrics/Metrics.h"
+#include "../modem/ModemTask.h"
+#include "../power/PowerManager.h"
 #include "../storage/GeoBuffer.h"
 #include "../wifi/WifiManager.h"
+#include "LinkHealth.h"
 #include "WifiUploader.h"
 
 namespace {
 
-unsigned long lastGeoSensorPush = 0;
-int geoSensorBackoffStage = -1;
-unsigned long geoSensorNextRetryAt = 0;
+constexpr size_t CELLULAR_BATCH_CAPACITY =
+    AppConfig::MQTT_BATCH_SIZE > AppConfig::COAP_BATCH_SIZE ? AppConfig::MQTT_BATCH_SIZE : AppConfig::COAP_BATCH_SIZE;
 
-bool uploadGeoSensor(const GpsFix& fix) {
-    if (WiFi.status() == WL_CONNECTED) {
-        if (WifiUploader::upload(fix)) {
-            return true;
+// In/out context of cellularUploadJob. encodeFailed means the payload could not be built, so
+// nothing went on the air and the link is not to blame.
+struct CellularBatch {
+    const GpsFix* fixes;
+    size_t count;
+    size_t delivered;
+    bool encodeFailed;
+};
+
+// A cellular upload started by the hedge timer while Wi-Fi is still in flight. It owns a copy
+// of the fixes and is shared by the uploader and the modem job; whoever drops the last
+// reference frees it.
+struct HedgedUpload {
+    GpsFix fixes[CELLULAR_BATCH_CAPACITY];
+    size_t count;
+    SemaphoreHandle_t done;
+    bool launched;
+    size_t delivered;
+    uint8_t refs;
+};
+
+// Fixes deferred between upload slots stay in RAM. They reach NVS only when a slot fails to
+// deliver them, when this queue overflows, or on restart; NVS entries are always older.
+GpsFix deferredFixes[AppConfig::UPLOAD_DEFER_RAM_CAPACITY];
+size_t deferredStart = 0;
+size_t deferredCount = 0;
+
+// Guards the deferred queue and GeoBuffer against the shutdown handler; never held across I/O.
+SemaphoreHandle_t backlogMutex = nullptr;
+
+struct BacklogLock {
+    bool held;
+    explicit BacklogLock(TickType_t wait = portMAX_DELAY)
+        : held(backlogMutex != nullptr && xSemaphoreTake(backlogMutex, wait) == pdTRUE) {}
+    ~BacklogLock() {
+        if (held) {
+            xSemaphoreGive(backlogMutex);
         }
-        Serial.println("WiFi upload failed, trying cellular fallback");
     }
-    return CellularClient::upload(fix);
+};
+
+TimerHandle_t hedgeTimer = nullptr;
+HedgedUpload* armedHedge = nullptr;
+portMUX_TYPE hedgeLock = portMUX_INITIALIZER_UNLOCKED;
+
+size_t cellularBatchLimit() {
+    switch (AppConfig::CELL_TRANSPORT) {
+        case AppConfig::CellularTransport::Mqtt:
+            return AppConfig::MQTT_BATCH_SIZE;
+        case AppConfig::CellularTransport::Coap:
+            return AppConfig::COAP_BATCH_SIZE;
+        case AppConfig::CellularTransport::Http:
+        default:
+            return 1;
+    }
 }
 
-bool geoSensorUploadReady() {
-    return geoSensorBackoffStage < 0 || millis() >= geoSensorNextRetryAt;
+bool cellularUploadJob(void* context) {
+    CellularBatch& batch = *static_cast<CellularBatch*>(context);
+    switch (AppConfig::CELL_TRANSPORT) {
+        case AppConfig::CellularTransport::Mqtt:
+            batch.delivered = MqttClient::publishBatch(batch.fixes, batch.count) ? batch.count : 0;
+            break;
+        case AppConfig::CellularTransport::Coap:
+            batch.delivered = CoapClient::uploadBatch(batch.fixes, batch.count, batch.encodeFailed);
+            break;
+        case AppConfig::CellularTransport::Http:
+        default:
+            batch.delivered = CellularClient::upload(batch.fixes[0]) ? 1 : 0;
+            break;
+    }
+    return batch.delivered > 0;
+}
+
+bool recordUpload(Metrics::Histogram histogram, Metrics::Counter okCounter, Metrics::Counter failedCounter,
+                  unsigned long startedAt, bool ok) {
+    Metrics::observe(histogram, millis() - startedAt);
+    Metrics::increment(ok ? okCounter : failedCounter);
+    return ok;
+}
+
+// Runs cellularUploadJob and feeds the outcome to metrics and the cellular breaker; returns
+// how many leading fixes were delivered. A local encoding failure touches neither.
+size_t runCellularUpload(CellularBatch& batch, bool onModemTask) {
+    unsigned long cellularStart = millis();
+    bool ok = onModemTask ? cellularUploadJob(&batch) : ModemTask::run(cellularUploadJob, &batch, ModemTask::Lane::Bulk);
+    if (batch.encodeFailed) {
+        return 0;
+    }
+    recordUpload(Metrics::Histogram::CellularUpload,
+                 Metrics::Counter::CellularUploadOk,
+                 Metrics::Counter::CellularUploadFailed,
+                 cellularStart,
+                 ok);
+    if (ok) {
+        LinkHealth::recordSuccess(LinkHealth::Link::Cellular, millis() - cellularStart);
+    } else {
+        LinkHealth::recordFailure(LinkHealth::Link::Cellular);
+    }
+    return ok ? batch.delivered : 0;
+}
+
+void releaseHedge(HedgedUpload* hedge) {
+    portENTER_CRITICAL(&hedgeLock);
+    bool last = --hedge->refs == 0;
+    portEXIT_CRITICAL(&hedgeLock);
+    if (last) {
+        vSemaphoreDelete(hedge->done);
+        delete hedge;
+    }
+}
+
+bool hedgedCellularJob(void* context) {
+    HedgedUpload* hedge = static_cast<HedgedUpload*>(context);
+    CellularBatch batch{hedge->fixes, hedge->count, 0, false};
+    size_t deliveredCount = runCellularUpload(batch, true);
+    hedge->delivered = deliveredCount;
+    xSemaphoreGive(hedge->done);
+    releaseHedge(hedge);
+    return deliveredCount > 0;
+}
+
+void hedgeTimerFired(TimerHandle_t) {
+    portENTER_CRITICAL(&hedgeLock);
+    HedgedUpload* hedge = armedHedge;
+    armedHedge = nullptr;
+    if (hedge != nullptr) {
+        hedge->launched = true;
+        ++hedge->refs;
+    }
+    portEXIT_CRITICAL(&hedgeLock);
+    if (hedge == nullptr) {
+        return;
+    }
+    Metrics::increment(Metrics::Counter::HedgeLaunched);
+    if (!ModemTask::post(hedgedCellularJob, hedge, ModemTask::Lane::Bulk)) {
+        hedge->delivered = 0;
+        xSemaphoreGive(hedge->done);
+        releaseHedge(hedge);
+    }
+}
+
+HedgedUpload* armHedge(const GpsFix* fixes, size_t count) {
+    if (!AppConfig::HEDGE_ENABLED || hedgeTimer == nullptr || AppConfig::CELL_APN[0] == '\0' ||
+        !LinkHealth::available(LinkHealth::Link::Cellular)) {
+        return nullptr;
+    }
+    HedgedUpload* hedge = new HedgedUpload();
+    hedge->done = xSemaphoreCreateBinary();
+    if (hedge->done == nullptr) {
+        delete hedge;
+        return nullptr;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        hedge->fixes[i] = fixes[i];
+    }
+    hedge->count = count;
+    hedge->refs = 1;
+    portENTER_CRITICAL(&hedgeLock);
+    armedHedge = hedge;
+    portEXIT_CRITICAL(&hedgeLock);
+    uint32_t delayMs = LinkHealth::hedgeDelayMs(LinkHealth::Link::Wifi);
+    if (xTimerChangePeriod(hedgeTimer, pdMS_TO_TICKS(delayMs), 0) != pdPASS) {
+        portENTER_CRITICAL(&hedgeLock);
+        armedHedge = nullptr;
+        portEXIT_CRITICAL(&hedgeLock);
+        releaseHedge(hedge);
+        return nullptr;
+    }
+    return hedge;
+}
+
+// Disarms the timer. Returns true if the hedge had launched; then, if Wi-Fi failed, waits
+// for the cellular result and reports how many fixes it delivered.
+bool settleHedge(HedgedUpload* hedge, bool wifiOk, size_t& hedgeDelivered) {
+    hedgeDelivered = 0;
+    if (hedge == nullptr) {
+        return false;
+    }
+    xTimerStop(hedgeTimer, 0);
+    portENTER_CRITICAL(&hedgeLock);
+    if (armedHedge == hedge) {
+        armedHedge = nullptr;
+    }
+    bool launched = hedge->launched;
+    portEXIT_CRITICAL(&hedgeLock);
+    if (launched && !wifiOk) {
+        xSemaphoreTake(hedge->done, portMAX_DELAY);
+        hedgeDelivered = hedge->delivered;
+        if (hedgeDelivered > 0) {
+            Metrics::increment(Metrics::Counter::HedgeWon);
+        }
+    }
+    releaseHedge(hedge);
+    return launched;
+}
+
+size_t delivered(size_t count) {
+    PowerManager::recordDelivered(count);
+    return count;
+}
+
+// Returns how many of the leading fixes were delivered: Wi-Fi and HTTP send one,
+// MQTT and CoAP may deliver up to cellularBatchLimit() in a single exchange (CoAP sends the
+// prefix that fits its body buffer).
+// A link whose breaker is cooling down is skipped, so a dead AP costs cellular nothing;
+// a slow one gets a hedged cellular attempt once it runs past its latency percentile.
+size_t uploadGeoSensor(const GpsFix* fixes, size_t count) {
+    size_t cellularCount = count < cellularBatchLimit() ? count : cellularBatchLimit();
+    if (WiFi.status() == WL_CONNECTED && LinkHealth::available(LinkHealth::Link::Wifi)) {
+        HedgedUpload* hedge = armHedge(fixes, cellularCount);
+        unsigned long wifiStart = millis();
+        bool wifiOk = recordUpload(Metrics::Histogram::WifiUpload,
+                                   Metrics::Counter::WifiUploadOk,
+                                   Metrics::Counter::WifiUploadFailed,
+                                   wifiStart,
+                                   WifiUploader::upload(fixes[0]));
+        if (wifiOk) {
+            LinkHealth::recordSuccess(LinkHealth::Link::Wifi, millis() - wifiStart);
+        } else {
+            LinkHealth::recordFailure(LinkHealth::Link::Wifi);
+        }
+        size_t hedgeDelivered = 0;
+        bool hedgeLaunched = settleHedge(hedge, wifiOk, hedgeDelivered);
+        if (wifiOk) {
+            return delivered(1);
+        }
+        if (hedgeLaunched) {
+            return hedgeDelivered > 0 ? delivered(hedgeDelivered) : 0;
+        }
+        LOG_W(Upload, "WiFi upload failed, trying cellular fallback");
+    }
+    if (!LinkHealth::available(LinkHealth::Link::Cellular)) {
+        return 0;
+    }
+    CellularBatch batch{fixes, cellularCount, 0, false};
+    size_t deliveredCount = runCellularUpload(batch, false);
+    if (batch.encodeFailed) {
+        // Only a malformed record can fail to encode on its own; count it as consumed so it
+        // cannot wedge the backlog in front of every later fix.
+        LOG_W(Upload, "Discarding fix that cannot be encoded for upload");
+        return 1;
+    }
+    return deliveredCount > 0 ? delivered(deliveredCount) : 0;
+}
+
+size_t deferredIndex(size_t offset) {
+    return (deferredStart + offset) % AppConfig::UPLOAD_DEFER_RAM_CAPACITY;
 }
 
-void geoSensorRecordUploadFailure() {
-    if (geoSensorBackoffStage < 0) {
-        geoSensorBackoffStage = 0;
-    } else if (geoSensorBackoffStage < static_cast<int>(AppConfig::GEO_SENSOR_BACKOFF_STAGE_COUNT) - 1) {
-        ++geoSensorBackoffStage;
+void dropDeferredUnsafe(size_t count) {
+    for (size_t i = 0; i < count && deferredCount > 0; ++i) {
+        deferredFixes[deferredStart] = GpsFix();
+        deferredStart = deferredIndex(1);
+        --deferredCount;
     }
-    unsigned long delayMs = AppConfig::GEO_SENSOR_BACKOFF_DELAYS_MS[geoSensorBackoffStage];
-    geoSensorNextRetryAt = millis() + delayMs;
-    Serial.printf("geoSensor upload failed, will retry after %lu ms\n", delayMs);
 }
 
-void geoSensorRecordUploadSuccess() {
-    geoSensorBackoffStage = -1;
-    geoSensorNextRetryAt = 0;
+void persistDeferredUnsafe() {
+    while (deferredCount > 0) {
+        GeoBuffer::enqueue(deferredFixes[deferredStart]);
+        dropDeferredUnsafe(1);
+    }
+}
+
+void persistDeferred() {
+    BacklogLock lock;
+    persistDeferredUnsafe();
+}
+
+void persistDeferredOnShutdown() {
+    BacklogLock lock(pdMS_TO_TICKS(2000));
+    if (lock.held) {
+        persistDeferredUnsafe();
+    }
+}
+
+size_t peekDeferred(GpsFix* fixes, size_t maxCount) {
+    BacklogLock lock;
+    size_t batchCount = deferredCount < maxCount ? deferredCount : maxCount;
+    for (size_t offset = 0; offset < batchCount; ++offset) {
+        fixes[offset] = deferredFixes[deferredIndex(offset)];
+    }
+    return batchCount;
+}
+
+bool geoSensorUploadReady() {
+    bool wifiReady = WiFi.status() == WL_CONNECTED && LinkHealth::available(LinkHealth::Link::Wifi);
+    return wifiReady || LinkHealth::available(LinkHealth::Link::Cellular);
 }
 
 }  // namespace
@@ -51,63 +321,99 @@ namespace GeoUploader {
 
 void init() {
     GeoBuffer::init();
-    geoSensorBackoffStage = -1;
-    geoSensorNextRetryAt = 0;
-    lastGeoSensorPush = 0;
+    if (backlogMutex == nullptr) {
+        backlogMutex = xSemaphoreCreateMutex();
+        esp_register_shutdown_handler(persistDeferredOnShutdown);
+    }
+    if (hedgeTimer == nullptr) {
+        hedgeTimer = xTimerCreate("hedge", pdMS_TO_TICKS(AppConfig::HEDGE_DEFAULT_DELAY_MS), pdFALSE, nullptr,
+                                  hedgeTimerFired);
+    }
 }
 
+// Sends the NVS backlog, then the deferred fixes. A slot that cannot deliver moves whatever
+// is still deferred to NVS, so it survives a reset until the next slot.
 void flushBuffer() {
     if (!geoSensorUploadReady()) {
+        persistDeferred();
         return;
     }
-    while (!GeoBuffer::empty()) {
-        GpsFix next;
-        if (!GeoBuffer::peek(next)) {
-            break;
+    GpsFix pending[CELLULAR_BATCH_CAPACITY];
+    while (true) {
+        size_t pendingCount = 0;
+        {
+            BacklogLock lock;
+            pendingCount = GeoBuffer::peekBatch(pending, cellularBatchLimit());
         }
-        if (!uploadGeoSensor(next)) {
-            Serial.println("Buffered geoSensor upload failed, will retry later");
-            geoSensorRecordUploadFailure();
+        if (pendingCount == 0) {
             break;
         }
-        geoSensorRecordUploadSuccess();
-        GeoBuffer::dropOldest();
-        Serial.printf("Buffered geoSensor upload success, remaining=%u\n",
+        size_t deliveredCount = uploadGeoSensor(pending, pendingCount);
+        if (deliveredCount == 0) {
+            LOG_W(Upload, "Buffered geoSensor upload failed, will retry later");
+            persistDeferred();
+            return;
+        }
+        BacklogLock lock;
+        for (size_t i = 0; i < deliveredCount; ++i) {
+            GeoBuffer::dropOldest();
+        }
+        LOG_DEFERRED(Info, Upload, "Buffered geoSensor upload success, remaining=%u",
                       static_cast<unsigned>(GeoBuffer::count()));
     }
+    while (true) {
+        size_t pendingCount = peekDeferred(pending, cellularBatchLimit());
+        if (pendingCount == 0) {
+            break;
+        }
+        size_t deliveredCount = uploadGeoSensor(pending, pendingCount);
+        if (deliveredCount == 0) {
+            LOG_W(Upload, "Deferred geoSensor upload failed, persisting to backlog");
+            persistDeferred();
+            return;
+        }
+        BacklogLock lock;
+        dropDeferredUnsafe(deliveredCount);
+    }
 }
 
-void handleUpdate() {
-    unsigned long now = millis();
-    if (lastGeoSensorPush != 0 && now - lastGeoSensorPush < AppConfig::GEO_SENSOR_UPLOAD_INTERVAL_MS) {
-        return;
-    }
-    lastGeoSensorPush = now;
-    Serial.println("handleGeoSensorUpdate triggered");
-    GpsFix fix;
-    if (!GpsService::fetchFix(fix)) {
-        Serial.println("Failed to acquire GPS fix");
-        return;
-    }
+void submitFix(const GpsFix& fix) {
     if (!geoSensorUploadReady()) {
-        Serial.println("geoSensor upload postponed by backoff, buffering");
+        LOG_W(Upload, "All upload links backing off, buffering");
+        BacklogLock lock;
+        persistDeferredUnsafe();
         GeoBuffer::enqueue(fix);
         return;
     }
-    if (!GeoBuffer::empty()) {
-        GeoBuffer::enqueue(fix);
+    if (backlogPending()) {
+        deferFix(fix);
         flushBuffer();
         return;
     }
-    if (!uploadGeoSensor(fix)) {
-        Serial.println("Immediate geoSensor upload failed, buffering");
-        geoSensorRecordUploadFailure();
+    if (uploadGeoSensor(&fix, 1) == 0) {
+        LOG_W(Upload, "Immediate geoSensor upload failed, buffering");
+        BacklogLock lock;
         GeoBuffer::enqueue(fix);
     } else {
-        geoSensorRecordUploadSuccess();
-        Serial.println("geoSensor upload success");
+        LOG_I(Upload, "geoSensor upload success");
     }
 }
 
-}  // namespace GeoUploader
+// Holds a fix in RAM for the next upload slot instead of sending it now; only an overflow
+// writes the oldest deferred fix to NVS.
+void deferFix(const GpsFix& fix) {
+    BacklogLock lock;
+    if (deferredCount == AppConfig::UPLOAD_DEFER_RAM_CAPACITY) {
+        GeoBuffer::enqueue(deferredFixes[deferredStart]);
+        dropDeferredUnsafe(1);
+    }
+    deferredFixes[deferredIndex(deferredCount)] = fix;
+    ++deferredCount;
+}
 
+bool backlogPending() {
+    BacklogLock lock;
+    return !GeoBuffer::empty() || deferredCount > 0;
+}
+
+}  // namespace GeoUploader
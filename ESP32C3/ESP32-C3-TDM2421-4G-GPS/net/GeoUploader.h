@@ -1,10 +1,14 @@
 #pragma once
 
+#include "../gps/GpsTypes.h"
+
 namespace GeoUploader {
 
 void init();
 void flushBuffer();
-void handleUpdate();
+void submitFix(const GpsFix& fix);
+void deferFix(const GpsFix& fix);
+bool backlogPending();
 
 }  // namespace GeoUploader
 
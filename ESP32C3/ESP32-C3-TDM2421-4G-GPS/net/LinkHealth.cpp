@@ -0,0 +1,129 @@
+#include "LinkHealth.h"
+
+#include <freertos/FreeRTOS.h>
+
+#include "../config/AppConfig.h"
+#include "../logging/Log.h"
+#include "../metrics/Metrics.h"
+
+namespace {
+
+constexpr size_t LINK_COUNT = static_cast<size_t>(LinkHealth::Link::Count);
+constexpr const char* LINK_NAMES[LINK_COUNT] = {"wifi", "4g"};
+
+struct LinkState {
+    uint8_t consecutiveFailures;
+    uint32_t backoffMs;
+    unsigned long retryAt;
+    uint32_t latencyMs[AppConfig::HEDGE_LATENCY_WINDOW];
+    uint8_t latencyCount;
+    uint8_t latencyNext;
+};
+
+LinkState linkStates[LINK_COUNT] = {};
+portMUX_TYPE linkHealthLock = portMUX_INITIALIZER_UNLOCKED;
+
+LinkState& linkState(LinkHealth::Link link) {
+    return linkStates[static_cast<size_t>(link)];
+}
+
+// "Exponential backoff and jitter", decorrelated variant: next = min(cap, rand(base, prev * 3)).
+uint32_t nextDecorrelatedBackoff(uint32_t previousMs) {
+    uint32_t base = AppConfig::BREAKER_BACKOFF_BASE_MS;
+    uint64_t upper = previousMs < base ? base : static_cast<uint64_t>(previousMs) * 3;
+    uint32_t span = static_cast<uint32_t>(upper - base);
+    uint32_t next = base + (span > 0 ? esp_random() % (span + 1) : 0);
+    return next > AppConfig::BREAKER_BACKOFF_CAP_MS ? AppConfig::BREAKER_BACKOFF_CAP_MS : next;
+}
+
+LinkHealth::State stateLocked(const LinkState& entry, unsigned long now) {
+    if (entry.consecutiveFailures < AppConfig::BREAKER_FAILURE_THRESHOLD) {
+        return LinkHealth::State::Closed;
+    }
+    return static_cast<long>(now - entry.retryAt) >= 0 ? LinkHealth::State::HalfOpen : LinkHealth::State::Open;
+}
+
+}  // namespace
+
+namespace LinkHealth {
+
+bool available(Link link) {
+    portENTER_CRITICAL(&linkHealthLock);
+    const LinkState& entry = linkState(link);
+    bool ready = entry.consecutiveFailures == 0 || static_cast<long>(millis() - entry.retryAt) >= 0;
+    portEXIT_CRITICAL(&linkHealthLock);
+    return ready;
+}
+
+State state(Link link) {
+    portENTER_CRITICAL(&linkHealthLock);
+    State current = stateLocked(linkState(link), millis());
+    portEXIT_CRITICAL(&linkHealthLock);
+    return current;
+}
+
+void recordSuccess(Link link, uint32_t latencyMs) {
+    portENTER_CRITICAL(&linkHealthLock);
+    LinkState& entry = linkState(link);
+    bool recovered = entry.consecutiveFailures >= AppConfig::BREAKER_FAILURE_THRESHOLD;
+    entry.consecutiveFailures = 0;
+    entry.backoffMs = 0;
+    entry.retryAt = 0;
+    entry.latencyMs[entry.latencyNext] = latencyMs;
+    entry.latencyNext = (entry.latencyNext + 1) % AppConfig::HEDGE_LATENCY_WINDOW;
+    if (entry.latencyCount < AppConfig::HEDGE_LATENCY_WINDOW) {
+        ++entry.latencyCount;
+    }
+    portEXIT_CRITICAL(&linkHealthLock);
+    if (recovered) {
+        LOG_I(Upload, "%s link recovered, breaker closed", LINK_NAMES[static_cast<size_t>(link)]);
+    }
+}
+
+void recordFailure(Link link) {
+    portENTER_CRITICAL(&linkHealthLock);
+    LinkState& entry = linkState(link);
+    if (entry.consecutiveFailures < 0xFF) {
+        ++entry.consecutiveFailures;
+    }
+    entry.backoffMs = nextDecorrelatedBackoff(entry.backoffMs);
+    unsigned long now = millis();
+    entry.retryAt = now + entry.backoffMs;
+    bool opened = entry.consecutiveFailures == AppConfig::BREAKER_FAILURE_THRESHOLD;
+    uint32_t backoffMs = entry.backoffMs;
+    State current = stateLocked(entry, now);
+    portEXIT_CRITICAL(&linkHealthLock);
+    if (opened) {
+        Metrics::increment(link == Link::Wifi ? Metrics::Counter::WifiBreakerOpened
+                                              : Metrics::Counter::CellularBreakerOpened);
+    }
+    LOG_W(Upload, "%s upload failed, next attempt in %lu ms%s", LINK_NAMES[static_cast<size_t>(link)],
+          static_cast<unsigned long>(backoffMs), current == State::Closed ? "" : " (breaker open)");
+}
+
+uint32_t hedgeDelayMs(Link link) {
+    uint32_t samples[AppConfig::HEDGE_LATENCY_WINDOW];
+    portENTER_CRITICAL(&linkHealthLock);
+    const LinkState& entry = linkState(link);
+    uint8_t count = entry.latencyCount;
+    memcpy(samples, entry.latencyMs, sizeof(samples));
+    portEXIT_CRITICAL(&linkHealthLock);
+    if (count < AppConfig::HEDGE_MIN_SAMPLES) {
+        return AppConfig::HEDGE_DEFAULT_DELAY_MS;
+    }
+    // Window is tiny, insertion sort is fine.
+    for (uint8_t i = 1; i < count; ++i) {
+        uint32_t value = samples[i];
+        int j = i - 1;
+        while (j >= 0 && samples[j] > value) {
+            samples[j + 1] = samples[j];
+            --j;
+        }
+        samples[j + 1] = value;
+    }
+    size_t rank = (static_cast<size_t>(count) * AppConfig::HEDGE_PERCENTILE + 99) / 100;
+    uint32_t percentile = samples[rank > 0 ? rank - 1 : 0];
+    return percentile < AppConfig::HEDGE_MIN_DELAY_MS ? AppConfig::HEDGE_MIN_DELAY_MS : percentile;
+}
+
+}  // namespace LinkHealth
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Per-transport circuit breaker. Each failure pushes the next attempt out by a
+// decorrelated-jitter delay; BREAKER_FAILURE_THRESHOLD failures in a row open the
+// breaker, and the first attempt after the delay is a half-open probe.
+namespace LinkHealth {
+
+enum class Link : uint8_t {
+    Wifi,
+    Cellular,
+    Count,
+};
+
+enum class State : uint8_t {
+    Closed,
+    Open,
+    HalfOpen,
+};
+
+bool available(Link link);
+State state(Link link);
+void recordSuccess(Link link, uint32_t latencyMs);
+void recordFailure(Link link);
+
+// Delay after which a second link is started alongside this one.
+uint32_t hedgeDelayMs(Link link);
+
+}  // namespace LinkHealth
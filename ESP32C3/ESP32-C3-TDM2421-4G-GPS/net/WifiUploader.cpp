@@ -5,6 +5,7 @@
 #include <WiFiClientSecure.h>
 
 #include "../config/AppConfig.h"
+#include "../logging/Log.h"
 #include "GeoPayload.h"
 
 namespace {
@@ -17,7 +18,7 @@ namespace WifiUploader {
 
 bool upload(const GpsFix& fix) {
     if (WiFi.status() != WL_CONNECTED) {
-        Serial.println("WiFi disconnected, abort geoSensor upload");
+        LOG_W(Upload, "WiFi disconnected, abort geoSensor upload");
         return false;
     }
 
@@ -43,21 +44,20 @@ bool upload(const GpsFix& fix) {
     }
 
     if (!beginResult) {
-        Serial.println("Failed to begin geoSensor request");
+        LOG_W(Upload, "Failed to begin geoSensor request");
         return false;
     }
 
-    Serial.print("geoSensor payload: ");
-    Serial.println(payload);
+    LOG_D(Upload, "geoSensor payload: %s", payload.c_str());
     http.addHeader("Content-Type", "application/json");
     http.addHeader("X-API-Key", AppConfig::GEO_SENSOR_KEY);
     http.addHeader("Connection", "close");
 
     int httpCode = http.PATCH(payload);
     String httpError = http.errorToString(httpCode);
-    Serial.printf("geoSensor PATCH -> code: %d (%s)\n", httpCode, httpError.c_str());
+    LOG_I(Upload, "geoSensor PATCH -> code: %d (%s)", httpCode, httpError.c_str());
     if (httpCode > 0) {
-        Serial.println(http.getString());
+        LOG_V(Upload, "geoSensor response: %s", http.getString().c_str());
     }
     http.end();
     return httpCode >= 200 && httpCode < 300;
@@ -0,0 +1,347 @@
+#include "PowerManager.h"
+
+#include <WiFi.h>
+#include <driver/uart.h>
+#include <esp_attr.h>
+#include <esp_sleep.h>
+#include <esp_system.h>
+#include <freertos/task.h>
+
+#include "../config/AppConfig.h"
+#include "../logging/Log.h"
+#include "../metrics/Metrics.h"
+#include "../modem/ModemCommands.h"
+#include "../modem/ModemTask.h"
+
+namespace {
+
+constexpr uint32_t RETAINED_POWER_MAGIC = 0x50574231;  // "PWB1"
+constexpr uint32_t PIPELINE_IDLE_POLL_MS = 50;
+
+// Lives in RTC memory and is not zeroed on reset, so the energy totals survive watchdog
+// and software resets; only a power-on reset (or a corrupted block) starts them over.
+struct RetainedPowerState {
+    uint32_t magic;
+    uint64_t awakeMs;
+    uint64_t sleepMs;
+    uint64_t modemActiveMs;
+    uint64_t gnssOnMs;
+    uint32_t deliveredFixes;
+    uint32_t sleepCycles;
+    uint32_t checksum;
+};
+
+RTC_NOINIT_ATTR RetainedPowerState retainedPower;
+
+portMUX_TYPE powerLock = portMUX_INITIALIZER_UNLOCKED;
+unsigned long awakeSince = 0;
+unsigned long gnssOnSince = 0;
+bool gnssPowered = false;
+volatile int pendingWork = 0;
+volatile bool wifiParkRequest = false;
+volatile bool wifiParked = false;
+unsigned long nextSampleAt = 0;
+
+uint32_t retainedChecksum(const RetainedPowerState& state) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&state);
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < offsetof(RetainedPowerState, checksum); ++i) {
+        hash = (hash ^ bytes[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+void sealRetainedState() {
+    retainedPower.checksum = retainedChecksum(retainedPower);
+}
+
+// Rolls elapsed awake/GNSS time into the retained totals. Caller holds powerLock.
+void foldElapsedLocked(unsigned long now) {
+    retainedPower.awakeMs += now - awakeSince;
+    awakeSince = now;
+    if (gnssPowered) {
+        retainedPower.gnssOnMs += now - gnssOnSince;
+        gnssOnSince = now;
+    }
+    sealRetainedState();
+}
+
+bool modemDtrWired() {
+    return AppConfig::MCU_SIM_DTR_PIN >= 0;
+}
+
+// Energy estimate from time-in-state and the nominal currents in AppConfig, in uAh.
+// Without DTR the modem never gets AT+QSCLK=1, so it sits at idle current while the MCU sleeps.
+uint64_t estimatedEnergyUah(const RetainedPowerState& state) {
+    uint64_t modemActiveMs = state.modemActiveMs < state.awakeMs ? state.modemActiveMs : state.awakeMs;
+    uint64_t modemSleepUa = modemDtrWired() ? AppConfig::POWER_MODEM_SLEEP_UA : AppConfig::POWER_MODEM_IDLE_UA;
+    uint64_t microAmpMs = state.awakeMs * AppConfig::POWER_MCU_ACTIVE_UA +
+                          state.sleepMs * AppConfig::POWER_MCU_SLEEP_UA +
+                          modemActiveMs * AppConfig::POWER_MODEM_ACTIVE_UA +
+                          (state.awakeMs - modemActiveMs) * AppConfig::POWER_MODEM_IDLE_UA +
+                          state.sleepMs * modemSleepUa +
+                          state.gnssOnMs * AppConfig::POWER_GNSS_ACTIVE_UA;
+    return microAmpMs / 3600000ULL;
+}
+
+void publishPowerGauges() {
+    portENTER_CRITICAL(&powerLock);
+    foldElapsedLocked(millis());
+    RetainedPowerState snapshot = retainedPower;
+    portEXIT_CRITICAL(&powerLock);
+    uint64_t energyUah = estimatedEnergyUah(snapshot);
+    Metrics::setGauge(Metrics::Gauge::AwakeSeconds, static_cast<uint32_t>(snapshot.awakeMs / 1000));
+    Metrics::setGauge(Metrics::Gauge::SleepSeconds, static_cast<uint32_t>(snapshot.sleepMs / 1000));
+    Metrics::setGauge(Metrics::Gauge::FixesDelivered, snapshot.deliveredFixes);
+    Metrics::setGauge(Metrics::Gauge::EnergyMicroAmpHours, static_cast<uint32_t>(energyUah));
+    Metrics::setGauge(Metrics::Gauge::EnergyPerFixMicroAmpHours,
+                      snapshot.deliveredFixes > 0 ? static_cast<uint32_t>(energyUah / snapshot.deliveredFixes) : 0);
+}
+
+bool configureModemJob(void*) {
+    String response;
+    if (modemDtrWired()) {
+        // DTR low keeps the modem awake; high lets it enter sleep once AT+QSCLK=1 is set.
+        sim_at_cmd_with_response("AT+QSCLK=1", response);
+    }
+    if (AppConfig::POWER_MODEM_EDRX_ENABLED) {
+        sim_at_cmd_with_response("AT+CEDRXS=1,4,\"" + String(AppConfig::POWER_MODEM_EDRX_CYCLE) + "\"", response);
+    }
+    if (AppConfig::POWER_MODEM_PSM_ENABLED) {
+        sim_at_cmd_with_response("AT+CPSMS=1,,,\"" + String(AppConfig::POWER_MODEM_PSM_TAU) + "\",\"" +
+                                     String(AppConfig::POWER_MODEM_PSM_ACTIVE_TIME) + "\"",
+                                 response);
+    } else {
+        sim_at_cmd_with_response("AT+CPSMS=0", response);
+    }
+    return true;
+}
+
+// Runs on the modem task so the DTR edge never lands in the middle of an AT exchange.
+bool modemSleepJob(void*) {
+    if (modemDtrWired()) {
+        digitalWrite(AppConfig::MCU_SIM_DTR_PIN, HIGH);
+    }
+    AppConfig::modemSerial().flush();
+    return true;
+}
+
+bool modemWakeJob(void*) {
+    if (!modemDtrWired()) {
+        return true;
+    }
+    digitalWrite(AppConfig::MCU_SIM_DTR_PIN, LOW);
+    delay(AppConfig::POWER_MODEM_WAKE_GUARD_MS);
+    String response;
+    for (uint8_t attempt = 0; attempt < 3; ++attempt) {
+        if (sim_at_cmd_with_response("AT", response, 1000)) {
+            return true;
+        }
+    }
+    LOG_W(Power, "Modem did not answer after DTR wake");
+    return false;
+}
+
+void waitForPipelineIdle(unsigned long deadline) {
+    while (pendingWork > 0 && static_cast<long>(deadline - millis()) > 0) {
+        vTaskDelay(pdMS_TO_TICKS(PIPELINE_IDLE_POLL_MS));
+    }
+}
+
+bool sleepAllowed() {
+    if (millis() < AppConfig::POWER_BOOT_AWAKE_MS) {
+        return false;  // keep the portal reachable right after boot
+    }
+    if (pendingWork > 0) {
+        return false;
+    }
+    wifi_mode_t mode = WiFi.getMode();
+    bool apActive = mode == WIFI_AP || mode == WIFI_AP_STA;
+    return !apActive || WiFi.softAPgetStationNum() == 0;
+}
+
+bool parkWifi() {
+    wifiParked = false;
+    wifiParkRequest = true;
+    unsigned long start = millis();
+    while (!wifiParked && millis() - start < AppConfig::POWER_WIFI_PARK_TIMEOUT_MS) {
+        vTaskDelay(pdMS_TO_TICKS(AppConfig::CONNECTIVITY_TASK_POLL_MS));
+    }
+    if (!wifiParked) {
+        wifiParkRequest = false;  // connectivity task is busy connecting; try again next round
+    }
+    return wifiParked;
+}
+
+void releaseWifi() {
+    wifiParkRequest = false;
+    wifiParked = false;
+}
+
+// One light-sleep period; returns true when the modem UART woke us early.
+bool lightSleepFor(uint32_t sleepMs) {
+    ModemTask::run(modemSleepJob, nullptr, ModemTask::Lane::Urgent);
+    portENTER_CRITICAL(&powerLock);
+    foldElapsedLocked(millis());
+    portEXIT_CRITICAL(&powerLock);
+
+    // UART0 is the modem link: a few RX edges (a URC) wake the chip. The first bytes of
+    // that URC are lost, so anything awaited over the UART must tolerate a partial line.
+    uart_set_wakeup_threshold(UART_NUM_0, AppConfig::POWER_UART_WAKE_THRESHOLD);
+    esp_sleep_enable_uart_wakeup(UART_NUM_0);
+    esp_sleep_enable_timer_wakeup(static_cast<uint64_t>(sleepMs) * 1000ULL);
+    unsigned long sleptFrom = millis();
+    esp_light_sleep_start();
+    unsigned long wokeAt = millis();
+    bool uartWake = esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_UART;
+
+    portENTER_CRITICAL(&powerLock);
+    retainedPower.sleepMs += wokeAt - sleptFrom;
+    ++retainedPower.sleepCycles;
+    awakeSince = wokeAt;
+    if (gnssPowered) {
+        gnssOnSince = wokeAt;
+    }
+    sealRetainedState();
+    portEXIT_CRITICAL(&powerLock);
+
+    Metrics::increment(Metrics::Counter::LightSleepCycles);
+    if (uartWake) {
+        Metrics::increment(Metrics::Counter::UartWakeups);
+    }
+    ModemTask::run(modemWakeJob, nullptr, ModemTask::Lane::Urgent);
+    return uartWake;
+}
+
+void dutyCycleUntil(unsigned long deadline) {
+    unsigned long burstDeadline = millis() + AppConfig::POWER_BURST_MAX_MS;
+    waitForPipelineIdle(static_cast<long>(deadline - burstDeadline) < 0 ? deadline : burstDeadline);
+    publishPowerGauges();
+    bool wifiIsParked = false;
+    for (;;) {
+        long remaining = static_cast<long>(deadline - millis());
+        if (remaining < static_cast<long>(AppConfig::POWER_MIN_SLEEP_MS)) {
+            break;
+        }
+        if (!sleepAllowed() || (!wifiIsParked && !(wifiIsParked = parkWifi()))) {
+            long recheckMs = static_cast<long>(AppConfig::POWER_AWAKE_RECHECK_MS);
+            vTaskDelay(pdMS_TO_TICKS(remaining < recheckMs ? remaining : recheckMs));
+            continue;
+        }
+        LOG_DEFERRED(Debug, Power, "Light sleep for %ld ms", remaining);
+        if (lightSleepFor(static_cast<uint32_t>(remaining))) {
+            // Give the modem task time to read whatever the modem had to say.
+            LOG_D(Power, "Woken by modem UART");
+            vTaskDelay(pdMS_TO_TICKS(AppConfig::POWER_UART_WAKE_AWAKE_MS));
+        }
+    }
+    releaseWifi();
+    long remaining = static_cast<long>(deadline - millis());
+    if (remaining > 0) {
+        vTaskDelay(pdMS_TO_TICKS(remaining));
+    }
+    publishPowerGauges();
+}
+
+}  // namespace
+
+namespace PowerManager {
+
+void begin() {
+    bool keep = esp_reset_reason() != ESP_RST_POWERON && retainedPower.magic == RETAINED_POWER_MAGIC &&
+                retainedPower.checksum == retainedChecksum(retainedPower);
+    if (!keep) {
+        memset(&retainedPower, 0, sizeof(retainedPower));
+        retainedPower.magic = RETAINED_POWER_MAGIC;
+        sealRetainedState();
+    }
+    awakeSince = millis();
+    if (modemDtrWired()) {
+        pinMode(AppConfig::MCU_SIM_DTR_PIN, OUTPUT);
+        digitalWrite(AppConfig::MCU_SIM_DTR_PIN, LOW);
+    }
+    LOG_I(Power, "Power save %s, retained totals %s (%lu fixes)",
+          enabled() ? "enabled" : "disabled",
+          keep ? "restored" : "reset",
+          static_cast<unsigned long>(retainedPower.deliveredFixes));
+}
+
+bool enabled() {
+    return AppConfig::POWER_SAVE_ENABLED;
+}
+
+void configureModem() {
+    if (enabled()) {
+        ModemTask::run(configureModemJob, nullptr, ModemTask::Lane::Urgent);
+    }
+}
+
+void beginWork() {
+    portENTER_CRITICAL(&powerLock);
+    ++pendingWork;
+    portEXIT_CRITICAL(&powerLock);
+}
+
+void endWork() {
+    portENTER_CRITICAL(&powerLock);
+    if (pendingWork > 0) {
+        --pendingWork;
+    }
+    portEXIT_CRITICAL(&powerLock);
+}
+
+bool wifiParkRequested() {
+    return wifiParkRequest;
+}
+
+void acknowledgeWifiParked() {
+    wifiParked = true;
+}
+
+void waitForNextSample(TickType_t& lastWake, uint32_t intervalMs) {
+    if (!enabled()) {
+        publishPowerGauges();
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(intervalMs));
+        return;
+    }
+    // The tick count is not a reliable clock across manual light sleep; millis() is.
+    unsigned long now = millis();
+    nextSampleAt = nextSampleAt == 0 ? now + intervalMs : nextSampleAt + intervalMs;
+    if (static_cast<long>(nextSampleAt - now) < 0) {
+        nextSampleAt = now;
+    }
+    dutyCycleUntil(nextSampleAt);
+    lastWake = xTaskGetTickCount();
+}
+
+void addModemActiveMs(uint32_t elapsedMs) {
+    portENTER_CRITICAL(&powerLock);
+    retainedPower.modemActiveMs += elapsedMs;
+    sealRetainedState();
+    portEXIT_CRITICAL(&powerLock);
+}
+
+void noteGnssPowered(bool powered) {
+    portENTER_CRITICAL(&powerLock);
+    unsigned long now = millis();
+    if (gnssPowered && !powered) {
+        retainedPower.gnssOnMs += now - gnssOnSince;
+        sealRetainedState();
+    } else if (!gnssPowered && powered) {
+        gnssOnSince = now;
+    }
+    gnssPowered = powered;
+    portEXIT_CRITICAL(&powerLock);
+}
+
+void recordDelivered(size_t fixes) {
+    if (fixes == 0) {
+        return;
+    }
+    portENTER_CRITICAL(&powerLock);
+    retainedPower.deliveredFixes += fixes;
+    sealRetainedState();
+    portEXIT_CRITICAL(&powerLock);
+}
+
+}  // namespace PowerManager
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+
+namespace PowerManager {
+
+void begin();
+bool enabled();
+
+// Called once from the GNSS task before sampling starts (PSM/eDRX/QSCLK setup).
+void configureModem();
+
+// Pipeline bookkeeping: a fix is "in flight" from publish until the uploader is done with it.
+void beginWork();
+void endWork();
+
+// Wi-Fi is parked by the connectivity task itself before the chip sleeps.
+bool wifiParkRequested();
+void acknowledgeWifiParked();
+
+// Replaces vTaskDelayUntil in the GNSS task; light-sleeps between bursts when enabled.
+void waitForNextSample(TickType_t& lastWake, uint32_t intervalMs);
+
+// Duty-cycle accounting inputs.
+void addModemActiveMs(uint32_t elapsedMs);
+void noteGnssPowered(bool powered);
+void recordDelivered(size_t fixes);
+
+}  // namespace PowerManager
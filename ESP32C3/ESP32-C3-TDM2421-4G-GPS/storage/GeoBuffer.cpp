@@ -1,6 +1,8 @@
 #include "GeoBuffer.h"
 
 #include "../config/AppConfig.h"
+#include "../logging/Log.h"
+#include "../metrics/Metrics.h"
 #include "../utils/StringUtils.h"
 
 namespace {
@@ -33,13 +35,25 @@ String serializeGpsFix(const GpsFix& fix) {
     data += fix.dataAcquiredAt;
     data += ",";
     data += String(static_cast<unsigned>(fix.satelliteCount));
+    data += ",";
+    data += String(static_cast<unsigned>(fix.source));
+    data += ",";
+    data += String(fix.accuracyMeters, 0);
     return data;
 }
 
 bool deserializeGpsFix(const String& data, GpsFix& fix) {
-    const size_t CURRENT_FIELD_COUNT = 6;
+    const size_t CURRENT_FIELD_COUNT = 8;
+    const size_t PRE_SOURCE_FIELD_COUNT = 6;
     String fields[CURRENT_FIELD_COUNT];
+    fix.source = PositionSource::Gnss;
+    fix.accuracyMeters = 0.0f;
     if (StringUtils::splitCsvFields(data, fields, CURRENT_FIELD_COUNT)) {
+        fix.source = fields[6].toInt() == static_cast<int>(PositionSource::Cell) ? PositionSource::Cell
+                                                                                : PositionSource::Gnss;
+        fix.accuracyMeters = fields[7].toFloat();
+    }
+    if (StringUtils::splitCsvFields(data, fields, PRE_SOURCE_FIELD_COUNT)) {
         fix.latitude = fields[0].toFloat();
         fix.longitude = fields[1].toFloat();
         fix.altitude = fields[2].toFloat();
@@ -67,25 +81,32 @@ size_t geoSensorBufferIndex(size_t offset) {
 }
 
 void persistGeoSensorMetadata() {
+    Metrics::setGauge(Metrics::Gauge::BacklogDepth, static_cast<uint32_t>(geoSensorBufferCount));
     if (!geoPrefsReady) {
         return;
     }
+    unsigned long start = millis();
     geoPrefs.putUShort(GEO_BUFFER_PREF_START_KEY, static_cast<uint16_t>(geoSensorBufferStart));
     geoPrefs.putUShort(GEO_BUFFER_PREF_COUNT_KEY, static_cast<uint16_t>(geoSensorBufferCount));
+    Metrics::observe(Metrics::Histogram::NvsWrite, millis() - start);
 }
 
 void persistGeoSensorSlot(size_t index) {
     if (!geoPrefsReady) {
         return;
     }
+    unsigned long start = millis();
     geoPrefs.putString(geoBufferSlotKey(index).c_str(), serializeGpsFix(geoSensorBuffer[index]));
+    Metrics::observe(Metrics::Histogram::NvsWrite, millis() - start);
 }
 
 void clearGeoSensorSlot(size_t index) {
     if (!geoPrefsReady) {
         return;
     }
+    unsigned long start = millis();
     geoPrefs.remove(geoBufferSlotKey(index).c_str());
+    Metrics::observe(Metrics::Histogram::NvsWrite, millis() - start);
 }
 
 void geoSensorBufferDropOldestUnsafe() {
@@ -127,14 +148,14 @@ void restoreBufferFromFlash() {
         ++geoSensorBufferCount;
     }
     if (truncated) {
-        Serial.println("Detected corrupted geo buffer entries, truncating queue");
+        LOG_W(Buffer, "Detected corrupted geo buffer entries, truncating queue");
         for (size_t offset = geoSensorBufferCount; offset < storedCount; ++offset) {
             size_t index = geoSensorBufferIndex(offset);
             clearGeoSensorSlot(index);
         }
     }
     persistGeoSensorMetadata();
-    Serial.printf("Restored %u buffered fixes from flash\n", static_cast<unsigned>(geoSensorBufferCount));
+    LOG_I(Buffer, "Restored %u buffered fixes from flash", static_cast<unsigned>(geoSensorBufferCount));
 }
 
 }  // namespace
@@ -146,7 +167,7 @@ void init() {
         return;
     }
     if (!geoPrefs.begin(GEO_BUFFER_PREF_NAMESPACE, false)) {
-        Serial.println("Failed to init geo buffer prefs, using RAM-only buffer");
+        LOG_W(Buffer, "Failed to init geo buffer prefs, using RAM-only buffer");
         return;
     }
     geoPrefsReady = true;
@@ -163,6 +184,7 @@ size_t count() {
 
 void enqueue(const GpsFix& fix) {
     if (geoSensorBufferCount == AppConfig::GEO_SENSOR_BUFFER_CAPACITY) {
+        Metrics::increment(Metrics::Counter::BacklogOverflow);
         geoSensorBufferDropOldestUnsafe();
     }
     size_t insertIndex = geoSensorBufferIndex(geoSensorBufferCount);
@@ -170,7 +192,7 @@ void enqueue(const GpsFix& fix) {
     ++geoSensorBufferCount;
     persistGeoSensorSlot(insertIndex);
     persistGeoSensorMetadata();
-    Serial.printf("Buffered geoSensor fix, count=%u\n", static_cast<unsigned>(geoSensorBufferCount));
+    LOG_DEFERRED(Debug, Buffer, "Buffered geoSensor fix, count=%u", static_cast<unsigned>(geoSensorBufferCount));
 }
 
 bool peek(GpsFix& fix) {
@@ -181,6 +203,14 @@ bool peek(GpsFix& fix) {
     return true;
 }
 
+size_t peekBatch(GpsFix* fixes, size_t maxCount) {
+    size_t batchCount = geoSensorBufferCount < maxCount ? geoSensorBufferCount : maxCount;
+    for (size_t offset = 0; offset < batchCount; ++offset) {
+        fixes[offset] = geoSensorBuffer[geoSensorBufferIndex(offset)];
+    }
+    return batchCount;
+}
+
 void dropOldest() {
     geoSensorBufferDropOldestUnsafe();
 }
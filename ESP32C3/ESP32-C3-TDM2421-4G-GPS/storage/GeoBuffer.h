@@ -11,6 +11,7 @@ bool empty();
 size_t count();
 void enqueue(const GpsFix& fix);
 bool peek(GpsFix& fix);
+size_t peekBatch(GpsFix* fixes, size_t maxCount);
 void dropOldest();
 
 }  // namespace GeoBuffer
@@ -0,0 +1,184 @@
+#include "AppTasks.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+#include "../config/AppConfig.h"
+#include "../logging/Log.h"
+#include "../gps/CellLocator.h"
+#include "../gps/GpsService.h"
+#include "../gps/SamplingScheduler.h"
+#include "../metrics/Metrics.h"
+#include "../modem/ModemTask.h"
+#include "../net/GeoUploader.h"
+#include "../power/PowerManager.h"
+#include "../wifi/WifiManager.h"
+
+namespace {
+
+QueueHandle_t gnssFixQueue = nullptr;
+
+bool enableGnssJob(void*) {
+    GpsService::enable();
+    return true;
+}
+
+bool disableGnssJob(void*) {
+    GpsService::disable();
+    return true;
+}
+
+bool fetchFixJob(void* context) {
+    return GpsService::fetchFix(*static_cast<GpsFix*>(context));
+}
+
+bool cellFixJob(void* context) {
+    return CellLocator::locate(*static_cast<GpsFix*>(context));
+}
+
+// In power-save mode the GNSS engine only runs for the burst: power it, poll until a
+// (hot-start) fix arrives or the budget runs out, then switch it off again.
+bool acquireFix(GpsFix& fix) {
+    if (!PowerManager::enabled()) {
+        return ModemTask::run(fetchFixJob, &fix, ModemTask::Lane::Urgent);
+    }
+    ModemTask::run(enableGnssJob, nullptr, ModemTask::Lane::Urgent);
+    PowerManager::noteGnssPowered(true);
+    unsigned long start = millis();
+    bool fixOk = ModemTask::run(fetchFixJob, &fix, ModemTask::Lane::Urgent);
+    while (!fixOk && millis() - start < AppConfig::POWER_GNSS_FIX_TIMEOUT_MS) {
+        vTaskDelay(pdMS_TO_TICKS(AppConfig::POWER_GNSS_POLL_MS));
+        fixOk = ModemTask::run(fetchFixJob, &fix, ModemTask::Lane::Urgent);
+    }
+    ModemTask::run(disableGnssJob, nullptr, ModemTask::Lane::Urgent);
+    PowerManager::noteGnssPowered(false);
+    return fixOk;
+}
+
+// A full queue means the uploader is stalled; drop the oldest fix so sampling never blocks.
+void publishFix(const GpsFix& fix) {
+    GpsFix* item = new GpsFix(fix);
+    PowerManager::beginWork();
+    if (xQueueSend(gnssFixQueue, &item, 0) == pdTRUE) {
+        return;
+    }
+    GpsFix* stale = nullptr;
+    if (xQueueReceive(gnssFixQueue, &stale, 0) == pdTRUE) {
+        delete stale;
+        PowerManager::endWork();
+        Metrics::increment(Metrics::Counter::FixQueueDropped);
+        LOG_W(Tasks, "GNSS fix queue full, dropped oldest pending fix");
+    }
+    if (xQueueSend(gnssFixQueue, &item, 0) != pdTRUE) {
+        delete item;
+        PowerManager::endWork();
+    }
+}
+
+void gnssTaskMain(void*) {
+    PowerManager::configureModem();
+    ModemTask::run(enableGnssJob, nullptr, ModemTask::Lane::Urgent);
+    PowerManager::noteGnssPowered(true);
+    vTaskDelay(pdMS_TO_TICKS(AppConfig::GPS_WARMUP_MS));
+    TickType_t lastWake = xTaskGetTickCount();
+    for (;;) {
+        LOG_I(Gnss, "GNSS sample triggered");
+        unsigned long iterationStart = millis();
+        GpsFix fix;
+        bool fixOk = acquireFix(fix);
+        Metrics::observe(Metrics::Histogram::GpsFix, millis() - iterationStart);
+        Metrics::increment(fixOk ? Metrics::Counter::GpsFixOk : Metrics::Counter::GpsFixFailed);
+        uint32_t nextSampleMs;
+        if (fixOk) {
+            nextSampleMs = SamplingScheduler::onFix(fix);
+            publishFix(fix);
+        } else {
+            LOG_W(Gnss, "Failed to acquire GPS fix");
+            nextSampleMs = SamplingScheduler::onFixFailed();
+            // A coarse position beats a gap in the track; it does not steer the sampling interval.
+            if (AppConfig::CELL_POS_ENABLED) {
+                bool cellOk = ModemTask::run(cellFixJob, &fix, ModemTask::Lane::Urgent);
+                Metrics::increment(cellOk ? Metrics::Counter::CellFixOk : Metrics::Counter::CellFixFailed);
+                if (cellOk) {
+                    publishFix(fix);
+                }
+            }
+        }
+        Metrics::observe(Metrics::Histogram::GnssTaskIteration, millis() - iterationStart);
+        PowerManager::waitForNextSample(lastWake, nextSampleMs);
+    }
+}
+
+void uploaderTaskMain(void*) {
+    for (;;) {
+        GpsFix* fix = nullptr;
+        bool received = xQueueReceive(gnssFixQueue, &fix, pdMS_TO_TICKS(AppConfig::UPLOADER_TASK_POLL_MS)) == pdTRUE;
+        unsigned long iterationStart = millis();
+        bool uploadSlot = (received || GeoUploader::backlogPending()) && SamplingScheduler::takeUploadSlot();
+        if (received) {
+            if (uploadSlot) {
+                GeoUploader::submitFix(*fix);
+            } else {
+                GeoUploader::deferFix(*fix);
+            }
+            delete fix;
+        }
+        // A backlog-only flush holds no queued fix, so it takes its own work token: otherwise
+        // Wi-Fi parking or light sleep could cut the upload mid-exchange.
+        if (uploadSlot) {
+            PowerManager::beginWork();
+            GeoUploader::flushBuffer();
+            PowerManager::endWork();
+        }
+        if (received) {
+            PowerManager::endWork();
+        }
+        Metrics::observe(Metrics::Histogram::UploaderTaskIteration, millis() - iterationStart);
+    }
+}
+
+void connectivityTaskMain(void*) {
+    for (;;) {
+        if (PowerManager::wifiParkRequested()) {
+            WifiManager::suspend();
+            PowerManager::acknowledgeWifiParked();
+            vTaskDelay(pdMS_TO_TICKS(AppConfig::CONNECTIVITY_TASK_POLL_MS));
+            continue;
+        }
+        unsigned long iterationStart = millis();
+        WifiManager::ensureConnected();
+        WifiManager::loop();
+        Metrics::observe(Metrics::Histogram::ConnectivityTaskIteration, millis() - iterationStart);
+        vTaskDelay(pdMS_TO_TICKS(AppConfig::CONNECTIVITY_TASK_POLL_MS));
+    }
+}
+
+bool spawnTask(TaskFunction_t entry, const char* name, uint32_t stackBytes, uint8_t priority) {
+    if (xTaskCreate(entry, name, stackBytes, nullptr, priority, nullptr) != pdPASS) {
+        LOG_E(Tasks, "Failed to start %s task", name);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+namespace AppTasks {
+
+void start() {
+    gnssFixQueue = xQueueCreate(AppConfig::GNSS_FIX_QUEUE_DEPTH, sizeof(GpsFix*));
+    if (gnssFixQueue == nullptr) {
+        LOG_E(Tasks, "Failed to allocate GNSS fix queue");
+        return;
+    }
+    ModemTask::start();
+    spawnTask(gnssTaskMain, "gnss", AppConfig::GNSS_TASK_STACK_BYTES, AppConfig::GNSS_TASK_PRIORITY);
+    spawnTask(uploaderTaskMain, "uploader", AppConfig::UPLOADER_TASK_STACK_BYTES, AppConfig::UPLOADER_TASK_PRIORITY);
+    spawnTask(connectivityTaskMain,
+              "connectivity",
+              AppConfig::CONNECTIVITY_TASK_STACK_BYTES,
+              AppConfig::CONNECTIVITY_TASK_PRIORITY);
+}
+
+}  // namespace AppTasks
@@ -0,0 +1,7 @@
+#pragma once
+
+namespace AppTasks {
+
+void start();
+
+}  // namespace AppTasks
@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""Regenerate gps/CellTable.h from an OpenCelliD-format CSV export.
+
+Input columns (OpenCelliD "cell_towers.csv"):
+    radio,mcc,net,area,cell,unit,lon,lat,range,samples,changeable,created,updated,averageSignal
+
+Only LTE rows are kept (for LTE, `unit` is the physical cell id used to match
+neighbour cells). Rows are sorted by (mcc, mnc, cell) so the firmware can
+binary-search the serving cell. Each entry costs 24 bytes of flash, so export
+only the region the trackers operate in, e.g. filter by MCC/MNC or a bounding box:
+
+    python3 tools/build_cell_table.py cell_towers.csv --mcc 460 --bbox 30.5,120.8,31.9,122.2
+"""
+
+import argparse
+import csv
+import pathlib
+
+SKETCH_DIR = pathlib.Path(__file__).resolve().parent.parent
+OUTPUT = SKETCH_DIR / "gps" / "CellTable.h"
+MAX_RANGE_M = 0xFFFF
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("csv", nargs="?", help="OpenCelliD CSV export; omit to write an empty table")
+    parser.add_argument("--mcc", type=int, action="append", help="keep only these MCCs (repeatable)")
+    parser.add_argument("--mnc", type=int, action="append", help="keep only these MNCs (repeatable)")
+    parser.add_argument("--bbox", help="min_lat,min_lon,max_lat,max_lon")
+    return parser.parse_args()
+
+
+def load_rows(args):
+    if not args.csv:
+        return []
+    bbox = [float(v) for v in args.bbox.split(",")] if args.bbox else None
+    rows = {}
+    with open(args.csv, newline="") as handle:
+        for record in csv.DictReader(handle):
+            if record["radio"] != "LTE":
+                continue
+            mcc, mnc = int(record["mcc"]), int(record["net"])
+            if args.mcc and mcc not in args.mcc:
+                continue
+            if args.mnc and mnc not in args.mnc:
+                continue
+            lat, lon = float(record["lat"]), float(record["lon"])
+            if bbox and not (bbox[0] <= lat <= bbox[2] and bbox[1] <= lon <= bbox[3]):
+                continue
+            key = (mcc, mnc, int(record["cell"]))
+            rows[key] = (
+                int(record["area"]) & 0xFFFF,
+                int(record["unit"] or 0) & 0xFFFF,
+                round(lat * 1e7),
+                round(lon * 1e7),
+                min(int(float(record["range"] or 0)), MAX_RANGE_M),
+            )
+    return sorted((key + value) for key, value in rows.items())
+
+
+def main():
+    rows = load_rows(parse_args())
+    lines = [
+        "#pragma once",
+        "",
+        "// Generated by tools/build_cell_table.py -- do not edit by hand.",
+        "",
+        "#include <Arduino.h>",
+        "",
+        "namespace CellTable {",
+        "",
+        "struct Tower {",
+        "    uint16_t mcc;",
+        "    uint16_t mnc;",
+        "    uint32_t cellId;",
+        "    uint16_t tac;",
+        "    uint16_t pci;",
+        "    int32_t latitudeE7;",
+        "    int32_t longitudeE7;",
+        "    uint16_t rangeMeters;",
+        "};",
+        "",
+        f"// {len(rows)} LTE cells, sorted by (mcc, mnc, cellId).",
+        "inline constexpr Tower TOWERS[] PROGMEM = {",
+    ]
+    for mcc, mnc, cell, tac, pci, lat, lon, rng in rows:
+        lines.append(f"    {{{mcc}, {mnc}, {cell}, {tac}, {pci}, {lat}, {lon}, {rng}}},")
+    if not rows:
+        lines.append("    {0, 0, 0, 0, 0, 0, 0, 0},  // placeholder, the table is empty")
+    lines.append("};")
+    lines.append(f"inline constexpr size_t TOWER_COUNT = {len(rows)};")
+    lines.append("")
+    lines.append("}  // namespace CellTable")
+    lines.append("")
+    OUTPUT.write_text("\n".join(lines))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+"""Regenerate wifi/PortalAssets.h from wifi/portal/*.html.
+
+Each page is gzip-compressed (mtime pinned to 0 so the output is reproducible) and
+emitted as a const byte array that stays in flash and is served with
+Content-Encoding: gzip. Run from the sketch directory after editing a page:
+
+    python3 tools/embed_portal_assets.py
+"""
+
+import gzip
+import pathlib
+
+SKETCH_DIR = pathlib.Path(__file__).resolve().parent.parent
+PAGES = [
+    ("INDEX_HTML_GZ", SKETCH_DIR / "wifi" / "portal" / "index.html"),
+]
+OUTPUT = SKETCH_DIR / "wifi" / "PortalAssets.h"
+
+
+def to_array(name, data):
+    lines = [f"inline constexpr uint8_t {name}[] PROGMEM = {{"]
+    for offset in range(0, len(data), 16):
+        chunk = ", ".join(f"0x{b:02x}" for b in data[offset:offset + 16])
+        lines.append(f"    {chunk},")
+    lines.append("};")
+    lines.append(f"inline constexpr size_t {name}_LEN = sizeof({name});")
+    return "\n".join(lines)
+
+
+def main():
+    parts = [
+        "#pragma once",
+        "",
+        "// Generated by tools/embed_portal_assets.py from wifi/portal/ -- do not edit by hand.",
+        "",
+        "#include <Arduino.h>",
+        "",
+        "namespace PortalAssets {",
+        "",
+    ]
+    for name, path in PAGES:
+        raw = path.read_bytes()
+        packed = gzip.compress(raw, compresslevel=9, mtime=0)
+        parts.append(f"// {path.relative_to(SKETCH_DIR).as_posix()}: {len(raw)} bytes -> {len(packed)} bytes gzip")
+        parts.append(to_array(name, packed))
+        parts.append("")
+    parts.append("}  // namespace PortalAssets")
+    parts.append("")
+    OUTPUT.write_text("\n".join(parts))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,92 @@
+#pragma once
+
+// Generated by tools/embed_portal_assets.py from wifi/portal/ -- do not edit by hand.
+
+#include <Arduino.h>
+
+namespace PortalAssets {
+
+// wifi/portal/index.html: 2143 bytes -> 1248 bytes gzip
+inline constexpr uint8_t INDEX_HTML_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x6d, 0x56, 0x5b, 0x6f, 0x13, 0x47,
+    0x14, 0x7e, 0xf7, 0xaf, 0xd8, 0x0a, 0xaa, 0xb1, 0xd5, 0x78, 0xbd, 0x71, 0x82, 0x13, 0xd6, 0x97,
+    0x87, 0x02, 0x95, 0x22, 0x15, 0x11, 0xd5, 0x54, 0x55, 0x55, 0xf5, 0x61, 0xbc, 0x33, 0x6b, 0x4f,
+    0xd9, 0x1b, 0x3b, 0xb3, 0x49, 0x5c, 0x0b, 0x89, 0x4b, 0x5b, 0x28, 0x6a, 0x80, 0xaa, 0x05, 0x0a,
+    0x82, 0x16, 0x5a, 0x50, 0x53, 0x24, 0x48, 0xa8, 0x5a, 0xc2, 0x2d, 0xe5, 0xc7, 0x34, 0xeb, 0x75,
+    0x9e, 0xfa, 0x17, 0x7a, 0x66, 0x66, 0x73, 0x47, 0x96, 0xec, 0xf5, 0xcc, 0x99, 0xef, 0x7c, 0xf3,
+    0x9d, 0xef, 0x1c, 0xbb, 0xf1, 0xce, 0xd1, 0x13, 0x47, 0x4e, 0x7e, 0x3a, 0x7b, 0xcc, 0xe8, 0x09,
+    0xdf, 0x6b, 0x35, 0xf2, 0x77, 0x8a, 0x49, 0xab, 0xe1, 0x53, 0x81, 0x0d, 0xa7, 0x87, 0x63, 0x4e,
+    0x45, 0x13, 0x25, 0xc2, 0x2d, 0x4f, 0xa3, 0x4a, 0xab, 0xa0, 0xd7, 0x03, 0xec, 0xd3, 0x26, 0x9a,
+    0x63, 0x74, 0x3e, 0x0a, 0x63, 0x81, 0x0c, 0x27, 0x0c, 0x04, 0x0d, 0x20, 0x6e, 0x9e, 0x11, 0xd1,
+    0x6b, 0x12, 0x3a, 0xc7, 0x1c, 0x5a, 0x56, 0x5f, 0xc6, 0x58, 0xc0, 0x04, 0xc3, 0x5e, 0x99, 0x3b,
+    0xd8, 0xa3, 0xcd, 0x71, 0x05, 0x22, 0x98, 0xf0, 0x68, 0xeb, 0x58, 0x7b, 0x76, 0xa2, 0x6a, 0x7c,
+    0xc2, 0xca, 0x1f, 0x30, 0xa3, 0x4d, 0x45, 0x12, 0x35, 0x2a, 0x7a, 0xa3, 0xd0, 0xe0, 0xa2, 0x0f,
+    0x9f, 0x9d, 0x90, 0xf4, 0x07, 0x2e, 0x60, 0x97, 0x5d, 0xec, 0x33, 0xaf, 0x6f, 0x97, 0x71, 0x14,
+    0x79, 0xb4, 0xcc, 0xfb, 0x5c, 0x50, 0x7f, 0x4c, 0x7f, 0x94, 0x13, 0x56, 0x8f, 0x30, 0x21, 0x2c,
+    0xe8, 0xda, 0xe3, 0xb5, 0x68, 0xa1, 0xde, 0xc1, 0xce, 0xa9, 0x6e, 0x1c, 0x26, 0x01, 0xb1, 0x0f,
+    0xb8, 0x35, 0x77, 0xda, 0xc5, 0xf5, 0x33, 0x05, 0xd3, 0xc1, 0x31, 0x19, 0xf8, 0x78, 0x41, 0xb3,
+    0xb2, 0x27, 0xab, 0x16, 0x84, 0xfa, 0x38, 0xee, 0xb2, 0xc0, 0xc6, 0x89, 0x08, 0x77, 0x1f, 0x73,
+    0xdd, 0x2d, 0xcc, 0xea, 0xa4, 0xc4, 0x0c, 0x63, 0x42, 0xe3, 0x72, 0x8c, 0x09, 0x4b, 0xb8, 0x3d,
+    0x5e, 0x55, 0x4b, 0x0b, 0x65, 0xde, 0xc3, 0x24, 0x9c, 0xb7, 0x2d, 0x63, 0x1c, 0xd0, 0x8c, 0x09,
+    0xf9, 0x16, 0x77, 0x3b, 0xb8, 0x68, 0x8d, 0xa9, 0x97, 0x69, 0x4d, 0x97, 0x20, 0xb7, 0x87, 0x3b,
+    0xd4, 0x1b, 0x10, 0xc6, 0x23, 0x0f, 0xf7, 0xed, 0x8e, 0x17, 0x3a, 0xa7, 0xf2, 0xcc, 0x65, 0x11,
+    0x46, 0x1a, 0x4d, 0xdd, 0x72, 0x9e, 0xb2, 0x6e, 0x4f, 0xd8, 0x35, 0xcb, 0x82, 0x53, 0x2c, 0x88,
+    0x12, 0x31, 0xd0, 0x6c, 0xc7, 0x2d, 0xeb, 0xdd, 0xed, 0x4b, 0x6e, 0x33, 0x57, 0xe7, 0x6b, 0xfb,
+    0xf8, 0x6d, 0xaf, 0xd8, 0xe3, 0x40, 0x89, 0x87, 0x1e, 0x23, 0xc6, 0x01, 0x62, 0x91, 0x29, 0x42,
+    0x01, 0xb9, 0x93, 0x08, 0x11, 0x06, 0x83, 0x9d, 0x14, 0xa6, 0xe1, 0xc4, 0xdb, 0x52, 0x55, 0xb7,
+    0x91, 0x82, 0x30, 0xa0, 0x6f, 0xcb, 0xb3, 0x43, 0x36, 0xcb, 0x9a, 0xb2, 0xdc, 0x89, 0xba, 0x13,
+    0x7a, 0x61, 0xac, 0x45, 0x54, 0xd7, 0xe2, 0xec, 0x4b, 0xaa, 0x4b, 0xb3, 0xf7, 0x96, 0x4e, 0x12,
+    0x73, 0x08, 0x8d, 0x42, 0x06, 0xfe, 0x89, 0x81, 0x5a, 0x94, 0xb3, 0xb2, 0x41, 0x01, 0xb3, 0x07,
+    0xab, 0x3b, 0x59, 0x4a, 0x92, 0x39, 0xf6, 0xa1, 0xa9, 0x9a, 0x55, 0x83, 0xba, 0x36, 0x2a, 0xda,
+    0x29, 0x8d, 0x8a, 0x76, 0xad, 0x74, 0x0c, 0xd8, 0x87, 0xb0, 0x39, 0xc3, 0xf1, 0x30, 0xe7, 0x4d,
+    0x24, 0xeb, 0x8e, 0xc0, 0xd4, 0xd5, 0x96, 0x36, 0xda, 0xc6, 0xd7, 0x8b, 0xd9, 0xda, 0x13, 0x88,
+    0xaf, 0x42, 0x5c, 0x64, 0x30, 0xd2, 0x44, 0x3e, 0xef, 0x22, 0x43, 0xe1, 0x40, 0xb8, 0xc6, 0xb7,
+    0x0e, 0xd7, 0x0e, 0x13, 0xbc, 0xa9, 0x72, 0x27, 0x04, 0xc1, 0x7c, 0xad, 0xc6, 0x66, 0x19, 0x95,
+    0x1c, 0x00, 0x5c, 0x89, 0xb6, 0x70, 0x02, 0x2a, 0xf6, 0xe2, 0xe4, 0x3c, 0x51, 0x6b, 0xf8, 0xf8,
+    0xb7, 0xf4, 0xce, 0xd2, 0x68, 0xf9, 0x55, 0x7a, 0xf5, 0x46, 0x76, 0xf9, 0xd9, 0xf0, 0xec, 0x39,
+    0xd3, 0x34, 0x37, 0x0f, 0xe7, 0x54, 0xe5, 0x7d, 0x51, 0x4b, 0x13, 0xcc, 0x2e, 0x3c, 0xce, 0xce,
+    0xbf, 0xb0, 0x0d, 0xe8, 0x84, 0x38, 0x0c, 0xba, 0x0a, 0x1f, 0x47, 0x32, 0x9f, 0x5e, 0x80, 0xab,
+    0xc6, 0x95, 0xd6, 0xe8, 0xcd, 0xcf, 0xc3, 0x2b, 0x0f, 0xd3, 0x6b, 0x57, 0x46, 0x4f, 0xde, 0x6c,
+    0xdc, 0x7c, 0xb2, 0x27, 0x9a, 0xed, 0x8a, 0x57, 0xb9, 0xdc, 0x30, 0xf6, 0x0d, 0x68, 0xe1, 0x5e,
+    0x08, 0x11, 0xb3, 0x27, 0xda, 0x27, 0x91, 0x81, 0x1d, 0xc1, 0xc2, 0xa0, 0x89, 0x2a, 0xd0, 0xc4,
+    0x2e, 0xeb, 0x26, 0x31, 0x45, 0x10, 0xa8, 0x3c, 0x9b, 0x4b, 0x96, 0x5e, 0x5b, 0xcc, 0x7e, 0x5f,
+    0x31, 0x8a, 0xed, 0xf6, 0xcc, 0xd1, 0x52, 0xa3, 0xa2, 0xb7, 0x1a, 0xca, 0x9f, 0x2a, 0x13, 0xe7,
+    0x8c, 0xa0, 0x7c, 0x26, 0xe8, 0xe7, 0x98, 0x9e, 0x4e, 0x58, 0x4c, 0x89, 0x51, 0xd9, 0x0b, 0xb5,
+    0xfc, 0x4d, 0x76, 0xef, 0x9c, 0x51, 0x4c, 0xaf, 0x2e, 0x67, 0xd7, 0x6f, 0x65, 0x7f, 0xbc, 0xfc,
+    0xef, 0xf5, 0x77, 0xa3, 0xfb, 0x4b, 0xd9, 0x83, 0x97, 0xc3, 0x9b, 0xf7, 0xf4, 0xe6, 0xdb, 0x32,
+    0x44, 0xa0, 0xcf, 0x66, 0x06, 0xf9, 0x3c, 0x0f, 0x36, 0x44, 0x86, 0xe8, 0x47, 0xbb, 0xbe, 0xcb,
+    0x64, 0xda, 0xdb, 0xf9, 0x16, 0x4f, 0x3a, 0x3e, 0x03, 0x49, 0xd7, 0xdf, 0xdc, 0x4d, 0x1f, 0xff,
+    0x94, 0xbe, 0x78, 0xa6, 0xf5, 0x6a, 0x54, 0x74, 0x14, 0x68, 0x22, 0xf5, 0x50, 0x25, 0xc8, 0xcb,
+    0xb6, 0xb3, 0x27, 0x6a, 0xfb, 0xec, 0xb6, 0x85, 0x24, 0x05, 0xff, 0x27, 0x7d, 0x70, 0x71, 0xfd,
+    0xf5, 0xed, 0xd1, 0xc5, 0x47, 0xe9, 0xe5, 0xa5, 0x74, 0xe5, 0xee, 0x68, 0xf9, 0xba, 0x86, 0x1f,
+    0xde, 0x58, 0xc9, 0x6e, 0x7f, 0xa5, 0xe7, 0xda, 0xbf, 0x67, 0xcf, 0x4b, 0xe1, 0x1b, 0x15, 0x70,
+    0xa4, 0x1c, 0x6b, 0x4e, 0xcc, 0x22, 0xd1, 0x2a, 0xcc, 0xe1, 0xd8, 0x38, 0xde, 0x1c, 0x20, 0x8e,
+    0xe7, 0x28, 0x41, 0x36, 0xd2, 0xb0, 0xc3, 0x4b, 0xd7, 0xd2, 0xcb, 0xbf, 0x80, 0x22, 0xda, 0x2c,
+    0x3b, 0x31, 0xc1, 0x2c, 0x68, 0x0c, 0x51, 0x3f, 0x12, 0x7d, 0x08, 0x97, 0x85, 0x30, 0xd6, 0x9f,
+    0x2f, 0x8e, 0x2e, 0xac, 0xad, 0x3f, 0x7f, 0x09, 0x2a, 0x42, 0x1a, 0x74, 0xa6, 0xae, 0x60, 0xfd,
+    0xe6, 0xf1, 0xcf, 0x02, 0x3a, 0x6f, 0x7c, 0xfc, 0xd1, 0x87, 0x6d, 0x8a, 0x63, 0xa7, 0x37, 0x8b,
+    0x63, 0xec, 0xf3, 0x22, 0x4c, 0x1d, 0x2c, 0x0b, 0x6d, 0x72, 0xb5, 0x5a, 0x32, 0xbb, 0x54, 0x14,
+    0x91, 0x8f, 0x4a, 0x9f, 0xd7, 0x0b, 0x6e, 0x12, 0x28, 0x13, 0x18, 0x07, 0x8b, 0xac, 0x34, 0x88,
+    0x61, 0x14, 0xc7, 0x81, 0x41, 0x42, 0x27, 0xf1, 0x61, 0xa8, 0xcb, 0xc0, 0x63, 0x1e, 0x95, 0x8f,
+    0xef, 0xf7, 0x67, 0x08, 0x44, 0xc8, 0xe1, 0xe4, 0x16, 0xfd, 0xd2, 0xe0, 0x60, 0x51, 0xf5, 0x4e,
+    0xc9, 0x14, 0x74, 0x41, 0x1c, 0xc9, 0x7f, 0x03, 0xfc, 0xfa, 0xd6, 0xb2, 0x12, 0xd5, 0xcc, 0x3b,
+    0xa6, 0x89, 0xd4, 0xe4, 0x43, 0x70, 0xda, 0xa5, 0xc2, 0xe9, 0x15, 0x11, 0x58, 0x13, 0x8b, 0x84,
+    0x9b, 0x5f, 0xf0, 0x30, 0x90, 0x20, 0x3d, 0x1a, 0x14, 0x37, 0xa9, 0x14, 0xe3, 0x2d, 0x22, 0xb1,
+    0x0a, 0x28, 0x42, 0xda, 0xbd, 0x31, 0xbc, 0x34, 0x50, 0x77, 0x0e, 0x9a, 0x90, 0x52, 0x76, 0x5f,
+    0xa9, 0x2e, 0x99, 0x71, 0x13, 0xac, 0x1c, 0x50, 0x47, 0x50, 0x52, 0x1a, 0x04, 0x39, 0x0b, 0x55,
+    0xc9, 0x26, 0x3a, 0x50, 0x9d, 0xc6, 0x53, 0x93, 0x87, 0x50, 0x3d, 0xd8, 0x45, 0x1a, 0xa5, 0xab,
+    0x7f, 0x6a, 0xa5, 0xb3, 0xb5, 0xef, 0xb3, 0x57, 0x77, 0xa0, 0x08, 0x33, 0xb3, 0xb6, 0x81, 0xde,
+    0xe3, 0x26, 0x8b, 0x80, 0x31, 0xf5, 0x38, 0xdd, 0x07, 0x45, 0xa6, 0x26, 0xf0, 0xe4, 0xe1, 0xfd,
+    0x50, 0x6b, 0x3f, 0xa4, 0xdf, 0x2e, 0x0e, 0xef, 0x3c, 0xca, 0xbb, 0xf3, 0xd2, 0xca, 0x68, 0x75,
+    0x39, 0xfb, 0xf1, 0x69, 0x7a, 0x6b, 0x49, 0xd6, 0x09, 0xd0, 0x80, 0x2d, 0xf4, 0xf2, 0x6e, 0xd9,
+    0xb8, 0x89, 0xa3, 0x36, 0x34, 0x4f, 0x5d, 0x6d, 0xb2, 0xbd, 0xdb, 0xa8, 0x27, 0x44, 0x64, 0x57,
+    0x2a, 0x92, 0x11, 0x8e, 0x66, 0xa2, 0xba, 0x04, 0x51, 0xcd, 0x56, 0x32, 0xe7, 0xb0, 0x97, 0x50,
+    0x00, 0xe0, 0xf9, 0x71, 0xd5, 0x2d, 0xdb, 0xcb, 0x9b, 0x0d, 0x52, 0x2f, 0x80, 0x80, 0x60, 0x02,
+    0x90, 0x7e, 0x4b, 0x41, 0x55, 0x43, 0xa5, 0xdc, 0xee, 0x6c, 0x7a, 0x44, 0xe9, 0x71, 0x95, 0x3e,
+    0x78, 0x3a, 0xfa, 0xeb, 0xa1, 0x6c, 0xd4, 0xe5, 0xd5, 0xf4, 0xd2, 0x2a, 0xd8, 0x7b, 0xe3, 0xfe,
+    0xdf, 0x1b, 0x77, 0x7f, 0xd5, 0x97, 0x01, 0xc9, 0x61, 0xc6, 0x68, 0x5f, 0x43, 0x63, 0xc9, 0xf9,
+    0x0b, 0xc3, 0x55, 0xfe, 0x91, 0x28, 0xfc, 0x0f, 0x7c, 0x5d, 0xbc, 0xbb, 0x5f, 0x08, 0x00, 0x00,
+};
+inline constexpr size_t INDEX_HTML_GZ_LEN = sizeof(INDEX_HTML_GZ);
+
+}  // namespace PortalAssets
@@ -1,6 +1,9 @@
 #include "WifiManager.h"
 
 #include "../config/AppConfig.h"
+#include "../metrics/Metrics.h"
+#include "../net/LinkHealth.h"
+#include "PortalAssets.h"
 #include <Preferences.h>
 #include <WebServer.h>
 
@@ -50,7 +53,8 @@ void configureWifiStack() {
     WiFi.mode(WIFI_AP_STA);
     WiFi.persistent(false);
     WiFi.setAutoReconnect(true);
-    WiFi.setSleep(false);
+    // Modem sleep costs some latency on the portal, so only take it when running on a budget.
+    WiFi.setSleep(AppConfig::POWER_SAVE_ENABLED);
 }
 
 void announcePortalAccess() {
@@ -109,54 +113,100 @@ void persistCredentials(const String& ssid, const String& password) {
     credentialsAvailable = true;
 }
 
-String htmlPage(const String& message) {
-    String page = "<!DOCTYPE html><html><head><meta charset='utf-8'/>"
-                  "<meta name='viewport' content='width=device-width,initial-scale=1'/>"
-                  "<title>ESP32 Wi-Fi Setup</title>"
-                  "<style>body{font-family:-apple-system,system-ui;padding:16px;background:#f6f8fa;}"
-                  ".card{max-width:420px;margin:auto;background:#fff;padding:24px;border-radius:12px;"
-                  "box-shadow:0 10px 30px rgba(0,0,0,0.08);}label{display:block;margin-top:12px;font-weight:600;}"
-                  "input{width:100%;padding:10px;margin-top:6px;border-radius:6px;border:1px solid #d0d7de;}"
-                  "button{margin-top:18px;width:100%;padding:12px;border:none;border-radius:6px;background:#0070f3;"
-                  "color:#fff;font-size:16px;font-weight:600;cursor:pointer;}p{margin:0;}</style></head><body>"
-                  "<div class='card'><h2>Wi-Fi 配置</h2>";
-    if (!message.isEmpty()) {
-        page += "<p style='color:#0969da;margin-bottom:12px;'>" + message + "</p>";
+void sendPortalPage() {
+    portalLastActivity = millis();
+    portalServer.sendHeader("Content-Encoding", "gzip");
+    portalServer.sendHeader("Cache-Control", "no-cache");
+    portalServer.send_P(200,
+                        "text/html",
+                        reinterpret_cast<const char*>(PortalAssets::INDEX_HTML_GZ),
+                        PortalAssets::INDEX_HTML_GZ_LEN);
+}
+
+void redirectToPortal(const char* messageKey) {
+    portalServer.sendHeader("Location", String("/?m=") + messageKey, true);
+    portalServer.send(303, "text/plain", "");
+}
+
+void sendJsonEscaped(const char* value) {
+    char chunk[64];
+    size_t used = 0;
+    for (const char* p = value; *p != '\0'; ++p) {
+        if (used + 6 >= sizeof(chunk)) {
+            portalServer.sendContent(chunk, used);
+            used = 0;
+        }
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\') {
+            chunk[used++] = '\\';
+            chunk[used++] = static_cast<char>(c);
+        } else if (c < 0x20) {
+            used += snprintf(chunk + used, sizeof(chunk) - used, "\\u%04x", c);
+        } else {
+            chunk[used++] = static_cast<char>(c);
+        }
     }
-    if (WiFi.status() == WL_CONNECTED) {
-        page += "<p style='color:#28a745;'>已连接网络，IP: " + WiFi.localIP().toString() + "</p>";
-    } else {
-        page += "<p style='color:#d73a49;'>当前未连接到路由器。</p>";
+    if (used > 0) {
+        portalServer.sendContent(chunk, used);
     }
-    page += "<p style='margin-top:8px;color:#57606a;'>配置热点: <strong>" + String(AP_SSID) +
-            "</strong><br/>连接后访问 <strong>http://" + WiFi.softAPIP().toString() + "</strong></p>";
-    page += "<form method='POST' action='/configure'>"
-            "<label>Wi-Fi 名称 (SSID)</label>"
-            "<input name='ssid' value='" + configuredSsid + "' required />"
-            "<label>Wi-Fi 密码 (可留空，表示无密码)</label>"
-            "<input name='password' type='password' value='" + configuredPassword + "' />"
-            "<button type='submit'>保存并连接</button>"
-            "</form>"
-            "<p style='margin-top:16px;color:#57606a;'>保存后设备会自动尝试连接新的 Wi-Fi。</p>"
-            "</div></body></html>";
-    return page;
 }
 
-void sendPortalPage(const String& message = "") {
+void sendJsonField(const char* prefix, const char* value) {
+    portalServer.sendContent(prefix);
+    sendJsonEscaped(value);
+    portalServer.sendContent("\"");
+}
+
+// Dynamic half of the portal page: written as small chunks so no page-sized String is built.
+void sendPortalStatus() {
     portalLastActivity = millis();
-    portalServer.send(200, "text/html", htmlPage(message));
+    bool connected = WiFi.status() == WL_CONNECTED;
+    portalServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    portalServer.sendHeader("Cache-Control", "no-cache");
+    portalServer.send(200, "application/json", "");
+    portalServer.sendContent(connected ? "{\"connected\":true" : "{\"connected\":false");
+    sendJsonField(",\"ip\":\"", connected ? WiFi.localIP().toString().c_str() : "");
+    sendJsonField(",\"apSsid\":\"", AP_SSID);
+    sendJsonField(",\"apIp\":\"", WiFi.softAPIP().toString().c_str());
+    sendJsonField(",\"ssid\":\"", configuredSsid.c_str());
+    sendJsonField(",\"password\":\"", configuredPassword.c_str());
+    portalServer.sendContent("}");
+    portalServer.sendContent("");
+}
+
+void sendPortalChunk(const char* data, size_t length) {
+    portalServer.sendContent(data, length);
+}
+
+// An open breaker turns half-open when its backoff expires, with no event to publish it,
+// so breaker state is sampled per scrape.
+void refreshBreakerGauges() {
+    Metrics::setGauge(Metrics::Gauge::WifiBreakerState,
+                      static_cast<uint32_t>(LinkHealth::state(LinkHealth::Link::Wifi)));
+    Metrics::setGauge(Metrics::Gauge::CellularBreakerState,
+                      static_cast<uint32_t>(LinkHealth::state(LinkHealth::Link::Cellular)));
+}
+
+// /metrics and /stats: chunked like /status.json, rendered straight into the response.
+void sendMetricsStream(const char* contentType, void (*render)(Metrics::Sink)) {
+    refreshBreakerGauges();
+    portalServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    portalServer.sendHeader("Cache-Control", "no-cache");
+    portalServer.send(200, contentType, "");
+    render(sendPortalChunk);
+    portalServer.sendContent("");
 }
 
 void handleConfigSubmit() {
     const String ssid = portalServer.arg("ssid");
     const String password = portalServer.arg("password");
     if (ssid.isEmpty()) {
-        sendPortalPage("SSID 不能为空。");
+        redirectToPortal("empty");
         return;
     }
 
     persistCredentials(ssid, password);
-    sendPortalPage("保存成功，正在尝试连接...");
+    redirectToPortal("saved");
     portalLastActivity = millis();
     wifiNextRetryAt = 0;
 }
@@ -165,10 +215,15 @@ void configurePortalRoutes() {
     if (portalRoutesConfigured) {
         return;
     }
-    portalServer.on("/", HTTP_GET, []() {
-        sendPortalPage();
-    });
+    portalServer.on("/", HTTP_GET, sendPortalPage);
+    portalServer.on("/status.json", HTTP_GET, sendPortalStatus);
     portalServer.on("/configure", HTTP_POST, handleConfigSubmit);
+    portalServer.on("/metrics", HTTP_GET, []() {
+        sendMetricsStream("text/plain; version=0.0.4", Metrics::writePrometheus);
+    });
+    portalServer.on("/stats", HTTP_GET, []() {
+        sendMetricsStream("application/json", Metrics::writeJson);
+    });
     portalServer.onNotFound([]() {
         portalServer.send(404, "text/plain", "Not found");
     });
@@ -277,6 +332,19 @@ bool ensureConnected() {
     return false;
 }
 
+// Radio off ahead of light sleep; the next loop()/ensureConnected() brings AP and STA back.
+void suspend() {
+    if (WiFi.getMode() == WIFI_OFF) {
+        return;
+    }
+    portalServer.stop();
+    portalRunning = false;
+    configApStarted = false;
+    wifiNextRetryAt = 0;
+    WiFi.disconnect(true);
+    WiFi.mode(WIFI_OFF);
+}
+
 void loop() {
     startConfigPortal();
     handlePortalLoop();
@@ -7,6 +7,7 @@ namespace WifiManager {
 void begin();
 bool ensureConnected();
 void loop();
+void suspend();
 
 }  // namespace WifiManager
 
@@ -0,0 +1,110 @@
+#pragma once
+
+// Minimal Arduino.h for building the cellular clients and payload encoders with plain g++ on a PC.
+// String covers the subset the firmware uses; millis() is a virtual clock that delay() advances,
+// so modem timeouts elapse without waiting.
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+
+using std::max;
+using std::min;
+
+class String {
+public:
+    String() = default;
+    String(const char* text) : text_(text ? text : "") {}
+    explicit String(char c) : text_(1, c) {}
+    explicit String(unsigned char value) : text_(std::to_string(value)) {}
+    explicit String(int value) : text_(std::to_string(value)) {}
+    explicit String(unsigned int value) : text_(std::to_string(value)) {}
+    explicit String(long value) : text_(std::to_string(value)) {}
+    explicit String(unsigned long value) : text_(std::to_string(value)) {}
+    String(double value, unsigned int decimals) {
+        char buffer[48];
+        snprintf(buffer, sizeof(buffer), "%.*f", static_cast<int>(decimals), value);
+        text_ = buffer;
+    }
+
+    unsigned int length() const { return static_cast<unsigned int>(text_.size()); }
+    const char* c_str() const { return text_.c_str(); }
+    bool isEmpty() const { return text_.empty(); }
+    bool reserve(unsigned int size) {
+        text_.reserve(size);
+        return true;
+    }
+
+    char operator[](unsigned int index) const { return text_[index]; }
+    bool operator==(const String& other) const { return text_ == other.text_; }
+    bool operator==(const char* other) const { return text_ == other; }
+
+    String& operator+=(const String& other) {
+        text_ += other.text_;
+        return *this;
+    }
+    String& operator+=(const char* other) {
+        text_ += other;
+        return *this;
+    }
+    String& operator+=(char c) {
+        text_ += c;
+        return *this;
+    }
+
+    int indexOf(char c, unsigned int from = 0) const { return found(text_.find(c, from)); }
+    int indexOf(const String& needle, unsigned int from = 0) const { return found(text_.find(needle.text_, from)); }
+    int lastIndexOf(const String& needle) const { return found(text_.rfind(needle.text_)); }
+    bool startsWith(const String& prefix) const { return text_.compare(0, prefix.text_.size(), prefix.text_) == 0; }
+    bool endsWith(const String& suffix) const {
+        return text_.size() >= suffix.text_.size() &&
+               text_.compare(text_.size() - suffix.text_.size(), suffix.text_.size(), suffix.text_) == 0;
+    }
+
+    String substring(unsigned int begin) const { return substring(begin, length()); }
+    String substring(unsigned int begin, unsigned int end) const {
+        end = std::min(end, length());
+        return begin >= end ? String() : String(text_.substr(begin, end - begin).c_str());
+    }
+
+    void trim() {
+        size_t first = text_.find_first_not_of(" \t\r\n");
+        size_t last = text_.find_last_not_of(" \t\r\n");
+        text_ = first == std::string::npos ? std::string() : text_.substr(first, last - first + 1);
+    }
+
+    long toInt() const { return atol(text_.c_str()); }
+
+private:
+    static int found(size_t position) { return position == std::string::npos ? -1 : static_cast<int>(position); }
+
+    std::string text_;
+};
+
+inline String operator+(const String& left, const String& right) {
+    String joined(left);
+    joined += right;
+    return joined;
+}
+
+inline String operator+(const String& left, const char* right) {
+    String joined(left);
+    joined += right;
+    return joined;
+}
+
+inline String operator+(const char* left, const String& right) {
+    String joined(left);
+    joined += right;
+    return joined;
+}
+
+unsigned long millis();
+void delay(unsigned long ms);
+uint32_t esp_random();
@@ -0,0 +1,62 @@
+#pragma once
+
+// Host stand-in for the modem UART. Every println() is one AT command and is handed to
+// onCommand, whose reply is readable at once through available()/read(). URCs wait in `urcs`
+// and arrive one per delay(), the way the modem sends them while the firmware polls.
+// print() and write() carry payload bytes and are captured in `written`.
+
+#include <Arduino.h>
+
+#include <deque>
+#include <functional>
+#include <string>
+
+class HardwareSerial {
+public:
+    std::function<std::string(const std::string& command)> onCommand;
+    std::string inbound;
+    std::deque<std::string> urcs;
+    std::string written;
+
+    size_t println(const String& line) {
+        if (onCommand) {
+            inbound += onCommand(line.c_str());
+        }
+        return line.length() + 2;
+    }
+
+    size_t print(const String& text) {
+        written += text.c_str();
+        return text.length();
+    }
+
+    size_t write(uint8_t value) {
+        written += static_cast<char>(value);
+        return 1;
+    }
+
+    size_t write(const uint8_t* data, size_t length) {
+        written.append(reinterpret_cast<const char*>(data), length);
+        return length;
+    }
+
+    void releaseUrc() {
+        if (inbound.empty() && !urcs.empty()) {
+            inbound = urcs.front();
+            urcs.pop_front();
+        }
+    }
+
+    int available() { return static_cast<int>(inbound.size()); }
+
+    int read() {
+        if (inbound.empty()) {
+            return -1;
+        }
+        uint8_t value = static_cast<uint8_t>(inbound[0]);
+        inbound.erase(0, 1);
+        return value;
+    }
+};
+
+extern HardwareSerial Serial0;
@@ -0,0 +1,507 @@
+// CoapClient host test: the CoAP header/option/Block1 encoding, response parsing and the CBOR
+// fix encoding, checked by decoding every datagram the client sends with an independent
+// RFC 7252 / RFC 7959 / RFC 8949 decoder and answering it through a scripted modem.
+//
+// Build and run from ESP32C3:
+//   g++ -std=gnu++17 -O2 -Ihost host/coap_client_test.cpp host/modem_script.cpp ESP32-C3-TDM2421-4G-GPS/cellular/CoapClient.cpp ESP32-C3-TDM2421-4G-GPS/modem/ModemCommands.cpp ESP32-C3-TDM2421-4G-GPS/net/GeoPayload.cpp ESP32-C3-TDM2421-4G-GPS/net/CborWriter.cpp -o coap_client_test && ./coap_client_test
+//
+// Returns 0 when every check passes, otherwise prints the failures and returns 1.
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "../ESP32-C3-TDM2421-4G-GPS/cellular/CoapClient.h"
+#include "../ESP32-C3-TDM2421-4G-GPS/config/AppConfig.h"
+#include "../ESP32-C3-TDM2421-4G-GPS/net/GeoPayload.h"
+#include "modem_script.h"
+
+namespace {
+int failures = 0;
+
+#define CHECK(condition)                                                \
+    do {                                                                \
+        if (!(condition)) {                                             \
+            printf("[FAIL] %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+const std::string OK = "\r\nOK\r\n";
+const std::string RECV_URC = "\r\n+QIURC: \"recv\",1\r\n";
+
+constexpr uint8_t TYPE_CON = 0;
+constexpr uint8_t TYPE_ACK = 2;
+constexpr uint8_t TYPE_RST = 3;
+constexpr uint8_t CODE_EMPTY = 0x00;
+constexpr uint8_t CODE_POST = 0x02;
+constexpr uint8_t CODE_CHANGED = 0x44;   // 2.04
+constexpr uint8_t CODE_CONTINUE = 0x5F;  // 2.31
+constexpr uint16_t OPTION_URI_PATH = 11;
+constexpr uint16_t OPTION_CONTENT_FORMAT = 12;
+constexpr uint16_t OPTION_URI_QUERY = 15;
+constexpr uint16_t OPTION_BLOCK1 = 27;
+
+// ---- RFC 7252 decoding, written from the RFC rather than from CoapClient ----
+
+struct CoapOption {
+    uint16_t number;
+    std::string value;
+};
+
+struct CoapMessage {
+    uint8_t type = 0;
+    uint8_t code = 0;
+    uint16_t messageId = 0;
+    std::string token;
+    std::vector<CoapOption> options;
+    std::string payload;
+    std::string raw;
+};
+
+bool readExtended(const std::string& bytes, size_t& pos, uint32_t nibble, uint32_t& value) {
+    if (nibble < 13) {
+        value = nibble;
+    } else if (nibble == 13 && pos < bytes.size()) {
+        value = 13 + static_cast<uint8_t>(bytes[pos++]);
+    } else if (nibble == 14 && pos + 1 < bytes.size()) {
+        value = 269 + (static_cast<uint8_t>(bytes[pos]) << 8 | static_cast<uint8_t>(bytes[pos + 1]));
+        pos += 2;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool decodeCoap(const std::string& bytes, CoapMessage& message) {
+    if (bytes.size() < 4 || (static_cast<uint8_t>(bytes[0]) >> 6) != 1) {
+        return false;
+    }
+    message.type = (static_cast<uint8_t>(bytes[0]) >> 4) & 0x03;
+    size_t tokenLength = bytes[0] & 0x0F;
+    message.code = static_cast<uint8_t>(bytes[1]);
+    message.messageId = static_cast<uint16_t>(static_cast<uint8_t>(bytes[2]) << 8 | static_cast<uint8_t>(bytes[3]));
+    if (tokenLength > 8 || 4 + tokenLength > bytes.size()) {
+        return false;
+    }
+    message.token = bytes.substr(4, tokenLength);
+    size_t pos = 4 + tokenLength;
+    uint32_t number = 0;
+    message.options.clear();
+    while (pos < bytes.size()) {
+        uint8_t head = static_cast<uint8_t>(bytes[pos++]);
+        if (head == 0xFF) {
+            message.payload = bytes.substr(pos);
+            return !message.payload.empty();
+        }
+        uint32_t delta = 0;
+        uint32_t length = 0;
+        if (!readExtended(bytes, pos, head >> 4, delta) || !readExtended(bytes, pos, head & 0x0F, length) ||
+            pos + length > bytes.size()) {
+            return false;
+        }
+        number += delta;
+        message.options.push_back(CoapOption{static_cast<uint16_t>(number), bytes.substr(pos, length)});
+        pos += length;
+    }
+    message.payload.clear();
+    return true;
+}
+
+std::vector<std::string> optionValues(const CoapMessage& message, uint16_t number) {
+    std::vector<std::string> values;
+    for (const CoapOption& option : message.options) {
+        if (option.number == number) {
+            values.push_back(option.value);
+        }
+    }
+    return values;
+}
+
+uint32_t optionUint(const std::string& value) {
+    uint32_t result = 0;
+    for (char c : value) {
+        result = result << 8 | static_cast<uint8_t>(c);
+    }
+    return result;
+}
+
+std::string encodeCoapReply(uint8_t type, uint8_t code, uint16_t messageId, const std::string& token) {
+    std::string bytes;
+    bytes += static_cast<char>(0x40 | type << 4 | token.size());
+    bytes += static_cast<char>(code);
+    bytes += static_cast<char>(messageId >> 8);
+    bytes += static_cast<char>(messageId & 0xFF);
+    return bytes + token;
+}
+
+// ---- RFC 8949 decoding of the fix maps ----
+
+struct CborReader {
+    const std::string& bytes;
+    size_t pos = 0;
+    bool ok = true;
+
+    explicit CborReader(const std::string& input) : bytes(input) {}
+
+    uint8_t next() {
+        if (pos >= bytes.size()) {
+            ok = false;
+            return 0;
+        }
+        return static_cast<uint8_t>(bytes[pos++]);
+    }
+
+    uint64_t argument(uint8_t additional) {
+        if (additional < 24) {
+            return additional;
+        }
+        int width = additional == 24 ? 1 : additional == 25 ? 2 : additional == 26 ? 4 : additional == 27 ? 8 : 0;
+        if (width == 0) {
+            ok = false;
+        }
+        uint64_t value = 0;
+        for (int i = 0; i < width; ++i) {
+            value = value << 8 | next();
+        }
+        return value;
+    }
+
+    uint64_t expect(uint8_t major) {
+        uint8_t initial = next();
+        if (initial >> 5 != major) {
+            ok = false;
+        }
+        return argument(initial & 0x1F);
+    }
+
+    float float32() {
+        if (next() != 0xFA) {
+            ok = false;
+        }
+        uint32_t bits = static_cast<uint32_t>(argument(26));
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    std::string text() {
+        uint64_t length = expect(3);
+        if (pos + length > bytes.size()) {
+            ok = false;
+            return std::string();
+        }
+        pos += length;
+        return bytes.substr(pos - length, length);
+    }
+};
+
+// Keys as documented in GeoPayload.cpp: 1-4 float32, 5 uint, 6 tag 0 date/time text,
+// 7 networkSource, and for cell fixes 8 accuracy and 9 "cell".
+bool fixMapMatches(CborReader& reader, const GpsFix& fix) {
+    bool cell = fix.source == PositionSource::Cell;
+    uint64_t entries = reader.expect(5);
+    bool match = entries == (cell ? 9u : 7u);
+    for (uint64_t i = 0; i < entries && reader.ok; ++i) {
+        switch (reader.expect(0)) {
+            case 1: match &= reader.float32() == fix.latitude; break;
+            case 2: match &= reader.float32() == fix.longitude; break;
+            case 3: match &= reader.float32() == fix.altitude; break;
+            case 4: match &= reader.float32() == fix.speed; break;
+            case 5: match &= reader.expect(0) == fix.satelliteCount; break;
+            case 6:
+                match &= reader.expect(6) == 0;
+                match &= reader.text() == fix.dataAcquiredAt.c_str();
+                break;
+            case 7: match &= reader.text() == "4g"; break;
+            case 8: match &= cell && reader.float32() == fix.accuracyMeters; break;
+            case 9: match &= cell && reader.text() == "cell"; break;
+            default: match = false; break;
+        }
+    }
+    return match && reader.ok;
+}
+
+bool payloadMatches(const std::string& payload, const std::vector<GpsFix>& fixes) {
+    CborReader reader(payload);
+    if (fixes.size() > 1 && reader.expect(4) != fixes.size()) {
+        return false;
+    }
+    for (const GpsFix& fix : fixes) {
+        if (!fixMapMatches(reader, fix)) {
+            return false;
+        }
+    }
+    return reader.ok && reader.pos == payload.size();
+}
+
+// ---- fixes and modem script ----
+
+GpsFix sampleFix(int index) {
+    GpsFix fix;
+    fix.latitude = 31.2304f + index * 0.001f;
+    fix.longitude = 121.4737f - index * 0.001f;
+    fix.altitude = 12.5f;
+    fix.speed = 0.4f + index;
+    fix.satelliteCount = static_cast<uint8_t>(5 + index);
+    fix.dataAcquiredAt = "2026-10-19T08:00:00Z";
+    return fix;
+}
+
+GpsFix worstCaseFix(int index) {
+    GpsFix fix = sampleFix(index);
+    fix.latitude = -89.999999f;
+    fix.longitude = -179.99999f;
+    fix.satelliteCount = 255;
+    fix.dataAcquiredAt = "2026-10-19T08:00:00.000Z";
+    fix.source = PositionSource::Cell;
+    fix.accuracyMeters = 2500.0f;
+    return fix;
+}
+
+// Every request the client sent, decoded; checks run after the upload returns.
+std::vector<CoapMessage> requests;
+
+void captureRequest() {
+    std::string written = ModemScript::takeWritten();
+    if (written.empty()) {
+        return;
+    }
+    CoapMessage message;
+    CHECK(decodeCoap(written, message));
+    message.raw = written;
+    requests.push_back(message);
+}
+
+void expectSocketOpen() {
+    ModemScript::expect("AT+QIOPEN=1,1,\"UDP\",\"", OK, {"\r\n+QIOPEN: 1,0\r\n"});
+}
+
+// AT+QISEND with the prompt, then SEND OK once the datagram is written; `answered` queues the
+// +QIURC recv notification for the reply the server sends back.
+void expectSend(bool answered) {
+    std::vector<std::string> urcs{"\r\nSEND OK\r\n"};
+    if (answered) {
+        urcs.push_back(RECV_URC);
+    }
+    ModemScript::expect("AT+QISEND=1,", "\r\n> ", urcs);
+}
+
+using ServerReply = std::function<std::string(const CoapMessage& request)>;
+
+// AT+QIRD returns the server's datagram as "+QIRD: <len>" and raw bytes; `more` announces
+// another datagram right behind it.
+void expectRead(ServerReply reply, bool more = false) {
+    ModemScript::expect("AT+QIRD=1,", [reply, more](const std::string&) {
+        captureRequest();
+        std::string datagram = reply(requests.back());
+        ModemScript::Reply answer{"\r\n+QIRD: " + std::to_string(datagram.size()) + "\r\n" + datagram + "\r\n" + OK, {}};
+        if (more) {
+            answer.urcs.push_back(RECV_URC);
+        }
+        return answer;
+    });
+}
+
+ServerReply piggybacked(uint8_t code) {
+    return [code](const CoapMessage& request) {
+        return encodeCoapReply(TYPE_ACK, code, request.messageId, request.token);
+    };
+}
+
+// ---- tests ----
+
+// Byte-exact request against the RFC 7252 section 3 layout: header, 4-byte token, then options
+// in ascending order with delta/length nibbles (13 = one extension byte, value - 13).
+void testSingleFixRequestBytes() {
+    static_assert(sizeof(AppConfig::GEO_SENSOR_ID) - 1 == 36, "vector below assumes a 36-char sensor id");
+    static_assert(sizeof(AppConfig::GEO_SENSOR_KEY) - 1 == 36, "vector below assumes a 36-char key");
+    ModemScript::reset();
+    requests.clear();
+    expectSocketOpen();
+    expectSend(true);
+    expectRead(piggybacked(CODE_CHANGED));
+    GpsFix fix = sampleFix(0);
+    bool encodeFailed = true;
+    CHECK(CoapClient::uploadBatch(&fix, 1, encodeFailed) == 1);
+    CHECK(!encodeFailed);
+    CHECK(ModemScript::finished());
+    CHECK(requests.size() == 1);
+    if (requests.size() != 1) {
+        return;
+    }
+    const CoapMessage& request = requests[0];
+    std::string expected;
+    expected += '\x44';  // ver 1, CON, TKL 4
+    expected += '\x02';  // 0.02 POST
+    expected += static_cast<char>(request.messageId >> 8);
+    expected += static_cast<char>(request.messageId & 0xFF);
+    expected += request.token;
+    expected += std::string("\xB6") + "device";           // Uri-Path (11), length 6
+    expected += std::string("\x09") + "geoSensor";        // delta 0, length 9
+    expected += std::string("\x0D\x17") + AppConfig::GEO_SENSOR_ID;  // length 13 + 23
+    expected += std::string("\x11\x3C");                  // Content-Format (12) = 60, application/cbor
+    expected += std::string("\x3D\x19") + "k=" + AppConfig::GEO_SENSOR_KEY;  // Uri-Query (15), length 13 + 25
+    expected += '\xFF';
+    uint8_t body[AppConfig::COAP_FIX_MAX_CBOR];
+    CborWriter writer(body, sizeof(body));
+    encodeGeoSensorCbor(writer, fix, "4g");
+    CHECK(writer.ok());
+    expected.append(reinterpret_cast<const char*>(body), writer.length());
+    CHECK(request.raw == expected);
+    CHECK(request.token.size() == 4);
+    CHECK(payloadMatches(request.payload, {fix}));
+    CHECK(optionValues(request, OPTION_BLOCK1).empty());
+}
+
+// RFC 7959 Block1: every block but the last carries M=1 and is answered 2.31 Continue; block
+// numbers count up from 0 with SZX = COAP_BLOCK_SZX, and the blocks reassemble into one CBOR array.
+void testBlockwiseBatch() {
+    std::vector<GpsFix> fixes;
+    for (int i = 0; i < AppConfig::COAP_BATCH_SIZE; ++i) {
+        fixes.push_back(worstCaseFix(i));
+    }
+    uint8_t probe[AppConfig::COAP_MAX_BODY];
+    CborWriter single(probe, sizeof(probe));
+    encodeGeoSensorCbor(single, fixes[0], "4g");
+    printf("worst-case fix CBOR: %zu bytes (COAP_FIX_MAX_CBOR %zu)\n", single.length(), AppConfig::COAP_FIX_MAX_CBOR);
+    CHECK(single.length() <= AppConfig::COAP_FIX_MAX_CBOR);
+
+    size_t blockSize = static_cast<size_t>(1) << (AppConfig::COAP_BLOCK_SZX + 4);
+    size_t expectedBlocks = (3 + fixes.size() * single.length() + blockSize - 1) / blockSize;
+    ModemScript::reset();
+    requests.clear();
+    for (size_t block = 0; block < expectedBlocks; ++block) {
+        expectSend(true);
+        expectRead(piggybacked(block + 1 < expectedBlocks ? CODE_CONTINUE : CODE_CHANGED));
+    }
+    bool encodeFailed = true;
+    CHECK(CoapClient::uploadBatch(fixes.data(), fixes.size(), encodeFailed) == fixes.size());
+    CHECK(!encodeFailed);
+    CHECK(ModemScript::finished());
+    CHECK(requests.size() == expectedBlocks);
+
+    std::string body;
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const CoapMessage& request = requests[i];
+        CHECK(request.type == TYPE_CON && request.code == CODE_POST);
+        CHECK(request.token == requests[0].token);
+        CHECK(request.messageId == static_cast<uint16_t>(requests[0].messageId + i));
+        std::vector<std::string> path = optionValues(request, OPTION_URI_PATH);
+        CHECK(path.size() == 4 && path[3] == "fixes");
+        CHECK(optionUint(optionValues(request, OPTION_CONTENT_FORMAT).at(0)) == 60);
+        CHECK(optionValues(request, OPTION_URI_QUERY).size() == 1);
+        std::vector<std::string> block1 = optionValues(request, OPTION_BLOCK1);
+        CHECK(block1.size() == 1);
+        uint32_t value = block1.empty() ? 0 : optionUint(block1[0]);
+        bool last = i + 1 == requests.size();
+        CHECK(value >> 4 == i);
+        CHECK(((value >> 3) & 1) == (last ? 0u : 1u));
+        CHECK((value & 7) == AppConfig::COAP_BLOCK_SZX);
+        CHECK(last ? request.payload.size() <= blockSize : request.payload.size() == blockSize);
+        body += request.payload;
+    }
+    // Block 0, M=1, SZX 4 is the one-byte option value 0x0C after a delta of 12 from Uri-Query.
+    if (!requests.empty() && AppConfig::COAP_BLOCK_SZX == 4) {
+        CHECK(optionValues(requests[0], OPTION_BLOCK1).at(0) == "\x0C");
+    }
+    CHECK(payloadMatches(body, fixes));
+}
+
+// More fixes than COAP_MAX_BODY holds: the longest prefix goes out, with an array header for
+// that prefix, and the count sent is returned.
+void testOversizedBatchSendsPrefix() {
+    std::vector<GpsFix> fixes;
+    for (int i = 0; i < AppConfig::COAP_BATCH_SIZE + 8; ++i) {
+        fixes.push_back(worstCaseFix(i));
+    }
+    ModemScript::reset();
+    requests.clear();
+    for (int block = 0; block < 16; ++block) {
+        expectSend(true);
+        expectRead([](const CoapMessage& request) {
+            uint32_t value = optionUint(optionValues(request, OPTION_BLOCK1).at(0));
+            return encodeCoapReply(TYPE_ACK, (value & 0x08) ? CODE_CONTINUE : CODE_CHANGED, request.messageId,
+                                   request.token);
+        });
+    }
+    bool encodeFailed = true;
+    size_t sent = CoapClient::uploadBatch(fixes.data(), fixes.size(), encodeFailed);
+    CHECK(!encodeFailed);
+    CHECK(sent >= AppConfig::COAP_BATCH_SIZE && sent < fixes.size());
+    std::string body;
+    for (const CoapMessage& request : requests) {
+        body += request.payload;
+    }
+    CHECK(payloadMatches(body, std::vector<GpsFix>(fixes.begin(), fixes.begin() + sent)));
+}
+
+// An empty ACK first, then the 2.04 as a separate CON response, which the client must ACK
+// with the server's message id (RFC 7252 section 5.2.2). A malformed datagram in between is ignored.
+void testSeparateResponse() {
+    ModemScript::reset();
+    requests.clear();
+    const uint16_t serverMessageId = 0xBEEF;
+    expectSend(true);
+    expectRead(
+        [](const CoapMessage& request) { return encodeCoapReply(TYPE_ACK, CODE_EMPTY, request.messageId, ""); },
+        true);
+    expectRead([](const CoapMessage&) { return std::string("\x01\x44\x00", 3); }, true);
+    expectRead([serverMessageId](const CoapMessage& request) {
+        return encodeCoapReply(TYPE_CON, CODE_CHANGED, serverMessageId, request.token);
+    });
+    expectSend(false);
+    GpsFix fix = sampleFix(3);
+    bool encodeFailed = true;
+    CHECK(CoapClient::uploadBatch(&fix, 1, encodeFailed) == 1);
+    CHECK(ModemScript::finished());
+    captureRequest();
+    CHECK(requests.size() == 2);
+    if (requests.size() == 2) {
+        const CoapMessage& ack = requests[1];
+        CHECK(ack.type == TYPE_ACK && ack.code == CODE_EMPTY && ack.messageId == serverMessageId);
+        CHECK(ack.token.empty() && ack.options.empty() && ack.payload.empty());
+    }
+}
+
+// RST or an error code fails the upload; RST also closes the socket, which the next upload reopens.
+void testRejectedUploads() {
+    ModemScript::reset();
+    requests.clear();
+    expectSend(true);
+    expectRead(piggybacked(0x80));  // 4.00 Bad Request
+    GpsFix fix = sampleFix(4);
+    bool encodeFailed = true;
+    CHECK(CoapClient::uploadBatch(&fix, 1, encodeFailed) == 0);
+    CHECK(!encodeFailed);
+    CHECK(ModemScript::finished());
+
+    ModemScript::reset();
+    expectSend(true);
+    expectRead([](const CoapMessage& request) { return encodeCoapReply(TYPE_RST, CODE_EMPTY, request.messageId, ""); });
+    ModemScript::expect("AT+QICLOSE=1", OK);
+    CHECK(CoapClient::uploadBatch(&fix, 1, encodeFailed) == 0);
+    CHECK(ModemScript::finished());
+
+    ModemScript::reset();
+    expectSocketOpen();
+    expectSend(true);
+    expectRead(piggybacked(CODE_CHANGED));
+    CHECK(CoapClient::uploadBatch(&fix, 1, encodeFailed) == 1);
+    CHECK(ModemScript::finished());
+}
+}  // namespace
+
+int main() {
+    testSingleFixRequestBytes();
+    testBlockwiseBatch();
+    testOversizedBatchSendsPrefix();
+    testSeparateResponse();
+    testRejectedUploads();
+    if (failures > 0) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include "modem_script.h"
+
+#include <HardwareSerial.h>
+
+#include <deque>
+
+#include "../ESP32-C3-TDM2421-4G-GPS/cellular/CellularClient.h"
+#include "../ESP32-C3-TDM2421-4G-GPS/logging/Log.h"
+#include "../ESP32-C3-TDM2421-4G-GPS/metrics/Metrics.h"
+#include "../ESP32-C3-TDM2421-4G-GPS/modem/ModemTask.h"
+
+HardwareSerial Serial0;
+
+namespace {
+
+struct Step {
+    std::string prefix;
+    ModemScript::Responder responder;
+};
+
+unsigned long clockMs = 0;
+uint32_t randomState = 1;
+uint32_t readyGeneration = 1;
+std::deque<Step> steps;
+std::vector<std::string> seenCommands;
+bool offScript = false;
+
+std::string answer(const std::string& command) {
+    seenCommands.push_back(command);
+    if (steps.empty() || command.compare(0, steps.front().prefix.size(), steps.front().prefix) != 0) {
+        printf("  unexpected command: %s\n", command.c_str());
+        offScript = true;
+        return "\r\nERROR\r\n";
+    }
+    ModemScript::Reply reply = steps.front().responder(command);
+    steps.pop_front();
+    for (const std::string& urc : reply.urcs) {
+        Serial0.urcs.push_back(urc);
+    }
+    return reply.response;
+}
+
+}  // namespace
+
+unsigned long millis() {
+    return clockMs;
+}
+
+void delay(unsigned long ms) {
+    clockMs += ms;
+    Serial0.releaseUrc();
+}
+
+uint32_t esp_random() {
+    randomState = randomState * 1103515245u + 12345u;
+    return randomState;
+}
+
+namespace Log {
+
+void write(Level, Category, const char*, ...) {}
+
+void writeDeferredPacked(Level, Category, const char*, const DeferredArg*, uint8_t) {}
+
+}  // namespace Log
+
+namespace Metrics {
+
+void increment(Counter) {}
+
+void observe(Histogram, uint32_t) {}
+
+}  // namespace Metrics
+
+namespace ModemTask {
+
+void yieldToUrgent() {}
+
+}  // namespace ModemTask
+
+namespace CellularClient {
+
+bool ensureReady() {
+    return true;
+}
+
+uint32_t readyGeneration() {
+    return ::readyGeneration;
+}
+
+}  // namespace CellularClient
+
+namespace ModemScript {
+
+void reset() {
+    steps.clear();
+    seenCommands.clear();
+    offScript = false;
+    Serial0.inbound.clear();
+    Serial0.urcs.clear();
+    Serial0.written.clear();
+    Serial0.onCommand = answer;
+}
+
+void expect(const std::string& prefix, const std::string& response, const std::vector<std::string>& urcs) {
+    Reply reply{response, urcs};
+    expect(prefix, [reply](const std::string&) { return reply; });
+}
+
+void expect(const std::string& prefix, Responder responder) {
+    steps.push_back(Step{prefix, responder});
+}
+
+bool finished() {
+    if (!steps.empty()) {
+        printf("  script step not reached: %s\n", steps.front().prefix.c_str());
+    }
+    return steps.empty() && !offScript;
+}
+
+const std::vector<std::string>& commands() {
+    return seenCommands;
+}
+
+std::string takeWritten() {
+    std::string written = Serial0.written;
+    Serial0.written.clear();
+    return written;
+}
+
+void reinitModem() {
+    ++readyGeneration;
+}
+
+}  // namespace ModemScript
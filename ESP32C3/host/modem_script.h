@@ -0,0 +1,34 @@
+#pragma once
+
+// Scripted modem for the host tests. Steps are answered strictly in order: a command must start
+// with the next step's prefix, gets that step's response at once, and queues the step's URCs
+// behind it. Anything else is recorded as unexpected and answered with ERROR.
+//
+// Linking this file also provides the firmware pieces the cellular clients call but that need
+// real hardware: Serial0, the virtual clock, Log, Metrics, ModemTask and CellularClient.
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ModemScript {
+
+struct Reply {
+    std::string response;
+    std::vector<std::string> urcs;
+};
+
+using Responder = std::function<Reply(const std::string& command)>;
+
+void reset();
+void expect(const std::string& prefix, const std::string& response, const std::vector<std::string>& urcs = {});
+void expect(const std::string& prefix, Responder responder);
+// True when every step was used and no command fell outside the script.
+bool finished();
+const std::vector<std::string>& commands();
+// Payload bytes the firmware wrote after a prompt since the last call.
+std::string takeWritten();
+// Stands in for CellularClient::ensureReady() running the full modem bring-up again.
+void reinitModem();
+
+}  // namespace ModemScript
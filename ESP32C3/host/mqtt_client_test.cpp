@@ -0,0 +1,244 @@
+// MqttClient host test: batch framing, the batch payload budget, and the QMTPUBEX result
+// codes and session recovery against a scripted modem.
+//
+// Build and run from ESP32C3:
+//   g++ -std=gnu++17 -O2 -Ihost host/mqtt_client_test.cpp host/modem_script.cpp ESP32-C3-TDM2421-4G-GPS/cellular/MqttClient.cpp ESP32-C3-TDM2421-4G-GPS/modem/ModemCommands.cpp ESP32-C3-TDM2421-4G-GPS/net/GeoPayload.cpp ESP32-C3-TDM2421-4G-GPS/net/CborWriter.cpp -o mqtt_client_test && ./mqtt_client_test
+//
+// Returns 0 when every check passes, otherwise prints the failures and returns 1.
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "../ESP32-C3-TDM2421-4G-GPS/cellular/MqttClient.h"
+#include "../ESP32-C3-TDM2421-4G-GPS/config/AppConfig.h"
+#include "../ESP32-C3-TDM2421-4G-GPS/modem/ModemCommands.h"
+#include "../ESP32-C3-TDM2421-4G-GPS/net/GeoPayload.h"
+#include "modem_script.h"
+
+namespace {
+int failures = 0;
+
+#define CHECK(condition)                                                \
+    do {                                                                \
+        if (!(condition)) {                                             \
+            printf("[FAIL] %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+const std::string OK = "\r\nOK\r\n";
+
+GpsFix sampleFix(int index) {
+    GpsFix fix;
+    fix.latitude = 31.2304f + index * 0.001f;
+    fix.longitude = 121.4737f - index * 0.001f;
+    fix.altitude = 12.5f;
+    fix.speed = 0.4f;
+    fix.satelliteCount = 9;
+    fix.dataAcquiredAt = "2026-10-19T08:00:00Z";
+    return fix;
+}
+
+// Longest JSON buildGeoSensorPayload() can produce: every number at its widest and a cell fix.
+GpsFix worstCaseFix() {
+    GpsFix fix;
+    fix.latitude = -89.999999f;
+    fix.longitude = -179.99999f;
+    fix.altitude = -99999.99f;
+    fix.speed = 99999.99f;
+    fix.satelliteCount = 255;
+    fix.dataAcquiredAt = "2026-10-19T08:00:00.000Z";
+    fix.source = PositionSource::Cell;
+    fix.accuracyMeters = 99999.0f;
+    return fix;
+}
+
+void expectSessionSetup() {
+    ModemScript::expect("AT+QMTCFG=\"version\",0,4", OK);
+    ModemScript::expect("AT+QMTCFG=\"pdpcid\",0,", OK);
+    ModemScript::expect("AT+QMTCFG=\"keepalive\",0,", OK);
+    ModemScript::expect("AT+QMTCFG=\"session\",0,0", OK);
+    ModemScript::expect("AT+QMTOPEN=0,", OK, {"\r\n+QMTOPEN: 0,0\r\n"});
+    ModemScript::expect("AT+QMTCONN=0,", OK, {"\r\n+QMTCONN: 0,0,0\r\n"});
+}
+
+void expectSessionClose() {
+    ModemScript::expect("AT+QMTDISC=0", OK);
+    ModemScript::expect("AT+QMTCLOSE=0", OK);
+}
+
+// Answers AT+QMTPUBEX=0,<msgid>,... with the prompt, then one +QMTPUBEX URC per result code
+// (1 carries the retransmission count), plus any extra URCs the modem sends afterwards.
+void expectPublish(const std::vector<int>& codes, const std::vector<std::string>& extraUrcs = {},
+                   std::string* commandSeen = nullptr) {
+    ModemScript::expect("AT+QMTPUBEX=0,", [codes, extraUrcs, commandSeen](const std::string& command) {
+        if (commandSeen != nullptr) {
+            *commandSeen = command;
+        }
+        size_t idStart = strlen("AT+QMTPUBEX=0,");
+        std::string messageId = command.substr(idStart, command.find(',', idStart) - idStart);
+        ModemScript::Reply reply{"\r\n> ", {}};
+        int retransmission = 0;
+        for (int code : codes) {
+            std::string urc = "\r\n+QMTPUBEX: 0," + messageId + "," + std::to_string(code);
+            if (code == 1) {
+                urc += "," + std::to_string(++retransmission);
+            }
+            reply.urcs.push_back(urc + "\r\n");
+        }
+        reply.urcs.insert(reply.urcs.end(), extraUrcs.begin(), extraUrcs.end());
+        return reply;
+    });
+}
+
+size_t publishedLength(const std::string& command) {
+    return strtoul(command.substr(command.rfind(',') + 1).c_str(), nullptr, 10);
+}
+
+// The session survives between tests, like it does between uploads; this one opens it.
+void testFirstPublishOpensSession() {
+    ModemScript::reset();
+    expectSessionSetup();
+    std::string command;
+    expectPublish({0}, {}, &command);
+    GpsFix fix = sampleFix(0);
+    CHECK(MqttClient::publish(fix));
+    CHECK(ModemScript::finished());
+    std::string expected = buildGeoSensorPayload(fix, "4g").c_str();
+    CHECK(ModemScript::takeWritten() == expected);
+    CHECK(command.find("\"device/geoSensor/" + std::string(AppConfig::GEO_SENSOR_ID) + "/fix\"") != std::string::npos);
+    CHECK(publishedLength(command) == expected.size());
+}
+
+void testBatchFraming() {
+    ModemScript::reset();
+    std::string command;
+    expectPublish({0}, {}, &command);
+    GpsFix fixes[] = {sampleFix(1), sampleFix(2), sampleFix(3)};
+    CHECK(MqttClient::publishBatch(fixes, 3));
+    CHECK(ModemScript::finished());
+    std::string expected = "[";
+    for (size_t i = 0; i < 3; ++i) {
+        expected += (i > 0 ? "," : "") + std::string(buildGeoSensorPayload(fixes[i], "4g").c_str());
+    }
+    expected += "]";
+    CHECK(ModemScript::takeWritten() == expected);
+    CHECK(command.find("/fixes\"") != std::string::npos);
+    CHECK(publishedLength(command) == expected.size());
+
+    // A batch of one goes out as a bare object on the live topic.
+    ModemScript::reset();
+    expectPublish({0}, {}, &command);
+    CHECK(MqttClient::publishBatch(fixes, 1));
+    CHECK(ModemScript::takeWritten() == std::string(buildGeoSensorPayload(fixes[0], "4g").c_str()));
+    CHECK(command.find("/fix\"") != std::string::npos);
+    CHECK(MqttClient::publishBatch(fixes, 0));
+    CHECK(ModemScript::finished());
+}
+
+void testBatchBudget() {
+    GpsFix worst = worstCaseFix();
+    size_t worstJson = buildGeoSensorPayload(worst, "4g").length();
+    printf("worst-case fix JSON: %zu bytes (MQTT_FIX_MAX_JSON %zu)\n", worstJson, AppConfig::MQTT_FIX_MAX_JSON);
+    CHECK(worstJson <= AppConfig::MQTT_FIX_MAX_JSON);
+
+    ModemScript::reset();
+    std::string command;
+    expectPublish({0}, {}, &command);
+    std::vector<GpsFix> batch(AppConfig::MQTT_BATCH_SIZE, worst);
+    CHECK(MqttClient::publishBatch(batch.data(), batch.size()));
+    CHECK(ModemScript::finished());
+    std::string payload = ModemScript::takeWritten();
+    printf("full worst-case batch: %zu bytes (MQTT_MAX_PAYLOAD %zu)\n", payload.size(), AppConfig::MQTT_MAX_PAYLOAD);
+    CHECK(payload.size() <= 2 + AppConfig::MQTT_BATCH_SIZE * (AppConfig::MQTT_FIX_MAX_JSON + 1));
+    CHECK(payload.size() <= AppConfig::MQTT_MAX_PAYLOAD);
+    CHECK(publishedLength(command) == payload.size());
+}
+
+// Result 1: the modem is retransmitting; the publish succeeds once a 0 follows.
+void testRetransmitThenAcknowledged() {
+    ModemScript::reset();
+    expectPublish({1, 1, 0});
+    CHECK(MqttClient::publish(sampleFix(4)));
+    CHECK(ModemScript::finished());
+
+    // More retransmissions than MQTT_PUBLISH_RETRANSMIT_WAITS: give up and drop the session.
+    ModemScript::reset();
+    expectPublish(std::vector<int>(AppConfig::MQTT_PUBLISH_RETRANSMIT_WAITS + 1, 1));
+    expectSessionClose();
+    CHECK(!MqttClient::publish(sampleFix(5)));
+    CHECK(ModemScript::finished());
+}
+
+// Result 2: the packet could not be sent; the session is closed and rebuilt by the next publish.
+void testPublishFailedReopensSession() {
+    ModemScript::reset();
+    expectSessionSetup();
+    expectPublish({2});
+    expectSessionClose();
+    CHECK(!MqttClient::publish(sampleFix(6)));
+    CHECK(ModemScript::finished());
+
+    ModemScript::reset();
+    expectSessionSetup();
+    expectPublish({0});
+    CHECK(MqttClient::publish(sampleFix(7)));
+    CHECK(ModemScript::finished());
+}
+
+// +QMTSTAT arrives unprompted when the broker drops the connection; the next publish must
+// reconnect first instead of failing a batch on the dead session.
+void testBrokerDropReconnectsBeforePublish() {
+    ModemScript::reset();
+    expectPublish({0}, {"\r\n+QMTSTAT: 0,1\r\n"});
+    CHECK(MqttClient::publish(sampleFix(8)));
+    // The URC is read by whatever modem command runs next.
+    ModemScript::expect("AT+CSQ", OK);
+    String response;
+    CHECK(sim_at_cmd_with_response("AT+CSQ", response, 1000));
+    CHECK(ModemScript::finished());
+
+    ModemScript::reset();
+    expectSessionClose();
+    expectSessionSetup();
+    expectPublish({0});
+    CHECK(MqttClient::publish(sampleFix(9)));
+    CHECK(ModemScript::finished());
+}
+
+// After a modem re-init the session is checked with AT+QMTCONN? before it is trusted.
+void testModemReinitChecksSession() {
+    ModemScript::reset();
+    ModemScript::reinitModem();
+    ModemScript::expect("AT+QMTCONN?", "\r\n+QMTCONN: 0,3\r\n" + OK);
+    expectPublish({0});
+    CHECK(MqttClient::publish(sampleFix(10)));
+    CHECK(ModemScript::finished());
+
+    ModemScript::reset();
+    ModemScript::reinitModem();
+    ModemScript::expect("AT+QMTCONN?", OK);
+    expectSessionClose();
+    expectSessionSetup();
+    expectPublish({0});
+    CHECK(MqttClient::publish(sampleFix(11)));
+    CHECK(ModemScript::finished());
+}
+}  // namespace
+
+int main() {
+    testFirstPublishOpensSession();
+    testBatchFraming();
+    testBatchBudget();
+    testRetransmitThenAcknowledged();
+    testPublishFailedReopensSession();
+    testBrokerDropReconnectsBeforePublish();
+    testModemReinitChecksSession();
+    if (failures > 0) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
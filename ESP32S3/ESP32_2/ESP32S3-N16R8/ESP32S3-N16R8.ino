@@ -4,20 +4,39 @@
 
 #include "config/Config.h"
 #include "collector/DataCollector.h"
+#include "collector/ChangeDetector.h"
+#include "collector/SensorRegistry.h"
+#include "collector/UltrasonicSensor.h"
+#include "collector/WindowAggregator.h"
+#include "memory/JsonArena.h"
+#include "storage/SummaryCodec.h"
 #include "storage/StorageManager.h"
 #include "time/TimeUtils.h"
 #include "upload/Uploader.h"
+#include "upload/UploadController.h"
 #include "network/WifiManager.h"
+#include "network/LiveStream.h"
+#include "pipeline/SampleRing.h"
+#include "pipeline/TimerWheel.h"
+#include "pipeline/Pipeline.h"
 
 // Arduino 构建系统不会自动编译子目录中的 .cpp 文件，将其直接包含进来
 #include "collector/DataCollector.cpp"
+#include "collector/ChangeDetector.cpp"
+#include "collector/SensorRegistry.cpp"
+#include "collector/UltrasonicSensor.cpp"
+#include "collector/WindowAggregator.cpp"
+#include "memory/JsonArena.cpp"
+#include "storage/SummaryCodec.cpp"
 #include "storage/StorageManager.cpp"
 #include "time/TimeUtils.cpp"
 #include "upload/Uploader.cpp"
+#include "upload/UploadController.cpp"
 #include "network/WifiManager.cpp"
-
-static unsigned long lastCollectTime = 0;
-static unsigned long lastUploadCheckTime = 0;
+#include "network/LiveStream.cpp"
+#include "pipeline/SampleRing.cpp"
+#include "pipeline/TimerWheel.cpp"
+#include "pipeline/Pipeline.cpp"
 
 void setup() {
   Serial.begin(115200);
@@ -27,6 +46,8 @@ void setup() {
   Serial.println("ESP32 数据收集与上传程序 (ESP32_2)");
   Serial.println("========================================\n");
 
+  beginJsonArena();
+
   Serial.println("[存储] 初始化 LittleFS 文件系统...");
   if (!LittleFS.begin(true)) {
     Serial.println("[错误] LittleFS 初始化失败");
@@ -44,6 +65,8 @@ void setup() {
     Serial.print(" KB, 可用: ");
     Serial.print(freeBytes / 1024.0, 2);
     Serial.println(" KB");
+
+    beginStorage();
   }
 
   int storedCount = getStoredDataCount();
@@ -55,6 +78,9 @@ void setup() {
     Serial.println("[存储] 无未上传的数据");
   }
 
+  beginTimeSync();
+  beginSensorRegistry();
+  beginUltrasonicSensors();
   loadStoredWiFiCredentials();
 
   Serial.println("[WiFi] 初始化 WiFi...");
@@ -73,27 +99,73 @@ void setup() {
     startConfigPortal();
   }
 
-  lastCollectTime = 0;
-  lastUploadCheckTime = 0;
-
   Serial.println("\n[系统] 初始化完成");
   Serial.println("[模式] 数据收集与智能上传模式：");
-  Serial.println("  ✓ 每5秒收集一条数据（模拟长度 + 日期时间含时区）");
+  Serial.print("  ✓ ");
+  Serial.print(SENSOR_COUNT);
+  Serial.print(" 个传感器由时间轮（刻度 ");
+  Serial.print(TIMER_WHEEL_TICK_MS);
+  Serial.print(" ms）调度，每个传感器每 ");
+  Serial.print(AGGREGATION_WINDOW_MS / 1000);
+  Serial.println(" 秒汇总为一条窗口摘要（最小/最大/均值/标准差/分位数）");
+  for (uint16_t i = 0; i < SENSOR_COUNT; i++) {
+    Serial.print("    - ");
+    Serial.print(SENSOR_TABLE[i].id);
+    Serial.print(": 每 ");
+    Serial.print(SENSOR_TABLE[i].sampleIntervalMs);
+    Serial.print(" ms 测距一次（");
+    Serial.print(ultrasonicSimulated(i) ? "模拟长度" : "超声波测距");
+    Serial.print("），上传到 ");
+    Serial.print(SENSOR_TABLE[i].endpoint);
+    Serial.println(SENSOR_TABLE[i].id);
+  }
+  Serial.println("  ✓ 只存储和上传窗口摘要，不上传原始读数");
+  if (CHANGE_REPORTING_ENABLED) {
+    Serial.print("  ✓ 变化上报：液位变化超过 ±");
+    Serial.print(CHANGE_DEADBAND_CM, 1);
+    Serial.print(" cm、窗口内出现越界波动或变化速率超过 ");
+    Serial.print(CHANGE_RATE_CM_PER_MIN, 1);
+    Serial.print(" cm/min 时上报，否则最长每 ");
+    Serial.print(CHANGE_HEARTBEAT_MS / 60000);
+    Serial.println(" 分钟上报一次心跳");
+  }
+  Serial.print("  ✓ 双核流水线：采集固定在核 ");
+  Serial.print(COLLECTOR_TASK_CORE);
+  Serial.print("，存储与上传固定在核 ");
+  Serial.print(UPLOAD_TASK_CORE);
+  Serial.println("，网络阻塞不影响采样节奏");
   Serial.println("  ✓ 智能上传策略：");
   Serial.println("    - 本地无待上传数据且网络正常 → 直接上传（不保存到本地）");
   Serial.println("    - 本地有待上传数据或网络不可用 → 保存到本地");
   Serial.println("    - 直接上传失败 → 自动保存到本地等待后续上传");
-  Serial.println("  ✓ 只要有网络且本地有数据，持续批量上传（不受5秒间隔限制）");
+  Serial.println("  ✓ 只要有网络且本地有数据，持续批量上传（不受窗口间隔限制）");
   Serial.println("  ✓ 严格 FIFO 顺序：先保存的数据先上传");
-  Serial.print("  ✓ 批量上传：每次上传 ");
-  Serial.print(BATCH_UPLOAD_SIZE);
-  Serial.println(" 条数据，提高上传效率");
-  Serial.println("  ✓ 上传成功后批量删除，失败则保留数据等待重试");
+  if (LIVE_STREAM_ENABLED) {
+    Serial.print("  ✓ 局域网实时数据流：");
+    Serial.print(LIVE_STREAM_PATH);
+    Serial.print(" 推送每条读数（Server-Sent Events，最多 ");
+    Serial.print(LIVE_STREAM_MAX_CLIENTS);
+    Serial.println(" 个客户端），跟不上的客户端降级为只推送窗口摘要");
+  }
+  if (BULK_UPLOAD_ENABLED) {
+    Serial.print("  ✓ 批量上传：每次最多 ");
+    Serial.print(BULK_UPLOAD_SIZE);
+    Serial.println(" 条数据，每个传感器一个请求（批量接口不可用时逐条上传）");
+    Serial.println("  ✓ 按服务器确认的前缀批量删除，未确认的数据保留等待重试");
+  } else {
+    Serial.print("  ✓ 批量上传：每次上传 ");
+    Serial.print(BATCH_UPLOAD_SIZE);
+    Serial.println(" 条数据，提高上传效率");
+    Serial.println("  ✓ 上传成功后批量删除，失败则保留数据等待重试");
+  }
+  if (UPLOAD_ADAPTIVE_ENABLED) {
+    Serial.println("  ✓ 上传速率自适应：按确认率与请求耗时调整批次大小与上传间隔（串口输入 upload 查看或修改）");
+  }
   Serial.print("[配置] API Key: ");
   Serial.println(API_KEY);
-  Serial.print("[配置] 传感器ID: ");
-  Serial.println(ULTRASONIC_SENSOR_ID);
   Serial.println("========================================\n");
+
+  startPipeline();
 }
 
 void loop() {
@@ -101,6 +173,8 @@ void loop() {
   ensureConfigAP();
 
   handleConfigServer();
+  serviceLiveStream();
+  serviceUploadConsole();
 
   if (configPortalActive) {
     if (CONFIG_PORTAL_TIMEOUT_MS > 0 &&
@@ -116,7 +190,12 @@ void loop() {
   static bool wasConnected = false;
   bool isConnected = (WiFi.status() == WL_CONNECTED);
 
+  // 重连不在这里等待结果：发起连接后下一轮 loop() 再检查，超时仍未连上才进入配置模式
+  static bool reconnecting = false;
+  static unsigned long lastReconnectAttempt = 0;
+
   if (isConnected && !wasConnected) {
+    reconnecting = false;
     Serial.println("\n[网络] WiFi 已恢复连接");
     announceConfigServerAddress();
     if (!timeSynced) {
@@ -125,104 +204,23 @@ void loop() {
   }
 
   if (!isConnected) {
-    static unsigned long lastReconnectAttempt = 0;
-    if (now - lastReconnectAttempt >= 10000) {
+    if (!reconnecting && now - lastReconnectAttempt >= WIFI_RECONNECT_INTERVAL_MS) {
       lastReconnectAttempt = now;
+      reconnecting = true;
       Serial.println("[WiFi] 连接断开，正在重连...");
-      if (!connectWiFi()) {
-        Serial.println("[WiFi] 无法重连，进入 Wi-Fi 配置模式");
-        startConfigPortal();
-      }
-      if (WiFi.status() == WL_CONNECTED && !timeSynced) {
-        syncNTPTime();
-      }
+      beginWiFiConnect();
+    } else if (reconnecting && now - lastReconnectAttempt >= WIFI_CONNECT_TIMEOUT_MS) {
+      reconnecting = false;
+      Serial.println("[WiFi] ✗ 无法重连，进入 Wi-Fi 配置模式");
+      startConfigPortal();
     }
   }
 
   wasConnected = isConnected;
 
-  if (isConnected && !isUploading) {
-    if (now - lastUploadCheckTime >= UPLOAD_CHECK_INTERVAL) {
-      lastUploadCheckTime = now;
-      uploadLocalData();
-    }
-  }
-
-  if (now - lastCollectTime >= COLLECT_INTERVAL) {
-    lastCollectTime = now;
-
-    float simulatedDistance = generateSimulatedDistance();
-
-    time_t currentTimestamp = getCurrentTimestamp();
-
-    if (isConnected && !timeSynced) {
-      syncNTPTime();
-      currentTimestamp = getCurrentTimestamp();
-    }
-
-    Serial.print("\n[收集] 距离: ");
-    Serial.print(simulatedDistance, 2);
-    Serial.print(" cm");
-    if (currentTimestamp > 0) {
-      Serial.print(", 时间: ");
-      Serial.print(formatDateTime(currentTimestamp));
-    } else {
-      Serial.print(", 时间: (未同步)");
-    }
-
-    int storedCount = getStoredDataCount();
-    bool hasPendingData = (storedCount > 0);
-
-    if (!hasPendingData && isConnected && !isUploading) {
-      Serial.print(" | 本地无待上传数据，尝试直接上传...");
-
-      if (uploadSingleData(simulatedDistance, currentTimestamp)) {
-        Serial.println(" ✓ 直接上传成功（未保存到本地）");
-      } else {
-        Serial.print(" ✗ 直接上传失败，保存到本地");
-        if (saveDataToStorage(simulatedDistance, currentTimestamp)) {
-          Serial.print(" ✓ 已保存");
-          Serial.print(" (本地共 ");
-          Serial.print(getStoredDataCount());
-          Serial.print(" 条)");
-        } else {
-          Serial.print(" ✗ 保存失败");
-        }
-        Serial.println();
-      }
-    } else {
-      if (hasPendingData) {
-        Serial.print(" | 本地有待上传数据，保存到本地");
-      } else if (!isConnected) {
-        Serial.print(" | 网络不可用，保存到本地");
-      } else {
-        Serial.print(" | 上传进行中，保存到本地");
-      }
-
-      if (saveDataToStorage(simulatedDistance, currentTimestamp)) {
-        Serial.print(" ✓ 已保存");
-        Serial.print(" (本地共 ");
-        Serial.print(getStoredDataCount());
-        Serial.print(" 条)");
-      } else {
-        Serial.print(" ✗ 保存失败");
-      }
-      Serial.println();
-    }
-
-    static int collectCount = 0;
-    collectCount++;
-    if (collectCount % 20 == 0) {
-      int currentStoredCount = getStoredDataCount();
-      Serial.print("\n[统计] 已收集 ");
-      Serial.print(collectCount);
-      Serial.print(" 条数据，本地存储: ");
-      Serial.print(currentStoredCount);
-      Serial.println(" 条");
-    }
-  }
+  // 采集与上传都在流水线任务中进行，这里只负责网络维护；NTP 在后台同步，失败时自行重试
+  serviceTimeSync();
 
   delay(50);
   yield();
 }
-
@@ -0,0 +1,111 @@
+#include "ChangeDetector.h"
+
+namespace {
+struct ChangeState {
+  bool reported;
+  float referenceCm;  // 上次上报窗口的均值
+  int64_t reportedAtUs;
+  bool hasPrevious;
+  float previousMeanCm;
+  int64_t previousAtUs;
+  uint32_t belowBand;  // 当前窗口中低于死区的读数
+  uint32_t aboveBand;  // 当前窗口中高于死区的读数
+};
+
+ChangeState changeStates[SENSOR_COUNT];
+ChangeReportStats changeStats = {};
+
+ChangeTrigger classifyWindow(const ChangeState& state, const WindowAccumulator& window) {
+  if (!CHANGE_REPORTING_ENABLED) {
+    return CHANGE_TRIGGER_PERIODIC;
+  }
+  if (!state.reported) {
+    return CHANGE_TRIGGER_FIRST;
+  }
+
+  uint32_t outside = state.belowBand > state.aboveBand ? state.belowBand : state.aboveBand;
+  if (outside * 2 > window.count) {
+    return CHANGE_TRIGGER_DEADBAND;
+  }
+
+  uint32_t excursionMin = (uint32_t)(window.count * CHANGE_EXCURSION_FRACTION);
+  if (excursionMin < CHANGE_EXCURSION_MIN_READINGS) {
+    excursionMin = CHANGE_EXCURSION_MIN_READINGS;
+  }
+  if (state.belowBand >= excursionMin || state.aboveBand >= excursionMin) {
+    return CHANGE_TRIGGER_EXCURSION;
+  }
+
+  if (state.hasPrevious && window.lastAtUs > state.previousAtUs) {
+    float minutes = (window.lastAtUs - state.previousAtUs) / 60000000.0f;
+    float rate = fabsf((float)window.mean - state.previousMeanCm) / minutes;
+    if (rate >= CHANGE_RATE_CM_PER_MIN) {
+      return CHANGE_TRIGGER_RATE;
+    }
+  }
+
+  if (window.lastAtUs - state.reportedAtUs >= (int64_t)CHANGE_HEARTBEAT_MS * 1000LL) {
+    return CHANGE_TRIGGER_HEARTBEAT;
+  }
+  return CHANGE_TRIGGER_NONE;
+}
+}  // namespace
+
+void resetChangeDetector(uint16_t sensor) {
+  if (sensor < SENSOR_COUNT) {
+    changeStates[sensor] = {};
+  }
+}
+
+void noteReadingForChange(uint16_t sensor, float distanceCm) {
+  if (sensor >= SENSOR_COUNT) {
+    return;
+  }
+  ChangeState& state = changeStates[sensor];
+  if (!state.reported) {
+    return;
+  }
+  if (distanceCm < state.referenceCm - CHANGE_DEADBAND_CM) {
+    state.belowBand++;
+  } else if (distanceCm > state.referenceCm + CHANGE_DEADBAND_CM) {
+    state.aboveBand++;
+  }
+}
+
+ChangeTrigger evaluateWindowChange(uint16_t sensor, const WindowAccumulator& window) {
+  if (sensor >= SENSOR_COUNT || window.count == 0) {
+    return CHANGE_TRIGGER_NONE;
+  }
+  ChangeState& state = changeStates[sensor];
+  ChangeTrigger trigger = classifyWindow(state, window);
+
+  if (trigger != CHANGE_TRIGGER_NONE) {
+    state.reported = true;
+    state.referenceCm = (float)window.mean;
+    state.reportedAtUs = window.lastAtUs;
+  }
+  state.hasPrevious = true;
+  state.previousMeanCm = (float)window.mean;
+  state.previousAtUs = window.lastAtUs;
+  state.belowBand = 0;
+  state.aboveBand = 0;
+  changeStats.reported[trigger]++;
+  return trigger;
+}
+
+const char* changeTriggerName(ChangeTrigger trigger) {
+  switch (trigger) {
+    case CHANGE_TRIGGER_NONE: return "抑制";
+    case CHANGE_TRIGGER_PERIODIC: return "定期";
+    case CHANGE_TRIGGER_FIRST: return "首次";
+    case CHANGE_TRIGGER_DEADBAND: return "死区";
+    case CHANGE_TRIGGER_EXCURSION: return "越界";
+    case CHANGE_TRIGGER_RATE: return "速率";
+    case CHANGE_TRIGGER_HEARTBEAT: return "心跳";
+    default: return "?";
+  }
+}
+
+ChangeReportStats getChangeReportStats() {
+  return changeStats;
+}
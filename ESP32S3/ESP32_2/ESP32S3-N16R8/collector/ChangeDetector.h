@@ -0,0 +1,36 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "WindowAggregator.h"
+
+// 变化上报：液位长时间不变时，每个窗口都上报同一个值没有意义。每个传感器记住上次上报的窗口，
+// 新窗口只在以下情况之一成立时上报，其余窗口在采集端直接丢弃（不存储、不上传）：
+//   - 死区：窗口内超过一半的读数落在上次上报均值 ± CHANGE_DEADBAND_CM 之外（即中位数越出死区）；
+//   - 越界：窗口内至少 CHANGE_EXCURSION_FRACTION 的读数越出死区，短暂的液位波动也不会丢失；
+//   - 速率：与上一个窗口相比，均值的变化速率超过 CHANGE_RATE_CM_PER_MIN；
+//   - 心跳：距上次上报已超过 CHANGE_HEARTBEAT_MS，服务器据此确认传感器在线。
+// 判断基于逐条读数的精确计数与均值，不受分位数草图误差的影响。
+
+enum ChangeTrigger : uint8_t {
+  CHANGE_TRIGGER_NONE,      // 抑制，不上报
+  CHANGE_TRIGGER_PERIODIC,  // 未启用变化上报，每个窗口都上报
+  CHANGE_TRIGGER_FIRST,     // 启动后的第一个窗口
+  CHANGE_TRIGGER_DEADBAND,
+  CHANGE_TRIGGER_EXCURSION,
+  CHANGE_TRIGGER_RATE,
+  CHANGE_TRIGGER_HEARTBEAT,
+  CHANGE_TRIGGER_COUNT,
+};
+
+struct ChangeReportStats {
+  uint32_t reported[CHANGE_TRIGGER_COUNT];  // 按触发原因计数，下标 CHANGE_TRIGGER_NONE 为抑制的窗口数
+};
+
+void resetChangeDetector(uint16_t sensor);
+// 采集任务对每条读数调用，统计越出死区的读数
+void noteReadingForChange(uint16_t sensor, float distanceCm);
+// 窗口结束时调用，返回上报原因；CHANGE_TRIGGER_NONE 表示该窗口应被抑制
+ChangeTrigger evaluateWindowChange(uint16_t sensor, const WindowAccumulator& window);
+const char* changeTriggerName(ChangeTrigger trigger);
+ChangeReportStats getChangeReportStats();
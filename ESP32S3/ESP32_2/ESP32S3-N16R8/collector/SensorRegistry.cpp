@@ -0,0 +1,56 @@
+#include "SensorRegistry.h"
+
+namespace {
+uint16_t sensorKeys[SENSOR_COUNT];
+
+// FNV-1a 32 位哈希折叠为 16 位，0 留给旧版数据
+constexpr uint16_t hashSensorId(const char* id) {
+  uint32_t hash = 2166136261UL;
+  for (const char* p = id; *p; p++) {
+    hash ^= (uint8_t)*p;
+    hash *= 16777619UL;
+  }
+  uint16_t key = (uint16_t)(hash ^ (hash >> 16));
+  return key == 0 ? 1 : key;
+}
+
+constexpr bool sensorKeysUnique() {
+  for (uint16_t i = 0; i < SENSOR_COUNT; i++) {
+    for (uint16_t j = 0; j < i; j++) {
+      if (hashSensorId(SENSOR_TABLE[i].id) == hashSensorId(SENSOR_TABLE[j].id)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// 存储记录只带 16 位键，两个传感器同键时数据会被上传到另一个传感器名下，因此在编译期拒绝
+static_assert(sensorKeysUnique(), "SENSOR_TABLE 中有传感器的存储键冲突（ID 重复或哈希碰撞），请修改传感器 ID");
+}  // namespace
+
+void beginSensorRegistry() {
+  for (uint16_t i = 0; i < SENSOR_COUNT; i++) {
+    sensorKeys[i] = hashSensorId(SENSOR_TABLE[i].id);
+  }
+
+  Serial.print("[传感器] 已注册 ");
+  Serial.print(SENSOR_COUNT);
+  Serial.println(" 个传感器");
+}
+
+uint16_t sensorKey(uint16_t sensor) {
+  return sensor < SENSOR_COUNT ? sensorKeys[sensor] : 0;
+}
+
+int findSensorByKey(uint16_t key) {
+  if (key == 0) {
+    return 0;
+  }
+  for (uint16_t i = 0; i < SENSOR_COUNT; i++) {
+    if (sensorKeys[i] == key) {
+      return i;
+    }
+  }
+  return -1;
+}
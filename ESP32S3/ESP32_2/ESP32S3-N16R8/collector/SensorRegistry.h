@@ -0,0 +1,14 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "../config/Config.h"
+
+// 传感器注册表：SENSOR_TABLE 中的下标即运行时的传感器编号。
+// 存储与上传使用由传感器 ID 算出的 16 位键，固件更新调整注册表顺序后，
+// 已存储的数据仍能找到对应的传感器。键 0 表示旧版本固件存下的数据，归第一个传感器。
+// 键在编译期检查唯一，冲突时编译失败。
+
+void beginSensorRegistry();
+uint16_t sensorKey(uint16_t sensor);
+int findSensorByKey(uint16_t key);
@@ -0,0 +1,302 @@
+#include "UltrasonicSensor.h"
+
+#include <esp_idf_version.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+#include "../config/Config.h"
+#include "DataCollector.h"
+
+// IDF 5.1 起使用新版 MCPWM 捕获驱动，由硬件锁存边沿时刻；更早的内核退回到 GPIO 边沿中断 + esp_timer
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+#define ULTRASONIC_USE_MCPWM_CAPTURE 1
+#include <driver/mcpwm_cap.h>
+#include <soc/soc_caps.h>
+#else
+#define ULTRASONIC_USE_MCPWM_CAPTURE 0
+#endif
+
+namespace {
+// 中断送往任务的原始结果，脉宽到距离的换算放在任务中进行
+struct EchoEvent {
+  uint16_t sensor;
+  int64_t triggeredAtUs;
+  uint32_t pulseUs;
+};
+
+// 每个传感器一个通道；进行中的测量状态由任务写入、中断读取
+struct EchoChannel {
+  uint16_t sensor;
+  bool hardware;
+  bool hardwareCapture;
+  volatile bool inFlight;
+  volatile int64_t triggeredAtUs;
+  volatile bool rising;
+  volatile uint32_t risingCapture;
+  volatile int64_t risingAtUs;
+};
+
+EchoChannel echoChannels[SENSOR_COUNT];
+QueueHandle_t echoQueue = nullptr;
+portMUX_TYPE echoLock = portMUX_INITIALIZER_UNLOCKED;
+
+UltrasonicStats sensorStats = {0, 0, 0};
+
+// 声速随气温变化，按 ULTRASONIC_AIR_TEMP_C 修正
+float speedOfSoundCmPerUs() {
+  return (331.3f + 0.606f * ULTRASONIC_AIR_TEMP_C) / 10000.0f;
+}
+
+void IRAM_ATTR completeEchoFromISR(EchoChannel& channel, uint32_t pulseUs) {
+  portENTER_CRITICAL_ISR(&echoLock);
+  bool pending = channel.inFlight;
+  int64_t triggeredAtUs = channel.triggeredAtUs;
+  channel.inFlight = false;
+  portEXIT_CRITICAL_ISR(&echoLock);
+
+  // 超时后才到达的迟到回波直接丢弃
+  if (!pending) {
+    return;
+  }
+  EchoEvent event = {channel.sensor, triggeredAtUs, pulseUs};
+  BaseType_t woken = pdFALSE;
+  xQueueSendFromISR(echoQueue, &event, &woken);
+  if (woken == pdTRUE) {
+    portYIELD_FROM_ISR();
+  }
+}
+
+// 每次测量只有一个上升沿和一个下降沿，按顺序区分，无需在中断中读取引脚电平
+void IRAM_ATTR onEchoEdge(void* arg) {
+  EchoChannel& channel = *(EchoChannel*)arg;
+  int64_t nowUs = esp_timer_get_time();
+  if (!channel.inFlight) {
+    return;
+  }
+  if (!channel.rising) {
+    channel.risingAtUs = nowUs;
+    channel.rising = true;
+  } else {
+    channel.rising = false;
+    completeEchoFromISR(channel, (uint32_t)(nowUs - channel.risingAtUs));
+  }
+}
+
+bool beginEdgeInterrupt(EchoChannel& channel, int echoPin) {
+  pinMode(echoPin, INPUT);
+  attachInterruptArg(digitalPinToInterrupt(echoPin), onEchoEdge, &channel, CHANGE);
+  return true;
+}
+
+#if ULTRASONIC_USE_MCPWM_CAPTURE
+// 每个 MCPWM 组有一个捕获定时器和 SOC_MCPWM_CAPTURE_CHANNELS_PER_TIMER 个捕获通道
+constexpr int CAPTURE_CHANNEL_LIMIT = SOC_MCPWM_GROUPS * SOC_MCPWM_CAPTURE_CHANNELS_PER_TIMER;
+mcpwm_cap_timer_handle_t captureTimers[SOC_MCPWM_GROUPS] = {};
+int captureChannelsUsed = 0;
+uint32_t captureTicksPerUs = 80;
+
+bool IRAM_ATTR onEchoCapture(mcpwm_cap_channel_handle_t, const mcpwm_capture_event_data_t* edata, void* arg) {
+  EchoChannel& channel = *(EchoChannel*)arg;
+  if (edata->cap_edge == MCPWM_CAP_EDGE_POS) {
+    channel.risingCapture = edata->cap_value;
+    channel.rising = true;
+  } else if (channel.rising) {
+    channel.rising = false;
+    completeEchoFromISR(channel, (edata->cap_value - channel.risingCapture) / captureTicksPerUs);
+  }
+  return false;
+}
+
+bool beginCaptureChannel(EchoChannel& channel, int echoPin) {
+  if (captureChannelsUsed >= CAPTURE_CHANNEL_LIMIT) {
+    return false;
+  }
+  int group = captureChannelsUsed / SOC_MCPWM_CAPTURE_CHANNELS_PER_TIMER;
+  if (!captureTimers[group]) {
+    mcpwm_capture_timer_config_t timerConfig = {};
+    timerConfig.group_id = group;
+    timerConfig.clk_src = MCPWM_CAPTURE_CLK_SRC_DEFAULT;
+    if (mcpwm_new_capture_timer(&timerConfig, &captureTimers[group]) != ESP_OK) {
+      captureTimers[group] = nullptr;
+      return false;
+    }
+  }
+
+  mcpwm_cap_channel_handle_t captureChannel = nullptr;
+  mcpwm_capture_channel_config_t channelConfig = {};
+  channelConfig.gpio_num = echoPin;
+  channelConfig.prescale = 1;
+  channelConfig.flags.pos_edge = true;
+  channelConfig.flags.neg_edge = true;
+  if (mcpwm_new_capture_channel(captureTimers[group], &channelConfig, &captureChannel) != ESP_OK) {
+    return false;
+  }
+  mcpwm_capture_event_callbacks_t callbacks = {};
+  callbacks.on_cap = onEchoCapture;
+  if (mcpwm_capture_channel_register_event_callbacks(captureChannel, &callbacks, &channel) != ESP_OK ||
+      mcpwm_capture_channel_enable(captureChannel) != ESP_OK) {
+    return false;
+  }
+  captureChannelsUsed++;
+  return true;
+}
+
+// 所有捕获通道创建完成后再启动各组的定时器
+bool startCaptureTimers() {
+  for (int group = 0; group < SOC_MCPWM_GROUPS; group++) {
+    if (!captureTimers[group]) {
+      continue;
+    }
+    uint32_t resolutionHz = 0;
+    if (mcpwm_capture_timer_enable(captureTimers[group]) != ESP_OK ||
+        mcpwm_capture_timer_get_resolution(captureTimers[group], &resolutionHz) != ESP_OK ||
+        mcpwm_capture_timer_start(captureTimers[group]) != ESP_OK || resolutionHz < 1000000) {
+      return false;
+    }
+    captureTicksPerUs = resolutionHz / 1000000;
+  }
+  return true;
+}
+#else
+bool beginCaptureChannel(EchoChannel&, int) {
+  return false;
+}
+
+bool startCaptureTimers() {
+  return true;
+}
+#endif
+
+// 模拟后端：按模拟距离反推回波脉宽，与真实传感器走同一条换算路径
+void simulateEcho(EchoChannel& channel, int64_t triggeredAtUs) {
+  float distanceCm = generateSimulatedDistance();
+  EchoEvent event = {channel.sensor, triggeredAtUs, (uint32_t)lroundf(distanceCm * 2.0f / speedOfSoundCmPerUs())};
+  channel.inFlight = false;
+  xQueueSend(echoQueue, &event, 0);
+}
+}  // namespace
+
+bool beginUltrasonicSensors() {
+  if (echoQueue) {
+    return true;
+  }
+  echoQueue = xQueueCreate(ULTRASONIC_QUEUE_LENGTH, sizeof(EchoEvent));
+  if (!echoQueue) {
+    Serial.println("[测距] ✗ 无法创建回波队列");
+    return false;
+  }
+
+  bool ok = true;
+  int captureCount = 0;
+  int interruptCount = 0;
+  int simulatedCount = 0;
+  for (uint16_t i = 0; i < SENSOR_COUNT; i++) {
+    const SensorConfig& config = SENSOR_TABLE[i];
+    EchoChannel& channel = echoChannels[i];
+    channel.sensor = i;
+    channel.hardware = config.driver == SENSOR_DRIVER_ULTRASONIC && config.trigPin >= 0 && config.echoPin >= 0;
+    if (!channel.hardware) {
+      simulatedCount++;
+      continue;
+    }
+
+    pinMode(config.trigPin, OUTPUT);
+    digitalWrite(config.trigPin, LOW);
+    channel.hardwareCapture = beginCaptureChannel(channel, config.echoPin);
+    if (channel.hardwareCapture) {
+      captureCount++;
+    } else {
+      beginEdgeInterrupt(channel, config.echoPin);
+      interruptCount++;
+    }
+  }
+
+  if (!startCaptureTimers()) {
+    Serial.println("[测距] ✗ MCPWM 捕获定时器启动失败");
+    ok = false;
+  }
+
+  Serial.print("[测距] 超声波通道: MCPWM 硬件捕获 ");
+  Serial.print(captureCount);
+  Serial.print(" 个，GPIO 边沿中断 ");
+  Serial.print(interruptCount);
+  Serial.print(" 个，模拟 ");
+  Serial.print(simulatedCount);
+  Serial.println(" 个");
+  return ok;
+}
+
+bool ultrasonicSimulated(uint16_t sensor) {
+  return sensor >= SENSOR_COUNT || !echoChannels[sensor].hardware;
+}
+
+// 发出触发脉冲后立即返回；该通道上一次测量尚未结束（未回波也未超时）时返回 false
+bool triggerDistanceMeasurement(uint16_t sensor) {
+  if (!echoQueue || sensor >= SENSOR_COUNT) {
+    return false;
+  }
+  EchoChannel& channel = echoChannels[sensor];
+
+  int64_t nowUs = esp_timer_get_time();
+  portENTER_CRITICAL(&echoLock);
+  bool busy = channel.inFlight && nowUs - channel.triggeredAtUs < (int64_t)ULTRASONIC_ECHO_TIMEOUT_US;
+  bool timedOut = channel.inFlight && !busy;
+  if (!busy) {
+    channel.inFlight = true;
+    channel.triggeredAtUs = nowUs;
+    channel.rising = false;
+  }
+  portEXIT_CRITICAL(&echoLock);
+
+  if (timedOut) {
+    sensorStats.timeouts++;
+  }
+  if (busy) {
+    return false;
+  }
+
+  if (!channel.hardware) {
+    simulateEcho(channel, nowUs);
+    return true;
+  }
+
+  int trigPin = SENSOR_TABLE[sensor].trigPin;
+  digitalWrite(trigPin, HIGH);
+  delayMicroseconds(10);
+  digitalWrite(trigPin, LOW);
+  return true;
+}
+
+// 在 waitMs 内等待任一通道的测量结果；超出量程时返回 false 并计数
+bool readDistance(DistanceReading& reading, uint32_t waitMs) {
+  if (!echoQueue) {
+    return false;
+  }
+
+  EchoEvent event;
+  if (xQueueReceive(echoQueue, &event, pdMS_TO_TICKS(waitMs)) != pdTRUE) {
+    return false;
+  }
+
+  float distanceCm = pulseWidthToDistanceCm(event.pulseUs);
+  if (distanceCm < ULTRASONIC_MIN_CM || distanceCm > ULTRASONIC_MAX_CM) {
+    sensorStats.outOfRange++;
+    return false;
+  }
+
+  sensorStats.measurements++;
+  reading.sensor = event.sensor;
+  reading.distanceCm = distanceCm;
+  reading.capturedAtUs = event.triggeredAtUs;
+  return true;
+}
+
+// 回波脉宽为声波往返时间
+float pulseWidthToDistanceCm(uint32_t pulseUs) {
+  return pulseUs * speedOfSoundCmPerUs() / 2.0f;
+}
+
+UltrasonicStats getUltrasonicStats() {
+  return sensorStats;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <Arduino.h>
+
+// 非阻塞超声波测距驱动（HC-SR04 类），注册表中每个超声波传感器一个通道：
+//   triggerDistanceMeasurement() 发出 10 us 触发脉冲后立即返回；
+//   回波脉宽由硬件捕获（MCPWM 捕获，通道用完或旧版内核退回到 GPIO 边沿中断）在中断中测得，
+//   所有通道的结果送入同一个队列；readDistance() 从队列取结果，等待期间任务挂起，不占用 CPU。
+// 未配置引脚或注册为模拟驱动的传感器使用模拟后端，结果同样经由队列返回。
+
+struct DistanceReading {
+  uint16_t sensor;       // 注册表中的传感器编号
+  float distanceCm;
+  int64_t capturedAtUs;  // 触发时刻（esp_timer 单调时间）
+};
+
+struct UltrasonicStats {
+  uint32_t measurements;
+  uint32_t timeouts;
+  uint32_t outOfRange;
+};
+
+bool beginUltrasonicSensors();
+bool ultrasonicSimulated(uint16_t sensor);
+bool triggerDistanceMeasurement(uint16_t sensor);
+bool readDistance(DistanceReading& reading, uint32_t waitMs);
+float pulseWidthToDistanceCm(uint32_t pulseUs);
+UltrasonicStats getUltrasonicStats();
@@ -0,0 +1,150 @@
+#include "WindowAggregator.h"
+
+#include <math.h>
+
+#include "../time/TimeUtils.h"
+
+namespace {
+// 第 i 个桶覆盖 (base × γ^(i-1), base × γ^i]，γ = (1 + α) / (1 - α)，
+// 取桶的"中点" 2 × base × γ^i / (γ + 1) 作为估计值，相对误差不超过 α
+const float sketchGamma = (1.0f + QUANTILE_SKETCH_ACCURACY) / (1.0f - QUANTILE_SKETCH_ACCURACY);
+const float sketchLogGamma = logf(sketchGamma);
+constexpr float SKETCH_BASE_VALUE = ULTRASONIC_MIN_CM;
+
+uint32_t sketchBucket(float value) {
+  if (!(value > SKETCH_BASE_VALUE)) {
+    return 0;
+  }
+  float index = ceilf(logf(value / SKETCH_BASE_VALUE) / sketchLogGamma);
+  return index >= QUANTILE_SKETCH_BUCKETS - 1 ? QUANTILE_SKETCH_BUCKETS - 1 : (uint32_t)index;
+}
+
+float sketchBucketValue(uint32_t bucket) {
+  if (bucket == 0) {
+    return SKETCH_BASE_VALUE;
+  }
+  return 2.0f * SKETCH_BASE_VALUE * expf(bucket * sketchLogGamma) / (sketchGamma + 1.0f);
+}
+
+float clampToRange(float value, float low, float high) {
+  return value < low ? low : (value > high ? high : value);
+}
+}  // namespace
+
+void resetQuantileSketch(QuantileSketch& sketch) {
+  memset(&sketch, 0, sizeof(sketch));
+}
+
+void addToQuantileSketch(QuantileSketch& sketch, float value) {
+  sketch.counts[sketchBucket(value)]++;
+  sketch.total++;
+}
+
+void mergeQuantileSketch(QuantileSketch& into, const QuantileSketch& from) {
+  for (uint32_t i = 0; i < QUANTILE_SKETCH_BUCKETS; i++) {
+    into.counts[i] += from.counts[i];
+  }
+  into.total += from.total;
+}
+
+float quantileFromSketch(const QuantileSketch& sketch, float q) {
+  if (sketch.total == 0) {
+    return 0.0f;
+  }
+  // 排名为 q × (n - 1) 的读数所在的桶
+  uint32_t rank = (uint32_t)(clampToRange(q, 0.0f, 1.0f) * (sketch.total - 1));
+  uint32_t seen = 0;
+  for (uint32_t i = 0; i < QUANTILE_SKETCH_BUCKETS; i++) {
+    seen += sketch.counts[i];
+    if (seen > rank) {
+      return sketchBucketValue(i);
+    }
+  }
+  return sketchBucketValue(QUANTILE_SKETCH_BUCKETS - 1);
+}
+
+void resetWindow(WindowAccumulator& window) {
+  window.count = 0;
+  window.mean = 0.0;
+  window.m2 = 0.0;
+  window.minCm = 0.0f;
+  window.maxCm = 0.0f;
+  window.firstAtUs = 0;
+  window.lastAtUs = 0;
+  resetQuantileSketch(window.sketch);
+}
+
+void addToWindow(WindowAccumulator& window, float distanceCm, int64_t capturedAtUs) {
+  if (window.count == 0) {
+    window.minCm = distanceCm;
+    window.maxCm = distanceCm;
+    window.firstAtUs = capturedAtUs;
+  } else {
+    window.minCm = distanceCm < window.minCm ? distanceCm : window.minCm;
+    window.maxCm = distanceCm > window.maxCm ? distanceCm : window.maxCm;
+  }
+  window.lastAtUs = capturedAtUs;
+
+  window.count++;
+  double delta = distanceCm - window.mean;
+  window.mean += delta / window.count;
+  window.m2 += delta * (distanceCm - window.mean);
+
+  addToQuantileSketch(window.sketch, distanceCm);
+}
+
+// 按 Chan 等人的并行公式合并两个窗口的均值与方差
+void mergeWindow(WindowAccumulator& into, const WindowAccumulator& from) {
+  if (from.count == 0) {
+    return;
+  }
+  if (into.count == 0) {
+    into = from;
+    return;
+  }
+
+  uint32_t total = into.count + from.count;
+  double delta = from.mean - into.mean;
+  into.m2 += from.m2 + delta * delta * ((double)into.count * from.count / total);
+  into.mean += delta * from.count / total;
+  into.count = total;
+  into.minCm = from.minCm < into.minCm ? from.minCm : into.minCm;
+  into.maxCm = from.maxCm > into.maxCm ? from.maxCm : into.maxCm;
+  into.firstAtUs = from.firstAtUs < into.firstAtUs ? from.firstAtUs : into.firstAtUs;
+  into.lastAtUs = from.lastAtUs > into.lastAtUs ? from.lastAtUs : into.lastAtUs;
+  mergeQuantileSketch(into.sketch, from.sketch);
+}
+
+WindowSummary summarizeWindow(const WindowAccumulator& window, uint16_t sensorKey) {
+  WindowSummary summary;
+  summary.timestamp = timestampFromMonotonic(window.lastAtUs);
+  summary.spanMs = (uint32_t)((window.lastAtUs - window.firstAtUs) / 1000);
+  summary.sensorKey = sensorKey;
+  summary.count = window.count > UINT16_MAX ? UINT16_MAX : (uint16_t)window.count;
+  summary.minCm = window.minCm;
+  summary.maxCm = window.maxCm;
+  summary.meanCm = (float)window.mean;
+  summary.stddevCm = window.count > 1 ? (float)sqrt(window.m2 / (window.count - 1)) : 0.0f;
+  // 草图估计值可能略微越出实际范围，按观测到的最小/最大值截断
+  summary.p50Cm = clampToRange(quantileFromSketch(window.sketch, 0.50f), window.minCm, window.maxCm);
+  summary.p90Cm = clampToRange(quantileFromSketch(window.sketch, 0.90f), window.minCm, window.maxCm);
+  summary.p99Cm = clampToRange(quantileFromSketch(window.sketch, 0.99f), window.minCm, window.maxCm);
+  return summary;
+}
+
+// 单条读数（例如旧版存储中的数据）视为只含一条读数的窗口，归第一个传感器
+WindowSummary summaryFromReading(float distanceCm, time_t timestamp) {
+  WindowSummary summary;
+  summary.timestamp = timestamp;
+  summary.spanMs = 0;
+  summary.sensorKey = 0;
+  summary.count = 1;
+  summary.minCm = distanceCm;
+  summary.maxCm = distanceCm;
+  summary.meanCm = distanceCm;
+  summary.stddevCm = 0.0f;
+  summary.p50Cm = distanceCm;
+  summary.p90Cm = distanceCm;
+  summary.p99Cm = distanceCm;
+  return summary;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "../config/Config.h"
+
+// 窗口聚合：采集任务按各传感器的采样间隔高频测距，每 AGGREGATION_WINDOW_MS
+// 把每个传感器的读数汇总为一条窗口摘要，只有摘要会被存储与上传。
+
+// 一个窗口的统计摘要，也是本地存储与上传的基本单位
+struct WindowSummary {
+  time_t timestamp;    // 窗口内最后一条读数的时间戳（未同步时为 TimeUtils 的编码值）
+  uint32_t spanMs;     // 第一条到最后一条读数的时间跨度
+  uint16_t sensorKey;  // 传感器的存储键（见 SensorRegistry），0 表示旧版数据
+  uint16_t count;
+  float minCm;
+  float maxCm;
+  float meanCm;
+  float stddevCm;
+  float p50Cm;
+  float p90Cm;
+  float p99Cm;
+};
+
+// 可合并的分位数草图（对数分桶，相对误差 QUANTILE_SKETCH_ACCURACY）：
+// 两个草图逐桶相加即为合并后数据的草图，结果与直接统计全部数据相同
+struct QuantileSketch {
+  uint32_t counts[QUANTILE_SKETCH_BUCKETS];
+  uint32_t total;
+};
+
+// 单个窗口的流式统计（Welford 算法计算均值与方差），同样可以合并
+struct WindowAccumulator {
+  uint32_t count;
+  double mean;
+  double m2;
+  float minCm;
+  float maxCm;
+  int64_t firstAtUs;
+  int64_t lastAtUs;
+  QuantileSketch sketch;
+};
+
+void resetQuantileSketch(QuantileSketch& sketch);
+void addToQuantileSketch(QuantileSketch& sketch, float value);
+void mergeQuantileSketch(QuantileSketch& into, const QuantileSketch& from);
+float quantileFromSketch(const QuantileSketch& sketch, float q);
+
+void resetWindow(WindowAccumulator& window);
+void addToWindow(WindowAccumulator& window, float distanceCm, int64_t capturedAtUs);
+void mergeWindow(WindowAccumulator& into, const WindowAccumulator& from);
+WindowSummary summarizeWindow(const WindowAccumulator& window, uint16_t sensorKey);
+WindowSummary summaryFromReading(float distanceCm, time_t timestamp);
@@ -10,6 +10,9 @@ inline constexpr char DEFAULT_WIFI_PASSWORD[] = "186212601830";
 inline constexpr char WIFI_PREF_NAMESPACE[] = "wifi";
 inline constexpr char WIFI_PREF_SSID_KEY[] = "ssid";
 inline constexpr char WIFI_PREF_PASS_KEY[] = "pass";
+// 连接超时；运行中断线后每 WIFI_RECONNECT_INTERVAL_MS 发起一次重连，loop() 不等待结果
+inline constexpr unsigned long WIFI_CONNECT_TIMEOUT_MS = 10000;
+inline constexpr unsigned long WIFI_RECONNECT_INTERVAL_MS = 10000;
 
 inline constexpr char CONFIG_AP_SSID[] = "ESP32S3_Config";
 inline constexpr char CONFIG_AP_PASSWORD[] = "12345678";
@@ -23,12 +26,131 @@ inline constexpr char ULTRASONIC_SENSOR_ID[] = "8ea58210-c649-11f0-afa3-da038af0
 inline constexpr char NTP_SERVER[] = "pool.ntp.org";
 inline constexpr long GMT_OFFSET_SEC = 7 * 3600;
 inline constexpr int DAYLIGHT_OFFSET_SEC = 0;
+inline constexpr char TIME_PREF_NAMESPACE[] = "time";
+// 启动后这段时间内仍未同步时间，则不再等待，未同步数据按无时间戳上传
+inline constexpr unsigned long TIME_SYNC_UPLOAD_GRACE_MS = 10UL * 60UL * 1000UL;
 
-inline constexpr unsigned long COLLECT_INTERVAL = 5000;
-inline constexpr unsigned long UPLOAD_CHECK_INTERVAL = 500;
-inline constexpr int BATCH_UPLOAD_SIZE = 50;
+// 窗口聚合：每个传感器按各自的采样间隔测距，每 AGGREGATION_WINDOW_MS 汇总为一条摘要上传
+inline constexpr unsigned long SAMPLE_INTERVAL_MS = 100;  // 默认采样间隔；HC-SR04 两次测量之间至少间隔 60 ms
+inline constexpr unsigned long AGGREGATION_WINDOW_MS = 60000;
+// 每汇总多少个窗口（含变化上报抑制掉的窗口）打印一次串口统计；单传感器默认 20 分钟一次
+inline constexpr uint32_t PIPELINE_STATS_WINDOWS = 20;
+inline constexpr float QUANTILE_SKETCH_ACCURACY = 0.01f;  // 分位数相对误差
+inline constexpr uint32_t QUANTILE_SKETCH_BUCKETS = 512;  // 覆盖最小量程的 γ^512 倍（约 3 万倍）
 
+// 变化上报（见 collector/ChangeDetector.h）：液位不变的窗口不上报，
+// 设为 false 时恢复为每个窗口都上报
+inline constexpr bool CHANGE_REPORTING_ENABLED = true;
+inline constexpr float CHANGE_DEADBAND_CM = 1.0f;          // 相对上次上报均值的死区
+inline constexpr float CHANGE_EXCURSION_FRACTION = 0.01f;  // 窗口内越出死区的读数达到该比例即上报
+inline constexpr uint32_t CHANGE_EXCURSION_MIN_READINGS = 3;  // 且至少这么多条，避免个别杂波触发
+inline constexpr float CHANGE_RATE_CM_PER_MIN = 0.5f;      // 相邻窗口均值的变化速率
+inline constexpr unsigned long CHANGE_HEARTBEAT_MS = 15UL * 60UL * 1000UL;  // 最长静默时间
+
+// 传感器注册表：每个传感器有服务器 ID、上传接口路径、采样间隔、驱动与引脚。
+// 存储中的记录按 ID 的 16 位哈希关联传感器，调整顺序不影响已存储的数据；
+// 第一个传感器同时接收旧版本固件存下的数据。
+enum SensorDriverKind : uint8_t {
+  SENSOR_DRIVER_ULTRASONIC,  // HC-SR04 类，TRIG/ECHO 为 -1 时退回模拟后端
+  SENSOR_DRIVER_SIMULATED,
+};
+
+struct SensorConfig {
+  const char* id;
+  const char* endpoint;  // 位于 API_BASE_URL 之下，后接传感器 ID
+  unsigned long sampleIntervalMs;
+  SensorDriverKind driver;
+  int trigPin;
+  int echoPin;
+};
+
+inline constexpr SensorConfig SENSOR_TABLE[] = {
+    {ULTRASONIC_SENSOR_ID, "/device/ultrasonicSensor/", SAMPLE_INTERVAL_MS, SENSOR_DRIVER_ULTRASONIC, -1, -1},
+};
+inline constexpr uint16_t SENSOR_COUNT = sizeof(SENSOR_TABLE) / sizeof(SENSOR_TABLE[0]);
+
+// 采样调度：分层时间轮，每个刻度 TIMER_WHEEL_TICK_MS
+inline constexpr unsigned long TIMER_WHEEL_TICK_MS = 10;
+
+// 超声波测距（HC-SR04 类）
+inline constexpr uint32_t ULTRASONIC_ECHO_TIMEOUT_US = 30000;  // 约 5 米往返，超时视为无回波
+inline constexpr float ULTRASONIC_MIN_CM = 2.0f;
+inline constexpr float ULTRASONIC_MAX_CM = 400.0f;
+inline constexpr float ULTRASONIC_AIR_TEMP_C = 20.0f;  // 用于计算声速
+inline constexpr uint32_t ULTRASONIC_QUEUE_LENGTH = 32;  // 所有传感器共用的回波队列
+
+// 双核流水线：采集任务在 APP 核（核 1），存储/上传任务与 Wi-Fi 协议栈同在 PRO 核（核 0）
+inline constexpr int COLLECTOR_TASK_CORE = 1;
+inline constexpr int UPLOAD_TASK_CORE = 0;
+inline constexpr uint32_t COLLECTOR_TASK_PRIORITY = 3;
+inline constexpr uint32_t UPLOAD_TASK_PRIORITY = 1;
+inline constexpr uint32_t COLLECTOR_TASK_STACK_SIZE = 4096;
+inline constexpr uint32_t UPLOAD_TASK_STACK_SIZE = 12288;
+// 存储刷写任务（按时提交暂存队列、响应掉电预警）与存储/上传任务同核，优先级更高，可抢占正在等网络的上传任务
+inline constexpr uint32_t STORAGE_FLUSH_TASK_PRIORITY = 2;
+inline constexpr uint32_t STORAGE_FLUSH_TASK_STACK_SIZE = 6144;
+inline constexpr uint32_t SAMPLE_RING_CAPACITY = 256;  // 必须是 2 的幂；所有传感器的窗口摘要共用
+inline constexpr unsigned long UPLOAD_CHECK_INTERVAL = 500;  // 有积压时两批之间的初始间隔
+inline constexpr int BATCH_UPLOAD_SIZE = 50;  // 逐条上传时每批的上限，也是自适应批次的初始值
+
+// 上传速率自适应（AIMD，见 upload/UploadController.h）：按每批的确认率与请求耗时
+// 调整批次大小与上传间隔，运行时可通过串口命令 upload 或配置服务的 /upload 查看与修改
+inline constexpr bool UPLOAD_ADAPTIVE_ENABLED = true;
+inline constexpr int UPLOAD_BATCH_MIN = 5;
+inline constexpr int UPLOAD_BATCH_INCREASE = 10;      // 整批成功后加性增大
+inline constexpr float UPLOAD_BATCH_DECREASE = 0.5f;  // 失败或超时后乘性减小
+inline constexpr unsigned long UPLOAD_LATENCY_TARGET_MS = 2000;  // 单个请求的目标耗时
+inline constexpr unsigned long UPLOAD_INTERVAL_MIN_MS = 100;
+inline constexpr unsigned long UPLOAD_INTERVAL_MAX_MS = 30000;  // 连续失败时间隔加倍的上限
+inline constexpr unsigned long UPLOAD_INTERVAL_STEP_MS = 100;
+inline constexpr unsigned long UPLOAD_RECORD_DELAY_MS = 100;  // 逐条上传时两次请求之间的初始间隔
+inline constexpr unsigned long UPLOAD_RECORD_DELAY_MAX_MS = 2000;
+inline constexpr unsigned long UPLOAD_RECORD_DELAY_STEP_MS = 10;
+
+// 局域网实时数据流（Server-Sent Events）：GET http://<设备 IP><LIVE_STREAM_PATH> 推送每条读数与窗口摘要
+inline constexpr bool LIVE_STREAM_ENABLED = true;
+inline constexpr char LIVE_STREAM_PATH[] = "/live";
+inline constexpr uint8_t LIVE_STREAM_MAX_CLIENTS = 4;
+inline constexpr uint32_t LIVE_STREAM_QUEUE_LENGTH = 128;    // 必须是 2 的幂；约 12 秒的读数（10 次/秒）
+inline constexpr size_t LIVE_STREAM_CLIENT_BUFFER = 1024;    // 每个客户端暂存的未发出数据上限，超出则断开
+inline constexpr unsigned long LIVE_STREAM_RECOVER_MS = 5000;       // 降级的客户端跟得上这么久后恢复逐条推送
+inline constexpr unsigned long LIVE_STREAM_RECOVER_MAX_MS = 60000;  // 反复降级时等待时间加倍的上限
+inline constexpr unsigned long LIVE_STREAM_KEEPALIVE_MS = 15000;
+
+// HTTP/1.1 长连接：空闲超过该时间后主动重连（应小于服务器的 keep-alive 超时，nginx 默认 75 秒）
+inline constexpr unsigned long HTTP_KEEPALIVE_IDLE_MS = 30000;
+inline constexpr uint16_t HTTP_TIMEOUT_MS = 10000;
+
+// 批量接口：整批数据一次 POST 到 <传感器>/readings/，按服务器确认的前缀删除本地数据
+inline constexpr bool BULK_UPLOAD_ENABLED = true;
+inline constexpr char BULK_UPLOAD_PATH[] = "/readings/";
+inline constexpr int BULK_UPLOAD_SIZE = 300;  // 批量接口每批的上限
+inline constexpr unsigned long BULK_UPLOAD_RETRY_MS = 10UL * 60UL * 1000UL;
+inline constexpr size_t BULK_ACK_DOC_SIZE = 8192;
+
+inline constexpr char DATA_LOG_DIR[] = "/series";
+inline constexpr const char* DATA_LOG_INDEX_PATHS[2] = {"/series/index.a", "/series/index.b"};
+inline constexpr char DATA_LOG_INDEX_PATH[] = "/series/index";  // 加入校验之前的单个索引文件
+inline constexpr uint32_t LOG_SEGMENT_RECORDS = 384;  // 按 32 条一帧追加时压缩后约 10~13 字节/条，一段约 4~5 KB
+inline constexpr uint32_t STORAGE_BUDGET_PERCENT = 75;  // 文件系统占用超过该比例时丢弃最旧的段
+
+// PSRAM 暂存队列（组提交）：由存储刷写任务按时提交，突然断电最多丢失约 STAGING_COMMIT_INTERVAL_MS
+// （再加上等待正在进行的一次闪存操作）内、且不超过 STAGING_COMMIT_RECORDS - 1 条尚未提交的数据。
+// 接了掉电预警时，中断直接唤醒刷写任务，只需等待正在进行的那一次闪存操作
+inline constexpr uint32_t STAGING_CAPACITY = 4096;
+inline constexpr uint32_t STAGING_COMMIT_RECORDS = 32;
+inline constexpr unsigned long STAGING_COMMIT_INTERVAL_MS = 60000;
+inline constexpr int STORAGE_POWER_FAIL_PIN = -1;  // 接电源监控芯片的掉电预警输出（低有效），-1 表示未接
+
+// 旧版存储，仅用于首次启动时迁移：单文件 JSON、逐条读数的分段日志，以及未压缩的窗口摘要日志
 inline constexpr char DATA_FILE_PATH[] = "/sensor_data.json";
-inline constexpr size_t MIN_FREE_HEAP = 20000;
-inline constexpr size_t JSON_DOC_SIZE = 1048576;
+inline constexpr char LEGACY_LOG_DIR[] = "/log";
+inline constexpr char LEGACY_LOG_INDEX_PATH[] = "/log/index";
+inline constexpr char LEGACY_SUMMARY_LOG_DIR[] = "/summary";
+inline constexpr char LEGACY_SUMMARY_LOG_INDEX_PATH[] = "/summary/index";
+
+// JSON 文档内存池预算：PSRAM 中预留 1 MB（足以一次性解析旧版 JSON 存储），
+// 无 PSRAM 时退回到内部 RAM 中的小内存池
+inline constexpr size_t JSON_ARENA_SIZE = 1048576;
+inline constexpr size_t JSON_ARENA_FALLBACK_SIZE = 32768;
 
@@ -0,0 +1,169 @@
+#include "JsonArena.h"
+
+#include <esp_heap_caps.h>
+
+#include "../config/Config.h"
+
+namespace {
+struct ArenaBlock {
+  uint32_t previousBlock;
+  uint32_t size;
+  uint32_t released;
+  uint32_t reserved;
+};
+
+constexpr size_t ARENA_ALIGN = sizeof(ArenaBlock);
+constexpr uint32_t NO_BLOCK = 0xFFFFFFFF;
+
+uint8_t* arenaBase = nullptr;
+size_t arenaCapacity = 0;
+size_t arenaTop = 0;
+size_t arenaPeak = 0;
+uint32_t topBlock = NO_BLOCK;
+uint32_t arenaAllocations = 0;
+uint32_t arenaFailures = 0;
+bool arenaInPsram = false;
+portMUX_TYPE arenaLock = portMUX_INITIALIZER_UNLOCKED;
+
+size_t alignedBlockSize(size_t payload) {
+  return (sizeof(ArenaBlock) + payload + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+}
+
+ArenaBlock* blockAt(uint32_t offset) {
+  return reinterpret_cast<ArenaBlock*>(arenaBase + offset);
+}
+
+ArenaBlock* blockOf(void* ptr) {
+  return reinterpret_cast<ArenaBlock*>(static_cast<uint8_t*>(ptr) - sizeof(ArenaBlock));
+}
+
+bool ownsPointer(void* ptr) {
+  uint8_t* p = static_cast<uint8_t*>(ptr);
+  return arenaBase && p >= arenaBase + sizeof(ArenaBlock) && p < arenaBase + arenaCapacity;
+}
+
+// 调用方需持有 arenaLock
+void* allocateLocked(size_t size) {
+  size_t need = alignedBlockSize(size);
+  if (arenaTop + need > arenaCapacity) {
+    arenaFailures++;
+    return nullptr;
+  }
+  ArenaBlock* block = blockAt(arenaTop);
+  block->previousBlock = topBlock;
+  block->size = size;
+  block->released = 0;
+  topBlock = arenaTop;
+  arenaTop += need;
+  if (arenaTop > arenaPeak) {
+    arenaPeak = arenaTop;
+  }
+  arenaAllocations++;
+  return reinterpret_cast<uint8_t*>(block) + sizeof(ArenaBlock);
+}
+
+// 释放的块若位于栈顶则连同其下已释放的块一起弹出
+void releaseLocked(void* ptr) {
+  blockOf(ptr)->released = 1;
+  while (topBlock != NO_BLOCK && blockAt(topBlock)->released) {
+    arenaTop = topBlock;
+    topBlock = blockAt(topBlock)->previousBlock;
+  }
+}
+}  // namespace
+
+bool beginJsonArena() {
+  if (arenaBase) {
+    return true;
+  }
+
+  arenaBase = static_cast<uint8_t*>(heap_caps_malloc(JSON_ARENA_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+  if (arenaBase) {
+    arenaCapacity = JSON_ARENA_SIZE;
+    arenaInPsram = true;
+  } else {
+    arenaBase = static_cast<uint8_t*>(malloc(JSON_ARENA_FALLBACK_SIZE));
+    arenaCapacity = arenaBase ? JSON_ARENA_FALLBACK_SIZE : 0;
+  }
+
+  if (!arenaBase) {
+    Serial.println("[错误] 无法分配 JSON 内存池");
+    return false;
+  }
+
+  Serial.print("[内存] JSON 内存池 ");
+  Serial.print(arenaCapacity / 1024);
+  Serial.println(arenaInPsram ? " KB（PSRAM）" : " KB（内部 RAM，未检测到 PSRAM）");
+  return true;
+}
+
+size_t jsonArenaAvailable() {
+  portENTER_CRITICAL(&arenaLock);
+  size_t top = arenaTop;
+  portEXIT_CRITICAL(&arenaLock);
+  size_t overhead = alignedBlockSize(0);
+  return (arenaCapacity > top + overhead) ? arenaCapacity - top - overhead : 0;
+}
+
+JsonArenaStats getJsonArenaStats() {
+  portENTER_CRITICAL(&arenaLock);
+  JsonArenaStats stats = {arenaCapacity, arenaTop, arenaPeak, arenaAllocations, arenaFailures, arenaInPsram};
+  portEXIT_CRITICAL(&arenaLock);
+  return stats;
+}
+
+void* jsonArenaAllocate(size_t size) {
+  portENTER_CRITICAL(&arenaLock);
+  void* ptr = allocateLocked(size);
+  portEXIT_CRITICAL(&arenaLock);
+  return ptr;
+}
+
+void jsonArenaDeallocate(void* ptr) {
+  if (!ownsPointer(ptr)) {
+    return;
+  }
+  portENTER_CRITICAL(&arenaLock);
+  releaseLocked(ptr);
+  portEXIT_CRITICAL(&arenaLock);
+}
+
+void* jsonArenaReallocate(void* ptr, size_t newSize) {
+  if (!ptr) {
+    return jsonArenaAllocate(newSize);
+  }
+  if (!ownsPointer(ptr)) {
+    return nullptr;
+  }
+
+  portENTER_CRITICAL(&arenaLock);
+  ArenaBlock* block = blockOf(ptr);
+  uint32_t offset = static_cast<uint32_t>(reinterpret_cast<uint8_t*>(block) - arenaBase);
+
+  // 栈顶块（例如 shrinkToFit）直接原地伸缩
+  if (offset == topBlock) {
+    size_t need = alignedBlockSize(newSize);
+    if (offset + need > arenaCapacity) {
+      arenaFailures++;
+      portEXIT_CRITICAL(&arenaLock);
+      return nullptr;
+    }
+    block->size = newSize;
+    arenaTop = offset + need;
+    if (arenaTop > arenaPeak) {
+      arenaPeak = arenaTop;
+    }
+    portEXIT_CRITICAL(&arenaLock);
+    return ptr;
+  }
+
+  // 非栈顶块只能新分配后搬移，拷贝放在临界区外进行
+  size_t oldSize = block->size;
+  void* moved = allocateLocked(newSize);
+  portEXIT_CRITICAL(&arenaLock);
+  if (moved) {
+    memcpy(moved, ptr, oldSize < newSize ? oldSize : newSize);
+    jsonArenaDeallocate(ptr);
+  }
+  return moved;
+}
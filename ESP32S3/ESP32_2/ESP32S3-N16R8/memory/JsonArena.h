@@ -0,0 +1,32 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// JSON 文档内存池：启动时从 PSRAM 预留一整块内存，文档按栈式（后进先出）分配，
+// 析构即归还，热路径不再向内部堆申请大块内存。超出预算的申请直接失败并计数。
+
+struct JsonArenaStats {
+  size_t capacity;
+  size_t used;
+  size_t peak;
+  uint32_t allocations;
+  uint32_t failures;
+  bool inPsram;
+};
+
+bool beginJsonArena();
+size_t jsonArenaAvailable();
+JsonArenaStats getJsonArenaStats();
+
+void* jsonArenaAllocate(size_t size);
+void jsonArenaDeallocate(void* ptr);
+void* jsonArenaReallocate(void* ptr, size_t newSize);
+
+struct JsonArenaAllocator {
+  void* allocate(size_t size) { return jsonArenaAllocate(size); }
+  void deallocate(void* ptr) { jsonArenaDeallocate(ptr); }
+  void* reallocate(void* ptr, size_t newSize) { return jsonArenaReallocate(ptr, newSize); }
+};
+
+using ArenaJsonDocument = BasicJsonDocument<JsonArenaAllocator>;
@@ -0,0 +1,318 @@
+#include "LiveStream.h"
+
+#include <WiFi.h>
+#include <atomic>
+#include <lwip/sockets.h>
+
+#include "../collector/SensorRegistry.h"
+#include "../config/Config.h"
+#include "../time/TimeUtils.h"
+#include "WifiManager.h"
+
+namespace {
+static_assert((LIVE_STREAM_QUEUE_LENGTH & (LIVE_STREAM_QUEUE_LENGTH - 1)) == 0,
+              "LIVE_STREAM_QUEUE_LENGTH 必须是 2 的幂");
+
+constexpr size_t LIVE_EVENT_TEXT_SIZE = 384;
+
+struct LiveEvent {
+  bool isSummary;
+  DistanceReading reading;
+  WindowSummary summary;
+};
+
+// 采集任务（生产者）与 loop()（消费者）之间的单生产者单消费者队列，做法与 SampleRing 相同
+LiveEvent liveSlots[LIVE_STREAM_QUEUE_LENGTH];
+std::atomic<uint32_t> liveWriteCount{0};
+std::atomic<uint32_t> liveReadCount{0};
+std::atomic<uint32_t> liveDroppedCount{0};
+// 有客户端时才入队，无人订阅时采集任务不做额外工作
+std::atomic<bool> liveListening{false};
+
+struct LiveClient {
+  bool active;
+  bool summariesOnly;
+  WiFiClient client;
+  char pending[LIVE_STREAM_CLIENT_BUFFER];  // 已生成但 socket 暂时写不进去的数据
+  size_t pendingLength;
+  unsigned long lastSendMs;
+  unsigned long lastBehindMs;  // 最近一次有数据没能立即写出
+  unsigned long recoverAfterMs;
+};
+
+LiveClient liveClients[LIVE_STREAM_MAX_CLIENTS];
+uint32_t liveEventsSent = 0;
+uint32_t liveReadingsSkipped = 0;
+
+bool enqueueLiveEvent(const LiveEvent& event) {
+  uint32_t write = liveWriteCount.load(std::memory_order_relaxed);
+  uint32_t read = liveReadCount.load(std::memory_order_acquire);
+  if (write - read >= LIVE_STREAM_QUEUE_LENGTH) {
+    liveDroppedCount.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  liveSlots[write & (LIVE_STREAM_QUEUE_LENGTH - 1)] = event;
+  liveWriteCount.store(write + 1, std::memory_order_release);
+  return true;
+}
+
+bool dequeueLiveEvent(LiveEvent& event) {
+  uint32_t read = liveReadCount.load(std::memory_order_relaxed);
+  uint32_t write = liveWriteCount.load(std::memory_order_acquire);
+  if (read == write) {
+    return false;
+  }
+  event = liveSlots[read & (LIVE_STREAM_QUEUE_LENGTH - 1)];
+  liveReadCount.store(read + 1, std::memory_order_release);
+  return true;
+}
+
+uint8_t activeLiveClients() {
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < LIVE_STREAM_MAX_CLIENTS; i++) {
+    if (liveClients[i].active) {
+      count++;
+    }
+  }
+  return count;
+}
+
+void closeLiveClient(LiveClient& c, const char* reason) {
+  c.client.stop();
+  c.active = false;
+  c.pendingLength = 0;
+  liveListening.store(activeLiveClients() > 0, std::memory_order_release);
+  Serial.print("[实时] 客户端断开（");
+  Serial.print(reason);
+  Serial.print("），剩余 ");
+  Serial.print(activeLiveClients());
+  Serial.println(" 个");
+}
+
+// 非阻塞写出，返回写出的字节数（发送缓冲区已满时为 0）；-1 表示连接已断开
+int sendNonBlocking(LiveClient& c, const char* data, size_t length) {
+  int sent = send(c.client.fd(), data, length, MSG_DONTWAIT);
+  if (sent < 0) {
+    return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+  }
+  return sent;
+}
+
+bool flushLiveClient(LiveClient& c, unsigned long now) {
+  if (c.pendingLength == 0) {
+    return true;
+  }
+  int sent = sendNonBlocking(c, c.pending, c.pendingLength);
+  if (sent < 0) {
+    closeLiveClient(c, "连接已断开");
+    return false;
+  }
+  if (sent > 0) {
+    memmove(c.pending, c.pending + sent, c.pendingLength - sent);
+    c.pendingLength -= sent;
+    c.lastSendMs = now;
+  }
+  if (c.pendingLength > 0) {
+    c.lastBehindMs = now;
+  }
+  return true;
+}
+
+// 先直接写 socket，写不完的部分放入客户端缓冲区；缓冲区也放不下说明客户端长时间不读取，断开
+bool writeLiveClient(LiveClient& c, const char* data, size_t length, unsigned long now) {
+  size_t offset = 0;
+  if (c.pendingLength == 0) {
+    int sent = sendNonBlocking(c, data, length);
+    if (sent < 0) {
+      closeLiveClient(c, "连接已断开");
+      return false;
+    }
+    if (sent > 0) {
+      offset = (size_t)sent;
+      c.lastSendMs = now;
+    }
+  }
+  size_t rest = length - offset;
+  if (rest == 0) {
+    return true;
+  }
+  c.lastBehindMs = now;
+  if (c.pendingLength + rest > sizeof(c.pending)) {
+    closeLiveClient(c, "长时间未读取数据");
+    return false;
+  }
+  memcpy(c.pending + c.pendingLength, data + offset, rest);
+  c.pendingLength += rest;
+  return true;
+}
+
+void setLiveClientMode(LiveClient& c, bool summariesOnly, unsigned long now) {
+  c.summariesOnly = summariesOnly;
+  const char* text = summariesOnly ? "event: mode\ndata: summaries\n\n" : "event: mode\ndata: readings\n\n";
+  writeLiveClient(c, text, strlen(text), now);
+}
+
+const char* liveSensorId(int sensor) {
+  return sensor >= 0 && sensor < SENSOR_COUNT ? SENSOR_TABLE[sensor].id : "";
+}
+
+// time 为 Unix 时间（秒），时间未同步时为 0；uptimeMs 为启动后的单调时间，精度更高
+size_t formatLiveReading(const DistanceReading& reading, char* out, size_t capacity) {
+  time_t timestamp = timestampFromMonotonic(reading.capturedAtUs);
+  int length = snprintf(out, capacity,
+                        "event: reading\ndata: {\"sensor\":\"%s\",\"distance\":%.2f,\"uptimeMs\":%lld,\"time\":%lld}\n\n",
+                        liveSensorId(reading.sensor), reading.distanceCm,
+                        (long long)(reading.capturedAtUs / 1000), (long long)(timestamp > 0 ? timestamp : 0));
+  return length > 0 && (size_t)length < capacity ? (size_t)length : 0;
+}
+
+// 字段与上传数据中的 window 对象相同
+size_t formatLiveSummary(const WindowSummary& summary, char* out, size_t capacity) {
+  time_t timestamp = resolveTimestamp(summary.timestamp);
+  int length = snprintf(out, capacity,
+                        "event: summary\ndata: {\"sensor\":\"%s\",\"time\":%lld,\"seconds\":%.1f,\"count\":%u,"
+                        "\"min\":%.2f,\"max\":%.2f,\"mean\":%.2f,\"stddev\":%.2f,"
+                        "\"p50\":%.2f,\"p90\":%.2f,\"p99\":%.2f}\n\n",
+                        liveSensorId(findSensorByKey(summary.sensorKey)), (long long)(timestamp > 0 ? timestamp : 0),
+                        summary.spanMs / 1000.0, (unsigned)summary.count, summary.minCm, summary.maxCm,
+                        summary.meanCm, summary.stddevCm, summary.p50Cm, summary.p90Cm, summary.p99Cm);
+  return length > 0 && (size_t)length < capacity ? (size_t)length : 0;
+}
+
+void deliverLiveEvent(const char* text, size_t length, bool isSummary, unsigned long now) {
+  for (uint8_t i = 0; i < LIVE_STREAM_MAX_CLIENTS; i++) {
+    LiveClient& c = liveClients[i];
+    if (!c.active || !flushLiveClient(c, now)) {
+      continue;
+    }
+    if (!isSummary) {
+      if (c.summariesOnly) {
+        liveReadingsSkipped++;
+        continue;
+      }
+      // 上一条读数还没写完：客户端跟不上逐条推送，降级为只推送摘要，恢复前的等待时间逐次加倍
+      if (c.pendingLength > 0) {
+        liveReadingsSkipped++;
+        setLiveClientMode(c, true, now);
+        c.recoverAfterMs = c.recoverAfterMs * 2 < LIVE_STREAM_RECOVER_MAX_MS ? c.recoverAfterMs * 2
+                                                                               : LIVE_STREAM_RECOVER_MAX_MS;
+        continue;
+      }
+    }
+    if (writeLiveClient(c, text, length, now)) {
+      liveEventsSent++;
+    }
+  }
+}
+}  // namespace
+
+void handleLiveStreamRequest() {
+  LiveClient* slot = nullptr;
+  for (uint8_t i = 0; i < LIVE_STREAM_MAX_CLIENTS; i++) {
+    if (!liveClients[i].active) {
+      slot = &liveClients[i];
+      break;
+    }
+  }
+  if (!slot) {
+    configServer.send(503, "text/plain", "实时数据流连接数已满");
+    return;
+  }
+
+  // 复制一份连接并自行写出响应头；WebServer 释放它持有的那一份时 socket 仍然保持打开
+  unsigned long now = millis();
+  slot->client = configServer.client();
+  slot->client.setNoDelay(true);
+  slot->active = true;
+  slot->summariesOnly = false;
+  slot->pendingLength = 0;
+  slot->lastSendMs = now;
+  slot->lastBehindMs = now;
+  slot->recoverAfterMs = LIVE_STREAM_RECOVER_MS / 2;  // 每次降级时加倍，首次降级后等待 LIVE_STREAM_RECOVER_MS
+
+  static const char headers[] =
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Type: text/event-stream\r\n"
+      "Cache-Control: no-cache\r\n"
+      "Connection: keep-alive\r\n"
+      "Access-Control-Allow-Origin: *\r\n"
+      "\r\n"
+      "retry: 2000\n\n"
+      "event: mode\ndata: readings\n\n";
+  if (!writeLiveClient(*slot, headers, sizeof(headers) - 1, now)) {
+    return;
+  }
+  liveListening.store(true, std::memory_order_release);
+
+  Serial.print("[实时] 新客户端 ");
+  Serial.print(slot->client.remoteIP());
+  Serial.print("，当前 ");
+  Serial.print(activeLiveClients());
+  Serial.println(" 个");
+}
+
+void serviceLiveStream() {
+  unsigned long now = millis();
+  char text[LIVE_EVENT_TEXT_SIZE];
+  LiveEvent event;
+  while (dequeueLiveEvent(event)) {
+    if (!liveListening.load(std::memory_order_acquire)) {
+      continue;
+    }
+    size_t length = event.isSummary ? formatLiveSummary(event.summary, text, sizeof(text))
+                                    : formatLiveReading(event.reading, text, sizeof(text));
+    if (length > 0) {
+      deliverLiveEvent(text, length, event.isSummary, now);
+    }
+  }
+
+  for (uint8_t i = 0; i < LIVE_STREAM_MAX_CLIENTS; i++) {
+    LiveClient& c = liveClients[i];
+    if (!c.active) {
+      continue;
+    }
+    if (!c.client.connected()) {
+      closeLiveClient(c, "客户端关闭");
+      continue;
+    }
+    if (!flushLiveClient(c, now)) {
+      continue;
+    }
+    if (c.summariesOnly && c.pendingLength == 0 && now - c.lastBehindMs >= c.recoverAfterMs) {
+      setLiveClientMode(c, false, now);
+    }
+    // 注释行保活，同时让已经消失的客户端尽快暴露为写入失败
+    if (c.active && c.pendingLength == 0 && now - c.lastSendMs >= LIVE_STREAM_KEEPALIVE_MS) {
+      writeLiveClient(c, ": ping\n\n", 8, now);
+    }
+  }
+}
+
+void publishLiveReading(const DistanceReading& reading) {
+  if (!liveListening.load(std::memory_order_acquire)) {
+    return;
+  }
+  LiveEvent event;
+  event.isSummary = false;
+  event.reading = reading;
+  enqueueLiveEvent(event);
+}
+
+void publishLiveSummary(const WindowSummary& summary) {
+  if (!liveListening.load(std::memory_order_acquire)) {
+    return;
+  }
+  LiveEvent event;
+  event.isSummary = true;
+  event.summary = summary;
+  enqueueLiveEvent(event);
+}
+
+LiveStreamStats getLiveStreamStats() {
+  LiveStreamStats stats;
+  stats.clients = activeLiveClients();
+  stats.eventsSent = liveEventsSent;
+  stats.readingsSkipped = liveReadingsSkipped;
+  stats.queueDropped = liveDroppedCount.load(std::memory_order_relaxed);
+  return stats;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "../collector/UltrasonicSensor.h"
+#include "../collector/WindowAggregator.h"
+
+// 局域网实时数据流：配置服务上的 LIVE_STREAM_PATH 以 Server-Sent Events 推送每条读数
+// （event: reading）与每个窗口摘要（event: summary），不经过云端，也不受上传与变化上报的影响。
+//
+// 采集任务只把事件写入无锁队列（没有客户端时直接跳过），由 loop() 中的 serviceLiveStream()
+// 以非阻塞方式写入各客户端的 socket。客户端跟不上时（socket 发送缓冲区已满）降级为
+// 只推送窗口摘要，并发送 event: mode；连续 LIVE_STREAM_RECOVER_MS 跟得上后恢复逐条推送。
+
+struct LiveStreamStats {
+  uint8_t clients;
+  uint32_t eventsSent;
+  uint32_t readingsSkipped;  // 降级客户端跳过的读数（按客户端累计）
+  uint32_t queueDropped;     // loop() 来不及处理而在队列中丢弃的事件
+};
+
+void handleLiveStreamRequest();
+void serviceLiveStream();
+void publishLiveReading(const DistanceReading& reading);
+void publishLiveSummary(const WindowSummary& summary);
+LiveStreamStats getLiveStreamStats();
@@ -4,6 +4,8 @@
 #include <Preferences.h>
 
 #include "../config/Config.h"
+#include "../upload/UploadController.h"
+#include "LiveStream.h"
 
 namespace {
 Preferences wifiPrefs;
@@ -21,6 +23,11 @@ void ensureConfigServerRoutes() {
   }
   configServer.on("/", HTTP_GET, handleConfigPortalRoot);
   configServer.on("/save", HTTP_POST, handleConfigPortalSave);
+  configServer.on("/upload", HTTP_GET, handleUploadTuningGet);
+  configServer.on("/upload", HTTP_POST, handleUploadTuningPost);
+  if (LIVE_STREAM_ENABLED) {
+    configServer.on(LIVE_STREAM_PATH, HTTP_GET, handleLiveStreamRequest);
+  }
   configServer.onNotFound(handleConfigPortalNotFound);
   configServerInitialized = true;
 }
@@ -76,6 +83,11 @@ void announceConfigServerAddress() {
   Serial.print("[WiFi] 手机端可访问 http://");
   Serial.print(WiFi.localIP());
   Serial.println(" 修改 Wi-Fi 配置");
+  if (LIVE_STREAM_ENABLED) {
+    Serial.print("[实时] 局域网实时数据流: http://");
+    Serial.print(WiFi.localIP());
+    Serial.println(LIVE_STREAM_PATH);
+  }
 }
 
 void beginConfigServer() {
@@ -251,7 +263,7 @@ void startConfigPortal() {
   Serial.println(" 进行配置");
 }
 
-bool connectWiFi() {
+void beginWiFiConnect() {
   Serial.print("[WiFi] 正在连接: ");
   Serial.println(activeSsid);
   if (storedCredentialsAvailable) {
@@ -259,15 +271,16 @@ bool connectWiFi() {
   }
 
   WiFi.begin(activeSsid.c_str(), activePassword.c_str());
+}
 
-  int attempts = 0;
-  const int maxAttempts = 20;
+bool connectWiFi() {
+  beginWiFiConnect();
 
-  while (WiFi.status() != WL_CONNECTED && attempts < maxAttempts) {
+  unsigned long startedAt = millis();
+  while (WiFi.status() != WL_CONNECTED && millis() - startedAt < WIFI_CONNECT_TIMEOUT_MS) {
     delay(500);
     Serial.print(".");
     yield();
-    attempts++;
   }
   Serial.println();
 
@@ -11,7 +11,10 @@ extern unsigned long configPortalLastActivity;
 
 void loadStoredWiFiCredentials();
 bool persistWiFiCredentials(const String& newSsid, const String& newPassword);
+// 启动时使用：等待连接成功或 WIFI_CONNECT_TIMEOUT_MS 超时
 bool connectWiFi();
+// 只发起连接、立即返回，loop() 中的重连使用，不阻塞 loop() 里的实时数据流与配置服务
+void beginWiFiConnect();
 void startConfigPortal();
 void sendConfigPortalPage(const String& message = "");
 void handleConfigPortalRoot();
@@ -0,0 +1,337 @@
+#include "Pipeline.h"
+
+#include <WiFi.h>
+#include <atomic>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "../collector/ChangeDetector.h"
+#include "../collector/SensorRegistry.h"
+#include "../collector/UltrasonicSensor.h"
+#include "../collector/WindowAggregator.h"
+#include "../config/Config.h"
+#include "../memory/JsonArena.h"
+#include "../network/LiveStream.h"
+#include "../network/WifiManager.h"
+#include "../storage/StorageManager.h"
+#include "../time/TimeUtils.h"
+#include "../upload/UploadController.h"
+#include "../upload/Uploader.h"
+#include "SampleRing.h"
+#include "TimerWheel.h"
+
+namespace {
+TaskHandle_t collectorTaskHandle = nullptr;
+TaskHandle_t uploadTaskHandle = nullptr;
+
+// 每个传感器一个窗口累加器（各含约 2 KB 的分位数草图），优先放在 PSRAM 中
+WindowAccumulator* sensorWindows = nullptr;
+WheelTimer sensorTimers[SENSOR_COUNT];
+uint32_t sensorIntervalTicks[SENSOR_COUNT];
+uint32_t sensorTicksPerWindow[SENSOR_COUNT];
+uint32_t sensorSampleCounts[SENSOR_COUNT];
+int64_t collectorBaseUs = 0;
+// 采集任务汇总的窗口数（含未进入上传队列的窗口），上传任务按它决定何时打印统计
+std::atomic<uint32_t> summarizedWindows{0};
+
+portMUX_TYPE jitterLock = portMUX_INITIALIZER_UNLOCKED;
+uint32_t jitterSamples = 0;
+int64_t lastJitterUs = 0;
+int64_t maxAbsJitterUs = 0;
+int64_t sumAbsJitterUs = 0;
+
+void recordJitter(int64_t jitterUs) {
+  int64_t absJitter = jitterUs < 0 ? -jitterUs : jitterUs;
+  portENTER_CRITICAL(&jitterLock);
+  jitterSamples++;
+  lastJitterUs = jitterUs;
+  sumAbsJitterUs += absJitter;
+  if (absJitter > maxAbsJitterUs) {
+    maxAbsJitterUs = absJitter;
+  }
+  portEXIT_CRITICAL(&jitterLock);
+}
+
+bool allocateSensorWindows() {
+  size_t bytes = sizeof(WindowAccumulator) * SENSOR_COUNT;
+  sensorWindows = (WindowAccumulator*)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!sensorWindows) {
+    sensorWindows = (WindowAccumulator*)malloc(bytes);
+  }
+  return sensorWindows != nullptr;
+}
+
+// 时间轮回调：第 n 次采样的理想时刻为 基准 + 到期刻度 × 刻度长度，抖动为实际触发时刻与之差。
+// 每 AGGREGATION_WINDOW_MS 个采样周期结束一个窗口，窗口边界按采样序号划分，
+// 不受单次测量失败的影响；上一周期的回波在下一次触发前已经到达（回波超时远小于采样间隔）。
+void onSensorTimer(WheelTimer& timer) {
+  uint16_t sensor = timer.sensor;
+  int64_t nowUs = esp_timer_get_time();
+  recordJitter(nowUs - (collectorBaseUs + (int64_t)timer.expiresTick * TIMER_WHEEL_TICK_MS * 1000LL));
+
+  WindowAccumulator& window = sensorWindows[sensor];
+  if (sensorSampleCounts[sensor] > 0 && sensorSampleCounts[sensor] % sensorTicksPerWindow[sensor] == 0 &&
+      window.count > 0) {
+    // 实时数据流收到每个窗口；液位没有变化的窗口不进入上传队列
+    WindowSummary summary = summarizeWindow(window, sensorKey(sensor));
+    publishLiveSummary(summary);
+    summarizedWindows.fetch_add(1);
+    if (evaluateWindowChange(sensor, window) != CHANGE_TRIGGER_NONE) {
+      pushSample(summary);
+      if (uploadTaskHandle) {
+        xTaskNotifyGive(uploadTaskHandle);
+      }
+    }
+    resetWindow(window);
+  }
+  sensorSampleCounts[sensor]++;
+
+  // 发出触发脉冲后立即返回，回波结果由采集任务在等待下一个刻度时从队列取出
+  triggerDistanceMeasurement(sensor);
+  scheduleTimer(timer, timer.expiresTick + sensorIntervalTicks[sensor]);
+}
+
+// 采集任务：由时间轮按各传感器的采样间隔调度触发，刻度之间挂起等待回波队列，
+// 同一时刻可以有多个传感器的测量在进行
+void collectorTask(void*) {
+  if (!sensorWindows && !allocateSensorWindows()) {
+    Serial.println("[错误] 无法分配窗口累加器，采集任务退出");
+    vTaskDelete(nullptr);
+    return;
+  }
+
+  collectorBaseUs = esp_timer_get_time();
+  resetTimerWheel(0);
+  for (uint16_t i = 0; i < SENSOR_COUNT; i++) {
+    unsigned long intervalMs = SENSOR_TABLE[i].sampleIntervalMs;
+    sensorIntervalTicks[i] = intervalMs >= TIMER_WHEEL_TICK_MS ? intervalMs / TIMER_WHEEL_TICK_MS : 1;
+    sensorTicksPerWindow[i] = AGGREGATION_WINDOW_MS >= intervalMs && intervalMs > 0
+                                  ? AGGREGATION_WINDOW_MS / intervalMs
+                                  : 1;
+    sensorSampleCounts[i] = 0;
+    resetWindow(sensorWindows[i]);
+    resetChangeDetector(i);
+    sensorTimers[i].sensor = i;
+    // 错开各传感器的首次触发，避免相邻传感器的声波互相干扰
+    scheduleTimer(sensorTimers[i], (uint32_t)i * sensorIntervalTicks[i] / SENSOR_COUNT);
+  }
+
+  const int64_t tickUs = TIMER_WHEEL_TICK_MS * 1000LL;
+  for (;;) {
+    uint32_t nowTick = (uint32_t)((esp_timer_get_time() - collectorBaseUs) / tickUs);
+    advanceTimerWheel(nowTick, onSensorTimer);
+
+    int64_t nextTickUs = collectorBaseUs + (int64_t)(nowTick + 1) * tickUs;
+    for (;;) {
+      int64_t remainingUs = nextTickUs - esp_timer_get_time();
+      if (remainingUs <= 0) {
+        break;
+      }
+      DistanceReading reading;
+      if (readDistance(reading, (uint32_t)((remainingUs + 999) / 1000)) && reading.sensor < SENSOR_COUNT) {
+        addToWindow(sensorWindows[reading.sensor], reading.distanceCm, reading.capturedAtUs);
+        noteReadingForChange(reading.sensor, reading.distanceCm);
+        publishLiveReading(reading);
+      }
+    }
+  }
+}
+
+void printPipelineStats(uint32_t windows) {
+  int currentStoredCount = getStoredDataCount();
+  Serial.print("\n[统计] 已汇总 ");
+  Serial.print(windows);
+  Serial.print(" 个窗口，本地存储: ");
+  Serial.print(currentStoredCount);
+  Serial.println(" 条");
+
+  CollectorJitterStats jitter = getCollectorJitterStats();
+  Serial.print("[统计] 采样抖动: 最近 ");
+  Serial.print((long)jitter.lastJitterUs);
+  Serial.print(" us，平均 ");
+  Serial.print((long)jitter.meanAbsJitterUs);
+  Serial.print(" us，最大 ");
+  Serial.print((long)jitter.maxAbsJitterUs);
+  Serial.print(" us | 队列积压 ");
+  Serial.print(pendingSampleCount());
+  Serial.print(" 条，溢出丢弃 ");
+  Serial.print(droppedSampleCount());
+  Serial.println(" 条");
+
+  UltrasonicStats sensor = getUltrasonicStats();
+  Serial.print("[统计] 测距: 成功 ");
+  Serial.print(sensor.measurements);
+  Serial.print(" 次，无回波 ");
+  Serial.print(sensor.timeouts);
+  Serial.print(" 次，超出量程 ");
+  Serial.print(sensor.outOfRange);
+  Serial.println(" 次");
+
+  if (CHANGE_REPORTING_ENABLED) {
+    ChangeReportStats change = getChangeReportStats();
+    Serial.print("[统计] 变化上报: 抑制 ");
+    Serial.print(change.reported[CHANGE_TRIGGER_NONE]);
+    Serial.print(" 个窗口，上报");
+    for (int trigger = CHANGE_TRIGGER_FIRST; trigger < CHANGE_TRIGGER_COUNT; trigger++) {
+      Serial.print(" ");
+      Serial.print(changeTriggerName((ChangeTrigger)trigger));
+      Serial.print(" ");
+      Serial.print(change.reported[trigger]);
+    }
+    Serial.println();
+  }
+
+  if (LIVE_STREAM_ENABLED) {
+    LiveStreamStats live = getLiveStreamStats();
+    Serial.print("[统计] 实时数据流: ");
+    Serial.print(live.clients);
+    Serial.print(" 个客户端，已推送 ");
+    Serial.print(live.eventsSent);
+    Serial.print(" 条，降级跳过 ");
+    Serial.print(live.readingsSkipped);
+    Serial.print(" 条读数，队列丢弃 ");
+    Serial.print(live.queueDropped);
+    Serial.println(" 条");
+  }
+
+  printUploadTuning();
+
+  JsonArenaStats arenaStats = getJsonArenaStats();
+  Serial.print("[统计] JSON 内存池: 峰值 ");
+  Serial.print(arenaStats.peak / 1024.0, 1);
+  Serial.print(" / ");
+  Serial.print(arenaStats.capacity / 1024);
+  Serial.print(" KB，分配 ");
+  Serial.print(arenaStats.allocations);
+  Serial.print(" 次，超预算 ");
+  Serial.print(arenaStats.failures);
+  Serial.println(" 次");
+}
+
+// 本地无待上传数据且网络正常时直接上传，否则保存到本地
+void handleSample(const WindowSummary& sample) {
+  bool isConnected = (WiFi.status() == WL_CONNECTED) && !configPortalActive;
+
+  int sensor = findSensorByKey(sample.sensorKey);
+  Serial.print("\n[窗口] ");
+  Serial.print(sensor >= 0 ? SENSOR_TABLE[sensor].id : "(未知传感器)");
+  Serial.print(" ");
+  Serial.print(sample.count);
+  Serial.print(" 条读数，中位数 ");
+  Serial.print(sample.p50Cm, 2);
+  Serial.print(" cm（");
+  Serial.print(sample.minCm, 2);
+  Serial.print(" ~ ");
+  Serial.print(sample.maxCm, 2);
+  Serial.print("，均值 ");
+  Serial.print(sample.meanCm, 2);
+  Serial.print("，标准差 ");
+  Serial.print(sample.stddevCm, 2);
+  Serial.print("，P90 ");
+  Serial.print(sample.p90Cm, 2);
+  Serial.print("，P99 ");
+  Serial.print(sample.p99Cm, 2);
+  Serial.print("）");
+  time_t shownTimestamp = resolveTimestamp(sample.timestamp);
+  if (shownTimestamp > 0) {
+    Serial.print(", 时间: ");
+    Serial.print(formatDateTime(shownTimestamp));
+  } else {
+    Serial.print(", 时间: (未同步，同步后换算)");
+  }
+
+  int storedCount = getStoredDataCount();
+  bool hasPendingData = (storedCount > 0);
+  bool awaitingTimeSync = shownTimestamp < 0 && millis() < TIME_SYNC_UPLOAD_GRACE_MS;
+
+  if (!hasPendingData && isConnected && !awaitingTimeSync) {
+    Serial.print(" | 本地无待上传数据，尝试直接上传...");
+
+    if (uploadSingleData(sample)) {
+      Serial.println(" ✓ 直接上传成功（未保存到本地）");
+    } else {
+      Serial.print(" ✗ 直接上传失败，保存到本地");
+      if (saveDataToStorage(sample)) {
+        Serial.print(" ✓ 已保存");
+        Serial.print(" (本地共 ");
+        Serial.print(getStoredDataCount());
+        Serial.print(" 条)");
+      } else {
+        Serial.print(" ✗ 保存失败");
+      }
+      Serial.println();
+    }
+  } else {
+    if (hasPendingData) {
+      Serial.print(" | 本地有待上传数据，保存到本地");
+    } else if (awaitingTimeSync && isConnected) {
+      Serial.print(" | 时间未同步，保存到本地待换算后上传");
+    } else {
+      Serial.print(" | 网络不可用，保存到本地");
+    }
+
+    if (saveDataToStorage(sample)) {
+      Serial.print(" ✓ 已保存");
+      Serial.print(" (本地共 ");
+      Serial.print(getStoredDataCount());
+      Serial.print(" 条)");
+    } else {
+      Serial.print(" ✗ 保存失败");
+    }
+    Serial.println();
+  }
+}
+
+// 存储/上传任务：上传模块只在这里被调用；存储模块还会被刷写任务与关机回调访问，
+// 由 StorageManager 内部的递归互斥锁串行化，这里调用时无需另外加锁
+void uploadTask(void*) {
+  unsigned long lastUploadCheckTime = 0;
+  uint32_t lastStatsWindows = 0;
+
+  for (;;) {
+    WindowSummary sample;
+    while (popSample(sample)) {
+      handleSample(sample);
+    }
+
+    // 按汇总的窗口数而不是上报的条数打印统计：开启变化上报后上报的窗口可能相隔数小时。
+    // 本任务至少每 UPLOAD_INTERVAL_MAX_MS 醒来一次，统计最多晚这么久打印
+    uint32_t windows = summarizedWindows.load();
+    if (windows / PIPELINE_STATS_WINDOWS != lastStatsWindows / PIPELINE_STATS_WINDOWS) {
+      lastStatsWindows = windows;
+      printPipelineStats(windows);
+    }
+
+    unsigned long now = millis();
+    bool isConnected = (WiFi.status() == WL_CONNECTED) && !configPortalActive;
+    unsigned long uploadInterval = uploadIntervalMs();
+    if (isConnected && now - lastUploadCheckTime >= uploadInterval) {
+      lastUploadCheckTime = now;
+      uploadLocalData();
+    }
+
+    // 有新样本时被采集任务唤醒，否则按（自适应的）上传间隔轮询
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(uploadInterval));
+  }
+}
+}  // namespace
+
+void startPipeline() {
+  if (collectorTaskHandle) {
+    return;
+  }
+  xTaskCreatePinnedToCore(uploadTask, "upload", UPLOAD_TASK_STACK_SIZE, nullptr, UPLOAD_TASK_PRIORITY,
+                          &uploadTaskHandle, UPLOAD_TASK_CORE);
+  xTaskCreatePinnedToCore(collectorTask, "collector", COLLECTOR_TASK_STACK_SIZE, nullptr,
+                          COLLECTOR_TASK_PRIORITY, &collectorTaskHandle, COLLECTOR_TASK_CORE);
+}
+
+CollectorJitterStats getCollectorJitterStats() {
+  portENTER_CRITICAL(&jitterLock);
+  CollectorJitterStats stats = {jitterSamples, lastJitterUs, maxAbsJitterUs,
+                                jitterSamples > 0 ? sumAbsJitterUs / jitterSamples : 0};
+  portEXIT_CRITICAL(&jitterLock);
+  return stats;
+}
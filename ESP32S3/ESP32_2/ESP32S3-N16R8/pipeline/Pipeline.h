@@ -0,0 +1,19 @@
+#pragma once
+
+#include <Arduino.h>
+
+// 双核采集/上传流水线：
+//   采集任务固定在 APP 核（核 1），按 SAMPLE_INTERVAL_MS 绝对周期测距，
+//   每 AGGREGATION_WINDOW_MS 把窗口摘要写入环形队列；
+//   存储/上传任务固定在 PRO 核（核 0，与 Wi-Fi 协议栈同核），负责直接上传、落盘与积压上传。
+// 网络再慢也只会让队列变长，不会推迟采样时刻。
+
+struct CollectorJitterStats {
+  uint32_t samples;
+  int64_t lastJitterUs;
+  int64_t maxAbsJitterUs;
+  int64_t meanAbsJitterUs;
+};
+
+void startPipeline();
+CollectorJitterStats getCollectorJitterStats();
@@ -0,0 +1,46 @@
+#include "SampleRing.h"
+
+#include <atomic>
+
+#include "../config/Config.h"
+
+namespace {
+static_assert((SAMPLE_RING_CAPACITY & (SAMPLE_RING_CAPACITY - 1)) == 0, "SAMPLE_RING_CAPACITY 必须是 2 的幂");
+
+WindowSummary sampleSlots[SAMPLE_RING_CAPACITY];
+// 只增不减的读写计数，下标取低位；写计数只由生产者修改，读计数只由消费者修改
+std::atomic<uint32_t> ringWriteCount{0};
+std::atomic<uint32_t> ringReadCount{0};
+std::atomic<uint32_t> ringDroppedCount{0};
+}  // namespace
+
+bool pushSample(const WindowSummary& sample) {
+  uint32_t write = ringWriteCount.load(std::memory_order_relaxed);
+  uint32_t read = ringReadCount.load(std::memory_order_acquire);
+  if (write - read >= SAMPLE_RING_CAPACITY) {
+    ringDroppedCount.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  sampleSlots[write & (SAMPLE_RING_CAPACITY - 1)] = sample;
+  ringWriteCount.store(write + 1, std::memory_order_release);
+  return true;
+}
+
+bool popSample(WindowSummary& sample) {
+  uint32_t read = ringReadCount.load(std::memory_order_relaxed);
+  uint32_t write = ringWriteCount.load(std::memory_order_acquire);
+  if (read == write) {
+    return false;
+  }
+  sample = sampleSlots[read & (SAMPLE_RING_CAPACITY - 1)];
+  ringReadCount.store(read + 1, std::memory_order_release);
+  return true;
+}
+
+uint32_t pendingSampleCount() {
+  return ringWriteCount.load(std::memory_order_acquire) - ringReadCount.load(std::memory_order_acquire);
+}
+
+uint32_t droppedSampleCount() {
+  return ringDroppedCount.load(std::memory_order_relaxed);
+}
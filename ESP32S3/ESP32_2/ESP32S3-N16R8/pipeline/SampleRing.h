@@ -0,0 +1,14 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "../collector/WindowAggregator.h"
+
+// 采集任务（生产者）与存储/上传任务（消费者）之间的无锁单生产者单消费者环形队列，
+// 每个元素是一个窗口摘要。
+// pushSample 只能由采集任务调用，popSample 只能由存储/上传任务调用。
+
+bool pushSample(const WindowSummary& sample);
+bool popSample(WindowSummary& sample);
+uint32_t pendingSampleCount();
+uint32_t droppedSampleCount();
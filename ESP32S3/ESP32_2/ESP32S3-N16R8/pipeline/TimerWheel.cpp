@@ -0,0 +1,86 @@
+#include "TimerWheel.h"
+
+namespace {
+constexpr uint32_t LEVEL0_BITS = 8;
+constexpr uint32_t LEVEL_BITS = 6;
+constexpr uint32_t LEVEL0_SLOTS = 1u << LEVEL0_BITS;
+constexpr uint32_t LEVEL_SLOTS = 1u << LEVEL_BITS;
+constexpr uint32_t LEVEL1_SPAN = 1u << (LEVEL0_BITS + LEVEL_BITS);
+constexpr uint32_t WHEEL_SPAN = 1u << (LEVEL0_BITS + 2 * LEVEL_BITS);
+
+WheelTimer* level0[LEVEL0_SLOTS];
+WheelTimer* level1[LEVEL_SLOTS];
+WheelTimer* level2[LEVEL_SLOTS];
+uint32_t wheelTick = 0;  // 下一个要处理的刻度
+
+void pushTimer(WheelTimer*& slot, WheelTimer& timer) {
+  timer.next = slot;
+  slot = &timer;
+}
+
+// 按距离下一个刻度的远近放入对应层；已过期的放入下一个刻度，超出范围的截断到最远处
+void placeTimer(WheelTimer& timer) {
+  int32_t delta = (int32_t)(timer.expiresTick - wheelTick);
+  if (delta < 0) {
+    timer.expiresTick = wheelTick;
+    delta = 0;
+  } else if ((uint32_t)delta >= WHEEL_SPAN) {
+    timer.expiresTick = wheelTick + WHEEL_SPAN - 1;
+    delta = WHEEL_SPAN - 1;
+  }
+
+  uint32_t expires = timer.expiresTick;
+  if ((uint32_t)delta < LEVEL0_SLOTS) {
+    pushTimer(level0[expires & (LEVEL0_SLOTS - 1)], timer);
+  } else if ((uint32_t)delta < LEVEL1_SPAN) {
+    pushTimer(level1[(expires >> LEVEL0_BITS) & (LEVEL_SLOTS - 1)], timer);
+  } else {
+    pushTimer(level2[(expires >> (LEVEL0_BITS + LEVEL_BITS)) & (LEVEL_SLOTS - 1)], timer);
+  }
+}
+
+void cascade(WheelTimer*& slot) {
+  WheelTimer* timer = slot;
+  slot = nullptr;
+  while (timer) {
+    WheelTimer* next = timer->next;
+    placeTimer(*timer);
+    timer = next;
+  }
+}
+}  // namespace
+
+void resetTimerWheel(uint32_t nowTick) {
+  memset(level0, 0, sizeof(level0));
+  memset(level1, 0, sizeof(level1));
+  memset(level2, 0, sizeof(level2));
+  wheelTick = nowTick;
+}
+
+void scheduleTimer(WheelTimer& timer, uint32_t expiresTick) {
+  timer.expiresTick = expiresTick;
+  placeTimer(timer);
+}
+
+// 处理到 nowTick（含）为止的所有刻度；回调中可以重新调度同一个定时器
+void advanceTimerWheel(uint32_t nowTick, void (*onExpired)(WheelTimer& timer)) {
+  while ((int32_t)(nowTick - wheelTick) >= 0) {
+    uint32_t index0 = wheelTick & (LEVEL0_SLOTS - 1);
+    if (index0 == 0) {
+      uint32_t index1 = (wheelTick >> LEVEL0_BITS) & (LEVEL_SLOTS - 1);
+      if (index1 == 0) {
+        cascade(level2[(wheelTick >> (LEVEL0_BITS + LEVEL_BITS)) & (LEVEL_SLOTS - 1)]);
+      }
+      cascade(level1[index1]);
+    }
+
+    WheelTimer* timer = level0[index0];
+    level0[index0] = nullptr;
+    wheelTick++;
+    while (timer) {
+      WheelTimer* next = timer->next;
+      onExpired(*timer);
+      timer = next;
+    }
+  }
+}
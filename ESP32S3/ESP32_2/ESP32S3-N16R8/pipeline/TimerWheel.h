@@ -0,0 +1,17 @@
+#pragma once
+
+#include <Arduino.h>
+
+// 分层时间轮（三层：256 × 64 × 64 个槽），用于调度各传感器的采样时刻。
+// 插入与到期处理都是 O(1)：每个刻度只处理当前槽，低层每转一圈时把上一层的一个槽
+// 重新分配到下层。单位为刻度（TIMER_WHEEL_TICK_MS），只能在采集任务中使用。
+
+struct WheelTimer {
+  WheelTimer* next;
+  uint32_t expiresTick;
+  uint16_t sensor;
+};
+
+void resetTimerWheel(uint32_t nowTick);
+void scheduleTimer(WheelTimer& timer, uint32_t expiresTick);
+void advanceTimerWheel(uint32_t nowTick, void (*onExpired)(WheelTimer& timer));
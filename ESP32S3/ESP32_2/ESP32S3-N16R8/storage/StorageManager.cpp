@@ -2,224 +2,589 @@
 
 #include <ArduinoJson.h>
 #include <LittleFS.h>
-
+#include <esp_heap_caps.h>
+#include <esp_rom_crc.h>
+#include <esp_system.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include "../collector/WindowAggregator.h"
 #include "../config/Config.h"
-
-bool saveDataToStorage(float distanceCm, time_t timestamp) {
-  DynamicJsonDocument doc(JSON_DOC_SIZE);
-  int storedCount = 0;
-
-  if (LittleFS.exists(DATA_FILE_PATH)) {
-    File file = LittleFS.open(DATA_FILE_PATH, "r");
-    if (file) {
-      DeserializationError error = deserializeJson(doc, file);
-      file.close();
-      if (!error && doc.containsKey("a")) {
-        JsonArray tempArray = doc["a"].as<JsonArray>();
-        storedCount = tempArray.size();
-      }
+#include "../memory/JsonArena.h"
+#include "SummaryCodec.h"
+
+// 本地存储采用分段日志，每条记录是一个窗口摘要：
+//   /series/00000001.seg ... 每个段文件存放 LOG_SEGMENT_RECORDS 条记录，由若干帧组成：每次提交在文件
+//                            末尾追加一帧，帧头带 CRC32，后面是这次提交的记录编码成的压缩块（见 SummaryCodec）
+//   /series/index.a|b    头指针：头段号、头段内已消费条数与尾段号，带序号与 CRC32，两个槽位轮流写入
+// 尾段解码后常驻内存；追加只写新的一帧，已写入的字节不再改动（LittleFS 在 close 时提交，
+// 掉电时要么有这一帧要么没有）。写满后开始新的尾段，旧段不再改动。
+// 计数由内存中的头尾指针直接算出，批量读取只解码头段一次，批量删除只推进头指针，
+// 整段消费完后直接删除段文件。
+//
+// 启动恢复只读取两个索引槽位与尾段，耗时与积压量无关：取序号最新且校验通过的索引，
+// 跳过已删除的头段，再按尾段的实际条数修正头指针。提交过程中掉电时，
+// 丢失的只是正在提交的这一组数据（暂存队列中的数据本来就只在内存中）。
+//
+// 日志前面有一个位于 PSRAM 的暂存队列（组提交）：新数据先进入队列，
+// 攒够 STAGING_COMMIT_RECORDS 条或最旧一条已暂存 STAGING_COMMIT_INTERVAL_MS
+// 时一次性追加到日志。队列中的数据比日志新，读取与删除都先走日志再走队列，
+// 在提交前就被上传的数据完全不会写入闪存。按时提交与掉电预警都由独立的刷写任务处理，
+// 它从不做网络操作，不会被上传任务的 HTTP 超时拖住。
+
+namespace {
+constexpr uint32_t LOG_INDEX_MAGIC = 0x34474C53;  // "SLG4"
+constexpr size_t LOG_INDEX_SIZE = 24;
+constexpr uint32_t LEGACY_LOG_INDEX_MAGIC = 0x33474C53;  // "SLG3"，单个索引文件、无校验
+
+// 帧头：魔数 + 段号 + 压缩块字节数 + 压缩块的 CRC32，段号防止把改名或残留的旧文件当成当前段
+constexpr uint32_t FRAME_MAGIC = 0x32474553;  // "SEG2"
+constexpr size_t FRAME_HEADER_SIZE = 16;
+// 上一版的段文件整段一个压缩块，前面是魔数 + 段号 + CRC32 的段头；更早的没有段头
+constexpr uint32_t LEGACY_SEGMENT_MAGIC = 0x31474553;  // "SEG1"
+constexpr size_t LEGACY_SEGMENT_HEADER_SIZE = 12;
+
+// 旧版本的分段日志，仅用于迁移：定长记录，每段固定条数
+struct LegacySegmentLog {
+  const char* dir;
+  const char* indexPath;
+  uint32_t indexMagic;
+  size_t recordSize;
+  uint32_t segmentRecords;
+  void (*decode)(const uint8_t* in, WindowSummary& summary);
+};
+
+struct LogState {
+  uint32_t headSegment = 1;
+  uint32_t headOffset = 0;
+  uint32_t tailSegment = 1;
+  uint32_t tailCount = 0;
+  uint32_t indexSequence = 0;
+  size_t budgetBytes = 0;
+  bool ready = false;
+};
+
+LogState logState;
+
+// 解码后的段：尾段的全部记录常驻内存；头段与尾段不同时，第一次读取时解码一次
+WindowSummary* tailRecords = nullptr;
+WindowSummary* headRecords = nullptr;
+uint32_t headRecordsSegment = 0;  // 0 表示未加载
+uint8_t* segmentBuffer = nullptr;
+size_t segmentBufferSize = 0;
+
+struct StagingState {
+  WindowSummary* records = nullptr;
+  uint32_t capacity = 0;
+  uint32_t head = 0;
+  uint32_t count = 0;
+  unsigned long oldestStagedAt = 0;
+};
+
+StagingState staging;
+TaskHandle_t storageFlushTaskHandle = nullptr;
+
+// 正常情况下只有存储/上传任务访问存储；关机回调可能在另一个核上触发，
+// 因此公开接口统一持有递归互斥锁
+SemaphoreHandle_t storageMutex = nullptr;
+
+struct StorageLock {
+  bool held;
+  explicit StorageLock(TickType_t wait = portMAX_DELAY)
+      : held(storageMutex && xSemaphoreTakeRecursive(storageMutex, wait) == pdTRUE) {}
+  ~StorageLock() {
+    if (held) {
+      xSemaphoreGiveRecursive(storageMutex);
     }
   }
+};
 
-  JsonArray dataArray = doc["a"].as<JsonArray>();
-  if (dataArray.isNull()) {
-    doc.remove("a");
-    dataArray = doc.createNestedArray("a");
-    doc["c"] = 0;
-    storedCount = 0;
-  }
-
-  size_t freeHeap = ESP.getFreeHeap();
-  int deletedCount = 0;
-
-  while (freeHeap < MIN_FREE_HEAP && dataArray.size() > 0) {
-    if (deletedCount == 0) {
-      Serial.print("[警告] 可用内存不足 (");
-      Serial.print(freeHeap);
-      Serial.print(" 字节 < ");
-      Serial.print(MIN_FREE_HEAP);
-      Serial.println(" 字节)，开始删除最旧的数据");
-    }
+String segmentPath(uint32_t segment, const char* dir = DATA_LOG_DIR) {
+  char path[32];
+  snprintf(path, sizeof(path), "%s/%08lu.seg", dir, (unsigned long)segment);
+  return String(path);
+}
 
-    dataArray.remove(0);
-    storedCount--;
-    deletedCount++;
+void* allocateStorageBuffer(size_t bytes) {
+  void* buffer = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  return buffer ? buffer : malloc(bytes);
+}
 
-    freeHeap = ESP.getFreeHeap();
+bool allocateSegmentBuffers() {
+  if (segmentBuffer) {
+    return true;
   }
-
-  if (deletedCount > 0) {
-    Serial.print("[信息] 已删除 ");
-    Serial.print(deletedCount);
-    Serial.print(" 条最旧数据，当前可用内存: ");
-    Serial.print(freeHeap);
-    Serial.print(" 字节，剩余数据: ");
-    Serial.print(storedCount);
-    Serial.println(" 条");
+  tailRecords = (WindowSummary*)allocateStorageBuffer(LOG_SEGMENT_RECORDS * sizeof(WindowSummary));
+  headRecords = (WindowSummary*)allocateStorageBuffer(LOG_SEGMENT_RECORDS * sizeof(WindowSummary));
+  segmentBufferSize = FRAME_HEADER_SIZE + summaryBlockBound(LOG_SEGMENT_RECORDS);
+  segmentBuffer = (uint8_t*)allocateStorageBuffer(segmentBufferSize);
+  if (tailRecords && headRecords && segmentBuffer) {
+    return true;
   }
+  free(tailRecords);
+  free(headRecords);
+  free(segmentBuffer);
+  tailRecords = nullptr;
+  headRecords = nullptr;
+  segmentBuffer = nullptr;
+  return false;
+}
 
-  JsonArray newRecord = dataArray.createNestedArray();
-  newRecord.add(distanceCm);
-  newRecord.add((uint64_t)timestamp);
-  doc["c"] = dataArray.size();
+uint32_t storageCrc32(const uint8_t* data, size_t length) {
+  return esp_rom_crc32_le(0, data, length);
+}
 
-  File file = LittleFS.open(DATA_FILE_PATH, "w");
-  if (!file) {
-    Serial.println("[错误] 无法打开文件进行写入");
+// mode 为 "a" 时在段文件末尾追加一帧，为 "w" 时整个文件重写为这一帧
+bool writeSegmentFrame(uint32_t segment, const WindowSummary* records, uint32_t count, const char* mode) {
+  uint8_t* block = segmentBuffer + FRAME_HEADER_SIZE;
+  size_t blockBytes = encodeSummaryBlock(records, count, block, segmentBufferSize - FRAME_HEADER_SIZE);
+  if (blockBytes == 0) {
     return false;
   }
+  uint32_t header[4] = {FRAME_MAGIC, segment, (uint32_t)blockBytes, storageCrc32(block, blockBytes)};
+  memcpy(segmentBuffer, header, sizeof(header));
 
-  serializeJson(doc, file);
+  size_t bytes = FRAME_HEADER_SIZE + blockBytes;
+  File file = LittleFS.open(segmentPath(segment), mode);
+  if (!file) {
+    return false;
+  }
+  size_t written = file.write(segmentBuffer, bytes);
   file.close();
-
-  return true;
+  return written == bytes;
 }
 
-int getStoredDataCount() {
-  if (!LittleFS.exists(DATA_FILE_PATH)) {
-    return 0;
+// 上一版整段一个压缩块的段文件
+int readLegacySegmentFile(File& file, uint32_t segment, size_t size, WindowSummary* records) {
+  if (size > segmentBufferSize || file.read(segmentBuffer, size) != size) {
+    return -1;
+  }
+  const uint8_t* block = segmentBuffer;
+  size_t blockBytes = size;
+  uint32_t header[3];
+  memcpy(header, segmentBuffer, size >= sizeof(header) ? sizeof(header) : 0);
+  if (size >= sizeof(header) && header[0] == LEGACY_SEGMENT_MAGIC) {
+    block += LEGACY_SEGMENT_HEADER_SIZE;
+    blockBytes -= LEGACY_SEGMENT_HEADER_SIZE;
+    if (header[1] != segment || header[2] != storageCrc32(block, blockBytes)) {
+      return -1;
+    }
   }
+  uint32_t decoded = decodeSummaryBlock(block, blockBytes, records, LOG_SEGMENT_RECORDS);
+  return decoded > 0 ? (int)decoded : -1;
+}
 
-  File file = LittleFS.open(DATA_FILE_PATH, "r");
+// 返回解码的条数；段文件不存在时返回 0，无法解码时返回 -1。逐帧解码，遇到残缺或校验失败的帧时
+// 停止并返回之前各帧的条数。appendable 表示可以直接在文件末尾追加：文件不存在，或全部是完好的帧
+int readSegmentFile(uint32_t segment, WindowSummary* records, bool* appendable = nullptr) {
+  if (appendable) {
+    *appendable = false;
+  }
+  File file = LittleFS.open(segmentPath(segment), "r");
   if (!file) {
+    if (appendable) {
+      *appendable = true;
+    }
     return 0;
   }
-
-  DynamicJsonDocument doc(JSON_DOC_SIZE);
-  DeserializationError error = deserializeJson(doc, file);
+  size_t size = file.size();
+  uint32_t header[4];
+  if (size < FRAME_HEADER_SIZE || file.read((uint8_t*)header, FRAME_HEADER_SIZE) != FRAME_HEADER_SIZE ||
+      header[0] != FRAME_MAGIC) {
+    int decoded = size == 0 ? 0 : (file.seek(0) ? readLegacySegmentFile(file, segment, size, records) : -1);
+    file.close();
+    return decoded;
+  }
+
+  uint32_t total = 0;
+  size_t offset = 0;
+  bool intact = true;
+  while (true) {
+    uint32_t blockBytes = header[2];
+    if (header[0] != FRAME_MAGIC || header[1] != segment || blockBytes > segmentBufferSize ||
+        blockBytes > size - offset - FRAME_HEADER_SIZE || file.read(segmentBuffer, blockBytes) != blockBytes ||
+        header[3] != storageCrc32(segmentBuffer, blockBytes)) {
+      intact = false;
+      break;
+    }
+    uint32_t decoded = decodeSummaryBlock(segmentBuffer, blockBytes, records + total, LOG_SEGMENT_RECORDS - total);
+    if (decoded == 0) {
+      intact = false;
+      break;
+    }
+    total += decoded;
+    offset += FRAME_HEADER_SIZE + blockBytes;
+    if (offset == size) {
+      break;
+    }
+    if (size - offset < FRAME_HEADER_SIZE || file.read((uint8_t*)header, FRAME_HEADER_SIZE) != FRAME_HEADER_SIZE) {
+      intact = false;
+      break;
+    }
+  }
   file.close();
+  if (appendable) {
+    *appendable = intact;
+  }
+  return (total > 0 || intact) ? (int)total : -1;
+}
 
-  if (error) {
-    return 0;
+// 按内存中的记录把尾段整个重写为一帧：尾段是旧格式、末尾有残缺的帧，或追加失败可能留下半帧时使用，
+// 之后的追加才能接在有效数据后面
+bool rewriteTailSegment() {
+  if (logState.tailCount == 0) {
+    String path = segmentPath(logState.tailSegment);
+    return !LittleFS.exists(path) || LittleFS.remove(path);
   }
+  return writeSegmentFrame(logState.tailSegment, tailRecords, logState.tailCount, "w");
+}
 
-  if (doc.containsKey("a")) {
-    JsonArray dataArray = doc["a"].as<JsonArray>();
-    return dataArray.size();
+// 两个槽位轮流写入，写入中途掉电或某个槽位损坏时，另一个槽位仍保留上一次的头指针
+bool writeLogIndex() {
+  logState.indexSequence++;
+  uint32_t fields[6] = {LOG_INDEX_MAGIC,        logState.indexSequence, logState.headSegment,
+                        logState.headOffset,    logState.tailSegment,   0};
+  fields[5] = storageCrc32((const uint8_t*)fields, LOG_INDEX_SIZE - sizeof(uint32_t));
+
+  File file = LittleFS.open(DATA_LOG_INDEX_PATHS[logState.indexSequence & 1], "w");
+  if (!file) {
+    Serial.println("[错误] 无法写入存储索引");
+    return false;
   }
+  size_t written = file.write((const uint8_t*)fields, LOG_INDEX_SIZE);
+  file.close();
+  return written == LOG_INDEX_SIZE;
+}
 
-  return 0;
+bool indexFieldsValid(uint32_t headSegment, uint32_t headOffset, uint32_t tailSegment) {
+  return headSegment > 0 && tailSegment >= headSegment && headOffset <= LOG_SEGMENT_RECORDS;
 }
 
-bool readFirstDataFromStorage(float& distance, time_t& timestamp) {
-  if (!LittleFS.exists(DATA_FILE_PATH)) {
+bool readIndexSlot(const char* path, uint32_t fields[6]) {
+  File file = LittleFS.open(path, "r");
+  if (!file) {
     return false;
   }
+  size_t readBytes = file.read((uint8_t*)fields, LOG_INDEX_SIZE);
+  file.close();
+  return readBytes == LOG_INDEX_SIZE && fields[0] == LOG_INDEX_MAGIC &&
+         fields[5] == storageCrc32((const uint8_t*)fields, LOG_INDEX_SIZE - sizeof(uint32_t)) &&
+         indexFieldsValid(fields[2], fields[3], fields[4]);
+}
 
-  File file = LittleFS.open(DATA_FILE_PATH, "r");
+// 加入校验之前的单个索引文件，读取后由新格式的索引取代
+bool readLegacyLogIndex() {
+  File file = LittleFS.open(DATA_LOG_INDEX_PATH, "r");
   if (!file) {
     return false;
   }
-
-  DynamicJsonDocument doc(JSON_DOC_SIZE);
-  DeserializationError error = deserializeJson(doc, file);
+  uint32_t fields[4];
+  size_t readBytes = file.read((uint8_t*)fields, sizeof(fields));
   file.close();
-
-  if (error) {
+  LittleFS.remove(DATA_LOG_INDEX_PATH);
+  if (readBytes != sizeof(fields) || fields[0] != LEGACY_LOG_INDEX_MAGIC ||
+      !indexFieldsValid(fields[1], fields[2], fields[3])) {
     return false;
   }
+  logState.headSegment = fields[1];
+  logState.headOffset = fields[2];
+  logState.tailSegment = fields[3];
+  writeLogIndex();
+  return true;
+}
 
-  if (!doc.containsKey("a")) {
-    return false;
+bool readLogIndex() {
+  uint32_t slots[2][6];
+  bool valid[2];
+  for (int i = 0; i < 2; i++) {
+    valid[i] = readIndexSlot(DATA_LOG_INDEX_PATHS[i], slots[i]);
+  }
+  if (!valid[0] && !valid[1]) {
+    return readLegacyLogIndex();
   }
 
-  JsonArray dataArray = doc["a"].as<JsonArray>();
-  if (dataArray.size() == 0) {
-    return false;
+  // 序号按回绕比较，取较新的一个
+  int newest = !valid[0] ? 1 : (!valid[1] ? 0 : ((int32_t)(slots[1][1] - slots[0][1]) > 0 ? 1 : 0));
+  if (!valid[1 - newest] && LittleFS.exists(DATA_LOG_INDEX_PATHS[1 - newest])) {
+    Serial.println("[存储] 一个索引槽位校验失败，使用另一个槽位中的头指针");
   }
+  logState.indexSequence = slots[newest][1];
+  logState.headSegment = slots[newest][2];
+  logState.headOffset = slots[newest][3];
+  logState.tailSegment = slots[newest][4];
+  return true;
+}
 
-  JsonArray record = dataArray[0];
-  if (record.size() >= 2) {
-    distance = record[0].as<float>();
-    timestamp = (time_t)record[1].as<uint64_t>();
-    return true;
+// 扫描目录中的段文件，得到最小与最大段号（没有段文件时均为 0）
+void scanSegmentRange(const char* path, uint32_t& minSegment, uint32_t& maxSegment) {
+  minSegment = 0;
+  maxSegment = 0;
+
+  File dir = LittleFS.open(path);
+  if (dir && dir.isDirectory()) {
+    File entry = dir.openNextFile();
+    while (entry) {
+      String name = entry.name();
+      entry.close();
+      if (name.endsWith(".seg")) {
+        int slash = name.lastIndexOf('/');
+        uint32_t segment = (uint32_t)strtoul(name.c_str() + slash + 1, nullptr, 10);
+        if (segment > 0) {
+          if (minSegment == 0 || segment < minSegment) {
+            minSegment = segment;
+          }
+          if (segment > maxSegment) {
+            maxSegment = segment;
+          }
+        }
+      }
+      entry = dir.openNextFile();
+    }
+    dir.close();
   }
+}
 
-  return false;
+// 索引丢失时根据目录中的段文件重建头尾段号
+void rebuildLogIndexFromSegments() {
+  uint32_t minSegment = 0;
+  uint32_t maxSegment = 0;
+  scanSegmentRange(DATA_LOG_DIR, minSegment, maxSegment);
+
+  logState.headSegment = minSegment > 0 ? minSegment : 1;
+  logState.headOffset = 0;
+  logState.tailSegment = maxSegment > 0 ? maxSegment : logState.headSegment;
+  writeLogIndex();
 }
 
-void removeFirstDataFromStorage() {
-  if (!LittleFS.exists(DATA_FILE_PATH)) {
-    return;
+void loadTailSegment() {
+  bool appendable = false;
+  int decoded = readSegmentFile(logState.tailSegment, tailRecords, &appendable);
+  if (decoded < 0) {
+    Serial.print("[警告] 尾段 ");
+    Serial.print(logState.tailSegment);
+    Serial.println(" 无法解码，将被新数据覆盖");
+    decoded = 0;
+  }
+  logState.tailCount = (uint32_t)decoded;
+  if (!appendable && !rewriteTailSegment()) {
+    Serial.println("[警告] 尾段重写失败，下次追加时重试");
   }
+}
 
-  File file = LittleFS.open(DATA_FILE_PATH, "r");
-  if (!file) {
+uint32_t segmentsInUse() {
+  return logState.tailSegment - logState.headSegment + 1;
+}
+
+uint32_t recordsInHeadSegment() {
+  uint32_t end = (logState.headSegment == logState.tailSegment) ? logState.tailCount : LOG_SEGMENT_RECORDS;
+  return end > logState.headOffset ? end - logState.headOffset : 0;
+}
+
+void advanceHeadSegment() {
+  LittleFS.remove(segmentPath(logState.headSegment));
+  logState.headSegment++;
+  logState.headOffset = 0;
+}
+
+// 超出存储预算时整段丢弃最旧的数据
+void dropHeadSegment() {
+  if (logState.headSegment == logState.tailSegment) {
     return;
   }
+  uint32_t dropped = recordsInHeadSegment();
+  advanceHeadSegment();
+  writeLogIndex();
 
-  DynamicJsonDocument doc(JSON_DOC_SIZE);
-  DeserializationError error = deserializeJson(doc, file);
-  file.close();
+  Serial.print("[警告] 本地存储已达预算上限，已删除最旧的 ");
+  Serial.print(dropped);
+  Serial.print(" 条数据，剩余数据: ");
+  Serial.print(getStoredDataCount());
+  Serial.println(" 条");
+}
 
-  if (error) {
-    return;
+// 压缩后每段的大小随数据变化，按文件系统的实际占用控制预算
+void enforceStorageBudget() {
+  while (segmentsInUse() > 1 && LittleFS.usedBytes() > logState.budgetBytes) {
+    dropHeadSegment();
   }
+}
 
-  if (!doc.containsKey("a")) {
-    return;
+// 头段与尾段不同时解码头段；完整的旧段必须恰好有 LOG_SEGMENT_RECORDS 条
+bool loadHeadSegment() {
+  if (logState.headSegment == logState.tailSegment || headRecordsSegment == logState.headSegment) {
+    return true;
   }
+  headRecordsSegment = 0;
+  if (readSegmentFile(logState.headSegment, headRecords) != (int)LOG_SEGMENT_RECORDS) {
+    return false;
+  }
+  headRecordsSegment = logState.headSegment;
+  return true;
+}
 
-  JsonArray dataArray = doc["a"].as<JsonArray>();
-  if (dataArray.size() == 0) {
-    return;
+// 连续追加多条记录：每个尾段在文件末尾追加一帧，写满一段后开始新的尾段；返回成功写入的条数
+uint32_t appendSummaries(const WindowSummary* summaries, uint32_t count) {
+  uint32_t appended = 0;
+  while (appended < count) {
+    if (logState.tailCount >= LOG_SEGMENT_RECORDS) {
+      logState.tailSegment++;
+      logState.tailCount = 0;
+      writeLogIndex();
+      enforceStorageBudget();
+    }
+
+    uint32_t room = LOG_SEGMENT_RECORDS - logState.tailCount;
+    uint32_t chunk = (count - appended < room) ? count - appended : room;
+    if (!writeSegmentFrame(logState.tailSegment, summaries + appended, chunk, "a")) {
+      rewriteTailSegment();
+      break;
+    }
+    memcpy(tailRecords + logState.tailCount, summaries + appended, chunk * sizeof(WindowSummary));
+    logState.tailCount += chunk;
+    appended += chunk;
   }
+  return appended;
+}
 
-  dataArray.remove(0);
-  doc["c"] = dataArray.size();
+WindowSummary& stagedRecord(uint32_t index) {
+  return staging.records[(staging.head + index) % staging.capacity];
+}
 
-  file = LittleFS.open(DATA_FILE_PATH, "w");
-  if (file) {
-    serializeJson(doc, file);
-    file.close();
+void popStaged(uint32_t count) {
+  staging.head = (staging.head + count) % staging.capacity;
+  staging.count -= count;
+  if (staging.count == 0) {
+    staging.head = 0;
+  } else {
+    staging.oldestStagedAt = millis();
   }
 }
 
-int readBatchDataFromStorage(float* distances, time_t* timestamps, int maxCount) {
-  if (!LittleFS.exists(DATA_FILE_PATH)) {
-    return 0;
+// 将暂存队列整体追加到日志；环形缓冲区最多分两段连续写入
+bool commitStaged() {
+  while (staging.count > 0) {
+    uint32_t contiguous = staging.capacity - staging.head;
+    uint32_t chunk = (staging.count < contiguous) ? staging.count : contiguous;
+    uint32_t appended = appendSummaries(&stagedRecord(0), chunk);
+    if (appended == 0 && segmentsInUse() > 1) {
+      dropHeadSegment();
+      appended = appendSummaries(&stagedRecord(0), chunk);
+    }
+    if (appended == 0) {
+      Serial.println("[错误] 暂存数据提交失败，保留在内存中稍后重试");
+      return false;
+    }
+    popStaged(appended);
   }
+  return true;
+}
 
-  File file = LittleFS.open(DATA_FILE_PATH, "r");
-  if (!file) {
-    return 0;
+bool stageRecord(const WindowSummary& summary) {
+  if (staging.count >= staging.capacity && !commitStaged()) {
+    Serial.println("[警告] 暂存队列已满且无法提交，丢弃最旧的一条暂存数据");
+    popStaged(1);
   }
+  if (staging.count == 0) {
+    staging.oldestStagedAt = millis();
+  }
+  stagedRecord(staging.count) = summary;
+  staging.count++;
 
-  DynamicJsonDocument doc(JSON_DOC_SIZE);
-  DeserializationError error = deserializeJson(doc, file);
-  file.close();
+  if (staging.count >= STAGING_COMMIT_RECORDS) {
+    commitStaged();
+  }
+  return true;
+}
 
-  if (error) {
-    return 0;
+void allocateStaging() {
+  if (staging.records) {
+    return;
+  }
+  staging.records = (WindowSummary*)allocateStorageBuffer(STAGING_CAPACITY * sizeof(WindowSummary));
+  if (!staging.records) {
+    Serial.println("[警告] 无法分配暂存队列，数据将直接写入闪存");
+    return;
   }
+  staging.capacity = STAGING_CAPACITY;
+}
 
-  if (!doc.containsKey("a")) {
-    return 0;
+// 掉电预警直接唤醒刷写任务，不经过上传任务
+void IRAM_ATTR onPowerFail() {
+  BaseType_t woken = pdFALSE;
+  if (storageFlushTaskHandle) {
+    vTaskNotifyGiveFromISR(storageFlushTaskHandle, &woken);
   }
+  portYIELD_FROM_ISR(woken);
+}
 
-  JsonArray dataArray = doc["a"].as<JsonArray>();
-  int arraySize = dataArray.size();
-  if (arraySize == 0) {
-    return 0;
+// 刷写任务：睡到最旧一条暂存数据到期时提交，收到掉电预警时立即提交。
+// 提交最多等待正在进行的一次闪存操作（存储锁从不跨网络请求持有）
+void storageFlushTask(void*) {
+  for (;;) {
+    unsigned long waitMs = STAGING_COMMIT_INTERVAL_MS;
+    {
+      StorageLock lock;
+      unsigned long age = staging.count > 0 ? millis() - staging.oldestStagedAt : 0;
+      // 已到期说明上一次提交失败，隔一个周期再重试
+      if (age < STAGING_COMMIT_INTERVAL_MS) {
+        waitMs = STAGING_COMMIT_INTERVAL_MS - age;
+      }
+    }
+    if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs)) > 0) {
+      // 掉电时间窗很短：先提交，再打印日志
+      flushStorage();
+      Serial.println("[存储] 检测到掉电预警，已立即提交暂存数据");
+      continue;
+    }
+    StorageLock lock;
+    if (logState.ready && staging.count > 0 && millis() - staging.oldestStagedAt >= STAGING_COMMIT_INTERVAL_MS) {
+      commitStaged();
+    }
   }
+}
 
-  int readCount = (arraySize < maxCount) ? arraySize : maxCount;
+void flushOnShutdown() {
+  StorageLock lock(pdMS_TO_TICKS(2000));
+  if (lock.held && logState.ready) {
+    commitStaged();
+  }
+}
 
-  for (int i = 0; i < readCount; i++) {
-    JsonArray record = dataArray[i];
-    if (record.size() >= 2) {
-      distances[i] = record[0].as<float>();
-      timestamps[i] = (time_t)record[1].as<uint64_t>();
-    } else {
-      return i;
-    }
+// 迁移旧版数据时攒满一段再追加，整段编码为一帧，避免每条记录一帧
+struct MigrationBatch {
+  WindowSummary* records;
+  uint32_t count;
+  uint32_t migrated;
+  bool failed;
+};
+
+bool beginMigrationBatch(MigrationBatch& batch) {
+  batch = {(WindowSummary*)malloc(LOG_SEGMENT_RECORDS * sizeof(WindowSummary)), 0, 0, false};
+  return batch.records != nullptr;
+}
+
+bool flushMigrationBatch(MigrationBatch& batch) {
+  if (batch.count > 0 && !batch.failed) {
+    uint32_t appended = appendSummaries(batch.records, batch.count);
+    batch.migrated += appended;
+    batch.failed = appended != batch.count;
   }
+  batch.count = 0;
+  return !batch.failed;
+}
 
-  return readCount;
+bool addToMigrationBatch(MigrationBatch& batch, const WindowSummary& summary) {
+  if (batch.count >= LOG_SEGMENT_RECORDS && !flushMigrationBatch(batch)) {
+    return false;
+  }
+  batch.records[batch.count++] = summary;
+  return true;
 }
 
-void removeBatchDataFromStorage(int count) {
-  if (!LittleFS.exists(DATA_FILE_PATH) || count <= 0) {
+// 最早的版本将全部数据存放在 /sensor_data.json 中，首次启动时导入日志后删除
+void migrateLegacyJsonStore() {
+  if (!LittleFS.exists(DATA_FILE_PATH)) {
     return;
   }
 
@@ -227,37 +592,328 @@ void removeBatchDataFromStorage(int count) {
   if (!file) {
     return;
   }
-
-  DynamicJsonDocument doc(JSON_DOC_SIZE);
+  ArenaJsonDocument doc(jsonArenaAvailable());
   DeserializationError error = deserializeJson(doc, file);
   file.close();
 
-  if (error) {
+  if (error == DeserializationError::NoMemory) {
+    Serial.println("[错误] JSON 内存池不足，暂不迁移旧版数据");
     return;
   }
 
-  if (!doc.containsKey("a")) {
+  MigrationBatch batch;
+  if (!beginMigrationBatch(batch)) {
     return;
   }
+  if (!error && doc.containsKey("a")) {
+    JsonArray dataArray = doc["a"].as<JsonArray>();
+    for (JsonArray item : dataArray) {
+      if (item.size() < 2) {
+        continue;
+      }
+      if (!addToMigrationBatch(batch, summaryFromReading(item[0].as<float>(), (time_t)item[1].as<uint64_t>()))) {
+        break;
+      }
+    }
+  }
+  flushMigrationBatch(batch);
+  free(batch.records);
+
+  LittleFS.remove(DATA_FILE_PATH);
+  Serial.print("[存储] 已从旧版 JSON 文件迁移 ");
+  Serial.print(batch.migrated);
+  Serial.println(" 条数据");
+}
+
+// 第二版日志：每条记录是一次读数（float 距离 + int64 时间戳）
+void decodeReadingRecord(const uint8_t* in, WindowSummary& summary) {
+  float distanceCm;
+  int64_t ts;
+  memcpy(&distanceCm, in, sizeof(distanceCm));
+  memcpy(&ts, in + sizeof(distanceCm), sizeof(ts));
+  summary = summaryFromReading(distanceCm, (time_t)ts);
+}
 
-  JsonArray dataArray = doc["a"].as<JsonArray>();
-  int arraySize = dataArray.size();
-  if (arraySize == 0) {
+// 第三版日志：未压缩的窗口摘要，int64 时间戳 + uint32 跨度 + uint16 条数 + uint16 传感器键 + 7 个 float
+void decodeRawSummaryRecord(const uint8_t* in, WindowSummary& summary) {
+  int64_t ts = 0;
+  float stats[7];
+  memcpy(&ts, in, sizeof(ts));
+  memcpy(&summary.spanMs, in + 8, sizeof(summary.spanMs));
+  memcpy(&summary.count, in + 12, sizeof(summary.count));
+  memcpy(&summary.sensorKey, in + 14, sizeof(summary.sensorKey));
+  memcpy(stats, in + 16, sizeof(stats));
+  summary.timestamp = (time_t)ts;
+  summary.minCm = stats[0];
+  summary.maxCm = stats[1];
+  summary.meanCm = stats[2];
+  summary.stddevCm = stats[3];
+  summary.p50Cm = stats[4];
+  summary.p90Cm = stats[5];
+  summary.p99Cm = stats[6];
+}
+
+const LegacySegmentLog LEGACY_READING_LOG = {LEGACY_LOG_DIR, LEGACY_LOG_INDEX_PATH, 0x31474C53, 12, 340,
+                                             decodeReadingRecord};
+const LegacySegmentLog LEGACY_SUMMARY_LOG = {LEGACY_SUMMARY_LOG_DIR, LEGACY_SUMMARY_LOG_INDEX_PATH, 0x32474C53, 44, 93,
+                                             decodeRawSummaryRecord};
+
+// 旧版分段日志首次启动时逐段导入；每段导入后立即删除，导入过程中掉电最多重复导入一段
+void migrateLegacySegmentLog(const LegacySegmentLog& format) {
+  if (!LittleFS.exists(format.dir)) {
     return;
   }
 
-  int deleteCount = (arraySize < count) ? arraySize : count;
-
-  for (int i = 0; i < deleteCount; i++) {
-    dataArray.remove(0);
+  uint32_t headSegment = 0;
+  uint32_t headOffset = 0;
+  uint32_t tailSegment = 0;
+  File indexFile = LittleFS.open(format.indexPath, "r");
+  if (indexFile) {
+    uint32_t fields[4];
+    if (indexFile.read((uint8_t*)fields, sizeof(fields)) == sizeof(fields) && fields[0] == format.indexMagic) {
+      headSegment = fields[1];
+      headOffset = fields[2];
+      tailSegment = fields[3];
+    }
+    indexFile.close();
+  }
+  if (headSegment == 0) {
+    scanSegmentRange(format.dir, headSegment, tailSegment);
+    headOffset = 0;
   }
 
-  doc["c"] = dataArray.size();
+  size_t segmentBytes = format.segmentRecords * format.recordSize;
+  uint8_t* buffer = (uint8_t*)malloc(segmentBytes);
+  MigrationBatch batch;
+  if (!buffer || !beginMigrationBatch(batch)) {
+    free(buffer);
+    return;
+  }
 
-  file = LittleFS.open(DATA_FILE_PATH, "w");
-  if (file) {
-    serializeJson(doc, file);
+  bool complete = true;
+  for (uint32_t segment = headSegment; segment > 0 && segment <= tailSegment && complete; segment++) {
+    String path = segmentPath(segment, format.dir);
+    File file = LittleFS.open(path, "r");
+    if (!file) {
+      continue;
+    }
+    size_t size = file.read(buffer, segmentBytes);
     file.close();
+
+    WindowSummary summary;
+    size_t offset = (segment == headSegment) ? headOffset * format.recordSize : 0;
+    for (; offset + format.recordSize <= size && complete; offset += format.recordSize) {
+      format.decode(buffer + offset, summary);
+      complete = addToMigrationBatch(batch, summary);
+    }
+    complete = complete && flushMigrationBatch(batch);
+    if (complete) {
+      LittleFS.remove(path);
+    }
+  }
+  free(buffer);
+  free(batch.records);
+
+  if (complete) {
+    LittleFS.remove(format.indexPath);
+    LittleFS.rmdir(format.dir);
+  }
+  Serial.print("[存储] 已从旧版分段日志（");
+  Serial.print(format.dir);
+  Serial.print("）迁移 ");
+  Serial.print(batch.migrated);
+  Serial.println(complete ? " 条数据" : " 条数据，空间不足，剩余数据下次启动继续迁移");
+}
+}  // namespace
+
+bool beginStorage() {
+  if (!storageMutex) {
+    storageMutex = xSemaphoreCreateRecursiveMutex();
   }
+  StorageLock lock;
+  logState = LogState();
+  headRecordsSegment = 0;
+
+  if (!allocateSegmentBuffers()) {
+    Serial.println("[错误] 无法分配日志段缓冲区");
+    return false;
+  }
+  if (!LittleFS.exists(DATA_LOG_DIR) && !LittleFS.mkdir(DATA_LOG_DIR)) {
+    Serial.println("[错误] 无法创建存储目录");
+    return false;
+  }
+
+  unsigned long recoveryStartedAt = millis();
+  if (!readLogIndex()) {
+    rebuildLogIndexFromSegments();
+  }
+  // 删除段文件后、写入索引前掉电时，跳过已不存在的头段
+  bool indexRepaired = false;
+  while (logState.headSegment < logState.tailSegment && !LittleFS.exists(segmentPath(logState.headSegment))) {
+    logState.headSegment++;
+    logState.headOffset = 0;
+    indexRepaired = true;
+  }
+  loadTailSegment();
+  // 尾段丢失或损坏时，头指针不能越过尾段的实际条数
+  if (logState.headSegment == logState.tailSegment && logState.headOffset > logState.tailCount) {
+    logState.headOffset = logState.tailCount;
+    indexRepaired = true;
+  }
+  if (indexRepaired) {
+    writeLogIndex();
+  }
+  unsigned long recoveryMs = millis() - recoveryStartedAt;
+
+  logState.budgetBytes = LittleFS.totalBytes() / 100 * STORAGE_BUDGET_PERCENT;
+  logState.ready = true;
+
+  migrateLegacyJsonStore();
+  migrateLegacySegmentLog(LEGACY_READING_LOG);
+  migrateLegacySegmentLog(LEGACY_SUMMARY_LOG);
+  enforceStorageBudget();
+
+  allocateStaging();
+  static bool hooksInstalled = false;
+  if (!hooksInstalled) {
+    esp_register_shutdown_handler(flushOnShutdown);
+    xTaskCreatePinnedToCore(storageFlushTask, "flush", STORAGE_FLUSH_TASK_STACK_SIZE, nullptr,
+                            STORAGE_FLUSH_TASK_PRIORITY, &storageFlushTaskHandle, UPLOAD_TASK_CORE);
+    if (STORAGE_POWER_FAIL_PIN >= 0) {
+      pinMode(STORAGE_POWER_FAIL_PIN, INPUT_PULLUP);
+      attachInterrupt(digitalPinToInterrupt(STORAGE_POWER_FAIL_PIN), onPowerFail, FALLING);
+    }
+    hooksInstalled = true;
+  }
+
+  Serial.print("[存储] 日志段 ");
+  Serial.print(logState.headSegment);
+  Serial.print(" ~ ");
+  Serial.print(logState.tailSegment);
+  Serial.print("，恢复用时 ");
+  Serial.print(recoveryMs);
+  Serial.print(" ms，文件系统已用 ");
+  Serial.print((unsigned long)(LittleFS.usedBytes() / 1024));
+  Serial.print(" KB，预算上限 ");
+  Serial.print((unsigned long)(logState.budgetBytes / 1024));
+  Serial.println(" KB");
+  return true;
+}
+
+bool saveDataToStorage(const WindowSummary& summary) {
+  StorageLock lock;
+  if (!logState.ready) {
+    return false;
+  }
+
+  if (staging.records) {
+    return stageRecord(summary);
+  }
+  if (appendSummaries(&summary, 1) == 1) {
+    return true;
+  }
+
+  // 文件系统写满时先腾出最旧的段再重试一次
+  if (segmentsInUse() > 1) {
+    dropHeadSegment();
+    if (appendSummaries(&summary, 1) == 1) {
+      return true;
+    }
+  }
+  Serial.println("[错误] 无法写入存储日志");
+  return false;
+}
+
+int getStoredDataCount() {
+  StorageLock lock;
+  if (!logState.ready) {
+    return 0;
+  }
+  uint32_t fullSegments = logState.tailSegment - logState.headSegment;
+  return (int)(fullSegments * LOG_SEGMENT_RECORDS + logState.tailCount - logState.headOffset + staging.count);
 }
 
+bool flushStorage() {
+  StorageLock lock;
+  if (!logState.ready) {
+    return false;
+  }
+  return commitStaged();
+}
+
+bool readFirstDataFromStorage(WindowSummary& summary) {
+  return readBatchDataFromStorage(&summary, 1) == 1;
+}
+
+void removeFirstDataFromStorage() {
+  removeBatchDataFromStorage(1);
+}
+
+int readBatchDataFromStorage(WindowSummary* summaries, int maxCount) {
+  StorageLock lock;
+  if (!logState.ready || maxCount <= 0) {
+    return 0;
+  }
+
+  uint32_t available = recordsInHeadSegment();
+  // 无法解码的旧段只能整段跳过
+  while (available > 0 && !loadHeadSegment()) {
+    Serial.print("[警告] 日志段 ");
+    Serial.print(logState.headSegment);
+    Serial.print(" 无法解码，跳过其中 ");
+    Serial.print(available);
+    Serial.println(" 条数据");
+    advanceHeadSegment();
+    writeLogIndex();
+    available = recordsInHeadSegment();
+  }
+
+  if (available == 0) {
+    // 日志已读空，最新的数据直接从暂存队列读取
+    int readCount = ((int)staging.count < maxCount) ? (int)staging.count : maxCount;
+    for (int i = 0; i < readCount; i++) {
+      summaries[i] = stagedRecord(i);
+    }
+    return readCount;
+  }
+
+  int readCount = ((int)available < maxCount) ? (int)available : maxCount;
+  const WindowSummary* records = (logState.headSegment == logState.tailSegment) ? tailRecords : headRecords;
+  memcpy(summaries, records + logState.headOffset, readCount * sizeof(WindowSummary));
+  return readCount;
+}
+
+void removeBatchDataFromStorage(int count) {
+  StorageLock lock;
+  if (!logState.ready || count <= 0) {
+    return;
+  }
+
+  uint32_t remaining = (uint32_t)count;
+  bool logConsumed = false;
+  while (remaining > 0) {
+    uint32_t available = recordsInHeadSegment();
+    if (available == 0) {
+      break;
+    }
+    uint32_t consumed = (remaining < available) ? remaining : available;
+    logState.headOffset += consumed;
+    remaining -= consumed;
+    logConsumed = true;
+
+    if (logState.headOffset >= LOG_SEGMENT_RECORDS) {
+      if (logState.headSegment == logState.tailSegment) {
+        logState.tailSegment++;
+        logState.tailCount = 0;
+      }
+      advanceHeadSegment();
+    }
+  }
+
+  if (logConsumed) {
+    writeLogIndex();
+  }
+  if (remaining > 0 && staging.count > 0) {
+    popStaged((remaining < staging.count) ? remaining : staging.count);
+  }
+}
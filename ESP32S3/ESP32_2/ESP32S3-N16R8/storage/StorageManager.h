@@ -2,10 +2,14 @@
 
 #include <Arduino.h>
 
-bool saveDataToStorage(float distanceCm, time_t timestamp);
+#include "../collector/WindowAggregator.h"
+
+bool beginStorage();
+bool saveDataToStorage(const WindowSummary& summary);
 int getStoredDataCount();
-bool readFirstDataFromStorage(float& distance, time_t& timestamp);
+bool readFirstDataFromStorage(WindowSummary& summary);
 void removeFirstDataFromStorage();
-int readBatchDataFromStorage(float* distances, time_t* timestamps, int maxCount);
+int readBatchDataFromStorage(WindowSummary* summaries, int maxCount);
 void removeBatchDataFromStorage(int count);
+bool flushStorage();
 
@@ -0,0 +1,306 @@
+#include "SummaryCodec.h"
+
+#include <math.h>
+
+namespace {
+constexpr size_t BLOCK_HEADER_SIZE = 4;
+
+// 每个块最多区分 15 个传感器，各自维护一套预测值；更多的传感器共用最后一个槽位，
+// 每次出现都写出完整的键
+constexpr uint8_t KEY_SLOT_BITS = 4;
+constexpr uint8_t KEY_SLOTS = 1 << KEY_SLOT_BITS;
+constexpr uint8_t SHARED_KEY_SLOT = KEY_SLOTS - 1;
+
+// 时间戳以外的列：跨度、条数与 7 个统计量
+constexpr int VALUE_COLUMNS = 9;
+
+// 变长整数（zigzag 编码）：前缀 0 / 10 / 110 / 1110 / 11110 / 11111
+// 分别表示 0 与 7、12、20、32、64 位的值
+constexpr uint8_t VALUE_BUCKET_BITS[] = {7, 12, 20, 32, 64};
+constexpr int VALUE_BUCKETS = sizeof(VALUE_BUCKET_BITS) / sizeof(VALUE_BUCKET_BITS[0]);
+
+// 单条记录的最坏情况：键 21 位，时间戳与每列各 5 位前缀 + 64 位
+constexpr size_t RECORD_WORST_CASE_BITS = 1 + KEY_SLOT_BITS + 16 + (1 + VALUE_COLUMNS) * (VALUE_BUCKETS + 64);
+
+struct BitWriter {
+  uint8_t* out;
+  size_t capacityBits;
+  size_t bitPos;
+  bool overflow;
+};
+
+struct BitReader {
+  const uint8_t* in;
+  size_t sizeBits;
+  size_t bitPos;
+  bool overrun;
+};
+
+void putBits(BitWriter& writer, uint64_t value, uint8_t bits) {
+  if (writer.bitPos + bits > writer.capacityBits) {
+    writer.overflow = true;
+    return;
+  }
+  while (bits > 0) {
+    size_t byteIndex = writer.bitPos >> 3;
+    uint8_t freeBits = 8 - (writer.bitPos & 7);
+    if (freeBits == 8) {
+      writer.out[byteIndex] = 0;
+    }
+    uint8_t take = bits < freeBits ? bits : freeBits;
+    uint8_t chunk = (uint8_t)((value >> (bits - take)) & ((1u << take) - 1));
+    writer.out[byteIndex] |= chunk << (freeBits - take);
+    writer.bitPos += take;
+    bits -= take;
+  }
+}
+
+uint64_t getBits(BitReader& reader, uint8_t bits) {
+  if (reader.bitPos + bits > reader.sizeBits) {
+    reader.overrun = true;
+    reader.bitPos = reader.sizeBits;
+    return 0;
+  }
+  uint64_t value = 0;
+  while (bits > 0) {
+    uint8_t availableBits = 8 - (reader.bitPos & 7);
+    uint8_t take = bits < availableBits ? bits : availableBits;
+    uint8_t chunk = (reader.in[reader.bitPos >> 3] >> (availableBits - take)) & ((1u << take) - 1);
+    value = (value << take) | chunk;
+    reader.bitPos += take;
+    bits -= take;
+  }
+  return value;
+}
+
+void putSigned(BitWriter& writer, int64_t value) {
+  uint64_t zigzag = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+  if (zigzag == 0) {
+    putBits(writer, 0, 1);
+    return;
+  }
+  for (int bucket = 0; bucket < VALUE_BUCKETS; bucket++) {
+    uint8_t bits = VALUE_BUCKET_BITS[bucket];
+    if (bits < 64 && zigzag >= (1ULL << bits)) {
+      continue;
+    }
+    // bucket + 1 个 1，最后一档之外再跟一个 0
+    uint8_t prefixBits = bucket + (bucket < VALUE_BUCKETS - 1 ? 2 : 1);
+    uint8_t prefix = (uint8_t)(((1u << (bucket + 1)) - 1) << (prefixBits - bucket - 1));
+    putBits(writer, prefix, prefixBits);
+    putBits(writer, zigzag, bits);
+    return;
+  }
+}
+
+int64_t getSigned(BitReader& reader) {
+  int ones = 0;
+  while (ones < VALUE_BUCKETS && getBits(reader, 1) == 1) {
+    ones++;
+  }
+  if (ones == 0) {
+    return 0;
+  }
+  uint64_t zigzag = getBits(reader, VALUE_BUCKET_BITS[ones - 1]);
+  return (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+}
+
+// 按首次出现的顺序为传感器键分配槽位，编码与解码两侧各自重建，结果一致
+struct KeySlotTable {
+  uint16_t keys[SHARED_KEY_SLOT];
+  uint8_t used;
+};
+
+int findKeySlot(const KeySlotTable& table, uint16_t key) {
+  for (uint8_t i = 0; i < table.used; i++) {
+    if (table.keys[i] == key) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+uint8_t assignKeySlot(KeySlotTable& table, uint16_t key) {
+  int slot = findKeySlot(table, key);
+  if (slot >= 0) {
+    return (uint8_t)slot;
+  }
+  if (table.used < SHARED_KEY_SLOT) {
+    table.keys[table.used] = key;
+    return table.used++;
+  }
+  return SHARED_KEY_SLOT;
+}
+
+struct SlotPredictor {
+  int64_t timestamp;
+  int64_t timestampDelta;
+  int64_t values[VALUE_COLUMNS];
+};
+
+int64_t toHundredths(float value) {
+  if (!(value == value)) {
+    return 0;
+  }
+  double scaled = value * 100.0;
+  if (scaled > 2147483647.0) {
+    return 2147483647;
+  }
+  if (scaled < -2147483648.0) {
+    return -2147483647 - 1;
+  }
+  return llround(scaled);
+}
+
+float fromHundredths(int64_t value) {
+  return (float)(value / 100.0);
+}
+
+int64_t columnValue(const WindowSummary& summary, int column) {
+  switch (column) {
+    case 0: return summary.spanMs;
+    case 1: return summary.count;
+    case 2: return toHundredths(summary.minCm);
+    case 3: return toHundredths(summary.maxCm);
+    case 4: return toHundredths(summary.meanCm);
+    case 5: return toHundredths(summary.stddevCm);
+    case 6: return toHundredths(summary.p50Cm);
+    case 7: return toHundredths(summary.p90Cm);
+    default: return toHundredths(summary.p99Cm);
+  }
+}
+
+void setColumnValue(WindowSummary& summary, int column, int64_t value) {
+  switch (column) {
+    case 0: summary.spanMs = (uint32_t)value; break;
+    case 1: summary.count = (uint16_t)value; break;
+    case 2: summary.minCm = fromHundredths(value); break;
+    case 3: summary.maxCm = fromHundredths(value); break;
+    case 4: summary.meanCm = fromHundredths(value); break;
+    case 5: summary.stddevCm = fromHundredths(value); break;
+    case 6: summary.p50Cm = fromHundredths(value); break;
+    case 7: summary.p90Cm = fromHundredths(value); break;
+    default: summary.p99Cm = fromHundredths(value); break;
+  }
+}
+
+// 差值按 64 位回绕运算，任何取值都能原样还原
+int64_t wrappingSub(int64_t a, int64_t b) {
+  return (int64_t)((uint64_t)a - (uint64_t)b);
+}
+
+int64_t wrappingAdd(int64_t a, int64_t b) {
+  return (int64_t)((uint64_t)a + (uint64_t)b);
+}
+}  // namespace
+
+size_t summaryBlockBound(uint32_t count) {
+  return BLOCK_HEADER_SIZE + (count * RECORD_WORST_CASE_BITS + 7) / 8;
+}
+
+size_t encodeSummaryBlock(const WindowSummary* summaries, uint32_t count, uint8_t* out, size_t capacity) {
+  if (count > UINT16_MAX || capacity < BLOCK_HEADER_SIZE) {
+    return 0;
+  }
+  BitWriter writer = {out + BLOCK_HEADER_SIZE, (capacity - BLOCK_HEADER_SIZE) * 8, 0, false};
+
+  // 传感器键列：与上一条相同写 0，否则写 1 + 槽位号，新出现的键再跟 16 位键值
+  KeySlotTable table = {};
+  for (uint32_t i = 0; i < count; i++) {
+    uint16_t key = summaries[i].sensorKey;
+    if (i > 0 && key == summaries[i - 1].sensorKey) {
+      putBits(writer, 0, 1);
+      continue;
+    }
+    int existing = findKeySlot(table, key);
+    uint8_t slot = assignKeySlot(table, key);
+    putBits(writer, 1, 1);
+    putBits(writer, slot, KEY_SLOT_BITS);
+    if (existing < 0) {
+      putBits(writer, key, 16);
+    }
+  }
+
+  // 时间戳列：二阶差分
+  SlotPredictor predictors[KEY_SLOTS] = {};
+  table = {};
+  for (uint32_t i = 0; i < count; i++) {
+    SlotPredictor& predictor = predictors[assignKeySlot(table, summaries[i].sensorKey)];
+    int64_t timestamp = (int64_t)summaries[i].timestamp;
+    int64_t delta = wrappingSub(timestamp, predictor.timestamp);
+    putSigned(writer, wrappingSub(delta, predictor.timestampDelta));
+    predictor.timestamp = timestamp;
+    predictor.timestampDelta = delta;
+  }
+
+  // 其余各列：一阶差分
+  for (int column = 0; column < VALUE_COLUMNS; column++) {
+    table = {};
+    for (uint32_t i = 0; i < count; i++) {
+      SlotPredictor& predictor = predictors[assignKeySlot(table, summaries[i].sensorKey)];
+      int64_t value = columnValue(summaries[i], column);
+      putSigned(writer, wrappingSub(value, predictor.values[column]));
+      predictor.values[column] = value;
+    }
+  }
+
+  size_t payloadBytes = (writer.bitPos + 7) / 8;
+  if (writer.overflow || payloadBytes > UINT16_MAX) {
+    return 0;
+  }
+  uint16_t header[2] = {(uint16_t)count, (uint16_t)payloadBytes};
+  memcpy(out, header, sizeof(header));
+  return BLOCK_HEADER_SIZE + payloadBytes;
+}
+
+uint32_t decodeSummaryBlock(const uint8_t* in, size_t size, WindowSummary* summaries, uint32_t maxCount) {
+  if (size < BLOCK_HEADER_SIZE) {
+    return 0;
+  }
+  uint16_t header[2];
+  memcpy(header, in, sizeof(header));
+  uint32_t count = header[0];
+  if (count > maxCount || BLOCK_HEADER_SIZE + (size_t)header[1] > size) {
+    return 0;
+  }
+  BitReader reader = {in + BLOCK_HEADER_SIZE, (size_t)header[1] * 8, 0, false};
+
+  KeySlotTable table = {};
+  for (uint32_t i = 0; i < count; i++) {
+    if (getBits(reader, 1) == 0) {
+      summaries[i].sensorKey = i > 0 ? summaries[i - 1].sensorKey : 0;
+      continue;
+    }
+    uint8_t slot = (uint8_t)getBits(reader, KEY_SLOT_BITS);
+    if (slot < table.used) {
+      summaries[i].sensorKey = table.keys[slot];
+    } else {
+      uint16_t key = (uint16_t)getBits(reader, 16);
+      summaries[i].sensorKey = key;
+      assignKeySlot(table, key);
+    }
+  }
+
+  SlotPredictor predictors[KEY_SLOTS] = {};
+  table = {};
+  for (uint32_t i = 0; i < count; i++) {
+    SlotPredictor& predictor = predictors[assignKeySlot(table, summaries[i].sensorKey)];
+    int64_t delta = wrappingAdd(predictor.timestampDelta, getSigned(reader));
+    int64_t timestamp = wrappingAdd(predictor.timestamp, delta);
+    summaries[i].timestamp = (time_t)timestamp;
+    predictor.timestamp = timestamp;
+    predictor.timestampDelta = delta;
+  }
+
+  for (int column = 0; column < VALUE_COLUMNS; column++) {
+    table = {};
+    for (uint32_t i = 0; i < count; i++) {
+      SlotPredictor& predictor = predictors[assignKeySlot(table, summaries[i].sensorKey)];
+      int64_t value = wrappingAdd(predictor.values[column], getSigned(reader));
+      setColumnValue(summaries[i], column, value);
+      predictor.values[column] = value;
+    }
+  }
+
+  return reader.overrun ? 0 : count;
+}
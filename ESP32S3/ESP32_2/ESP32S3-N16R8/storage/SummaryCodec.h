@@ -0,0 +1,22 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "../collector/WindowAggregator.h"
+
+// 窗口摘要的列式压缩编码（参考 Gorilla 时序压缩）：一个数据块内先按列排列，
+// 时间戳记录二阶差分，其余字段记录与同一传感器上一条记录的差值，再用变长前缀码写入比特流。
+// 按固定间隔产生的窗口二阶差分几乎总为 0，每条时间戳只需 1 比特。
+//
+// 统计量按 0.01 cm 定点存储：上传时统一保留两位小数，解码后上传的内容与原始值完全一致。
+//
+// 块格式：uint16 条数 + uint16 比特流字节数 + 比特流
+
+// count 条摘要编码后的最大字节数
+size_t summaryBlockBound(uint32_t count);
+
+// 返回写入的字节数；out 空间不足时返回 0
+size_t encodeSummaryBlock(const WindowSummary* summaries, uint32_t count, uint8_t* out, size_t capacity);
+
+// 返回解码的条数；数据残缺或条数超过 maxCount 时返回 0
+uint32_t decodeSummaryBlock(const uint8_t* in, size_t size, WindowSummary* summaries, uint32_t maxCount);
@@ -1,65 +1,165 @@
 #include "TimeUtils.h"
 
+#include <Preferences.h>
 #include <WiFi.h>
+#include <esp_sntp.h>
+#include <esp_timer.h>
+#include <sys/time.h>
 #include <time.h>
 
 #include "../config/Config.h"
 
 bool timeSynced = false;
 
-void syncNTPTime() {
-  if (WiFi.status() != WL_CONNECTED) {
-    Serial.println("[时间] WiFi 未连接，无法同步时间");
+namespace {
+constexpr time_t VALID_EPOCH_THRESHOLD = 1000000000;
+constexpr int BOOT_EPOCH_SLOTS = 8;
+
+Preferences timePrefs;
+uint32_t currentBoot = 0;
+volatile bool syncEventPending = false;
+bool sntpStarted = false;
+
+// 最近几次启动的"启动时刻对应的 Unix 时间"，用于换算上一次启动中未同步时采集的数据
+struct BootEpoch {
+  uint32_t boot;
+  int64_t epochSec;
+};
+BootEpoch bootEpochs[BOOT_EPOCH_SLOTS];
+
+int64_t wallClockUs() {
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  return (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+bool clockValid() {
+  return time(nullptr) > VALID_EPOCH_THRESHOLD;
+}
+
+int64_t currentBootEpochSec() {
+  return (wallClockUs() - esp_timer_get_time()) / 1000000LL;
+}
+
+void loadBootEpochs() {
+  char key[8];
+  for (int slot = 0; slot < BOOT_EPOCH_SLOTS; slot++) {
+    snprintf(key, sizeof(key), "b%d", slot);
+    bootEpochs[slot].boot = timePrefs.getUInt(key, 0);
+    snprintf(key, sizeof(key), "e%d", slot);
+    bootEpochs[slot].epochSec = (int64_t)timePrefs.getULong64(key, 0);
+  }
+}
+
+void persistBootEpoch() {
+  int slot = currentBoot % BOOT_EPOCH_SLOTS;
+  bootEpochs[slot].boot = currentBoot;
+  bootEpochs[slot].epochSec = currentBootEpochSec();
+
+  if (!timePrefs.begin(TIME_PREF_NAMESPACE, false)) {
     return;
   }
+  char key[8];
+  snprintf(key, sizeof(key), "b%d", slot);
+  timePrefs.putUInt(key, currentBoot);
+  snprintf(key, sizeof(key), "e%d", slot);
+  timePrefs.putULong64(key, (uint64_t)bootEpochs[slot].epochSec);
+  timePrefs.end();
+}
 
-  Serial.println("[时间] 正在同步 NTP 时间...");
-  configTime(GMT_OFFSET_SEC, DAYLIGHT_OFFSET_SEC, NTP_SERVER, "time.nist.gov", "time.google.com");
+// 在 lwIP 任务中回调，只记录状态，持久化与日志放到 serviceTimeSync 中进行
+void onTimeSynced(struct timeval*) {
+  timeSynced = true;
+  syncEventPending = true;
+}
+}  // namespace
 
-  int attempts = 0;
-  time_t now = 0;
-  while (attempts < 20) {
-    delay(500);
-    yield();
-    now = time(nullptr);
-    if (now > 1000000000) {
-      break;
-    }
-    attempts++;
+void beginTimeSync() {
+  if (timePrefs.begin(TIME_PREF_NAMESPACE, false)) {
+    currentBoot = timePrefs.getUInt("boot", 0) + 1;
+    timePrefs.putUInt("boot", currentBoot);
+    loadBootEpochs();
+    timePrefs.end();
   }
 
-  if (now > 1000000000) {
+  sntp_set_time_sync_notification_cb(onTimeSynced);
+
+  // 软件复位后 RTC 时钟仍然有效，无需等待 NTP
+  if (clockValid()) {
     timeSynced = true;
-    struct tm timeinfo;
-    localtime_r(&now, &timeinfo);
-    Serial.print("[时间] ✓ 时间同步成功: ");
-    Serial.print(timeinfo.tm_year + 1900);
-    Serial.print("-");
-    Serial.print(timeinfo.tm_mon + 1);
-    Serial.print("-");
-    Serial.print(timeinfo.tm_mday);
-    Serial.print(" ");
-    Serial.print(timeinfo.tm_hour);
-    Serial.print(":");
-    Serial.print(timeinfo.tm_min);
-    Serial.print(":");
-    Serial.println(timeinfo.tm_sec);
-  } else {
-    Serial.println("[时间] ✗ 时间同步失败");
-    timeSynced = false;
+    syncEventPending = true;
   }
 }
 
+// 启动（或在重新联网后重启）后台 SNTP 客户端，立即返回；
+// 同步结果通过回调通知，失败时 SNTP 客户端会自行重试
+void syncNTPTime() {
+  if (WiFi.status() != WL_CONNECTED) {
+    return;
+  }
+  if (!sntpStarted) {
+    Serial.println("[时间] 后台 NTP 同步已启动");
+  }
+  configTime(GMT_OFFSET_SEC, DAYLIGHT_OFFSET_SEC, NTP_SERVER, "time.nist.gov", "time.google.com");
+  sntpStarted = true;
+}
+
+void serviceTimeSync() {
+  if (!syncEventPending) {
+    return;
+  }
+  syncEventPending = false;
+  persistBootEpoch();
+
+  time_t now = time(nullptr);
+  Serial.print("[时间] ✓ 时间已同步: ");
+  Serial.print(formatDateTime(now));
+  Serial.print("，本次启动的未同步数据将换算为实际时间（启动序号 ");
+  Serial.print(currentBoot);
+  Serial.println("）");
+}
+
 time_t getCurrentTimestamp() {
   time_t now = time(nullptr);
-  if (now < 1000000000) {
+  if (now < VALID_EPOCH_THRESHOLD) {
     return 0;
   }
   return now;
 }
 
+// 以当前墙上时间倒推单调时刻对应的 Unix 时间；未同步时编码为启动序号 + 单调秒数
+time_t timestampFromMonotonic(int64_t monotonicUs) {
+  if (clockValid()) {
+    int64_t wallUs = wallClockUs() - (esp_timer_get_time() - monotonicUs);
+    return (time_t)(wallUs / 1000000LL);
+  }
+  uint64_t monotonicSec = (uint64_t)(monotonicUs / 1000000LL) & 0xFFFFFFFFULL;
+  return -(time_t)(((uint64_t)currentBoot << 32) | monotonicSec);
+}
+
+time_t resolveTimestamp(time_t timestamp) {
+  if (timestamp >= 0) {
+    return timestamp;
+  }
+
+  uint64_t encoded = (uint64_t)(-timestamp);
+  uint32_t boot = (uint32_t)(encoded >> 32);
+  int64_t monotonicSec = (int64_t)(encoded & 0xFFFFFFFFULL);
+
+  if (boot == currentBoot) {
+    return clockValid() ? timestampFromMonotonic(monotonicSec * 1000000LL) : timestamp;
+  }
+  for (int slot = 0; slot < BOOT_EPOCH_SLOTS; slot++) {
+    if (bootEpochs[slot].boot == boot && bootEpochs[slot].epochSec > 0) {
+      return (time_t)(bootEpochs[slot].epochSec + monotonicSec);
+    }
+  }
+  // 该次启动直到断电都没有同步过时间，无法换算
+  return 0;
+}
+
 String formatDateTime(time_t timestamp) {
-  if (timestamp == 0) {
+  if (timestamp <= 0) {
     return "";
   }
 
@@ -88,4 +188,3 @@ String formatDateTime(time_t timestamp) {
 
   return String(buffer);
 }
-
@@ -2,9 +2,17 @@
 
 #include <Arduino.h>
 
+// 时间戳约定：
+//   > 0  已同步的 Unix 时间（秒）
+//   < 0  采集时尚未同步，编码为 -(启动序号 << 32 | 启动后单调秒数)，同步后再换算成 Unix 时间
+//   = 0  无法换算（该次启动直到断电都没有同步过时间）
+
 extern bool timeSynced;
 
+void beginTimeSync();
 void syncNTPTime();
+void serviceTimeSync();
 time_t getCurrentTimestamp();
+time_t timestampFromMonotonic(int64_t monotonicUs);
+time_t resolveTimestamp(time_t timestamp);
 String formatDateTime(time_t timestamp);
-
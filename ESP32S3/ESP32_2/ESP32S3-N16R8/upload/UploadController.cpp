@@ -0,0 +1,227 @@
+#include "UploadController.h"
+
+#include <freertos/FreeRTOS.h>
+
+#include "../config/Config.h"
+#include "../network/WifiManager.h"
+
+namespace {
+constexpr float UPLOAD_EWMA_ALPHA = 0.3f;
+
+// 上传任务（核 0）按批更新，串口与配置服务（loop，核 1）读取或修改，访问都在锁内进行
+portMUX_TYPE uploadTuningLock = portMUX_INITIALIZER_UNLOCKED;
+UploadTuning uploadTuning = {UPLOAD_ADAPTIVE_ENABLED, BATCH_UPLOAD_SIZE, UPLOAD_CHECK_INTERVAL, UPLOAD_RECORD_DELAY_MS,
+                             UPLOAD_LATENCY_TARGET_MS};
+UploadControllerStats uploadControllerStats = {};
+
+char consoleLine[64];
+size_t consoleLength = 0;
+
+template <typename T>
+T clampValue(T value, T low, T high) {
+  return value < low ? low : (value > high ? high : value);
+}
+
+float ewma(float average, float sample, uint32_t samples) {
+  return samples == 0 ? sample : average + UPLOAD_EWMA_ALPHA * (sample - average);
+}
+
+void handleUploadCommand(const char* line) {
+  char command[16];
+  char key[16];
+  char value[24];
+  int fields = sscanf(line, "%15s %15s %23s", command, key, value);
+  if (fields < 1 || strcmp(command, "upload") != 0) {
+    return;
+  }
+  if (fields == 1) {
+    printUploadTuning();
+    return;
+  }
+  if (fields == 3 && applyUploadSetting(key, value)) {
+    printUploadTuning();
+    return;
+  }
+  Serial.println("[上传控制] 用法: upload | upload <auto|batch|interval|delay|target> <值>");
+  Serial.println("[上传控制] 例如: upload batch 120（手动设置前先 upload auto off，否则控制器会继续调整）");
+}
+
+String uploadTuningJson() {
+  UploadTuning tuning = getUploadTuning();
+  UploadControllerStats stats = getUploadControllerStats();
+  char json[256];
+  snprintf(json, sizeof(json),
+           "{\"auto\":%s,\"batch\":%d,\"interval\":%lu,\"delay\":%lu,\"target\":%lu,"
+           "\"recordsPerSec\":%.1f,\"latencyMs\":%.0f,\"errorRate\":%.3f,\"batches\":%lu}",
+           tuning.adaptive ? "true" : "false", tuning.batchSize, tuning.intervalMs, tuning.recordDelayMs,
+           tuning.latencyTargetMs, stats.recordsPerSec, stats.latencyMs, stats.errorRate,
+           (unsigned long)stats.batches);
+  return String(json);
+}
+}  // namespace
+
+UploadTuning getUploadTuning() {
+  portENTER_CRITICAL(&uploadTuningLock);
+  UploadTuning tuning = uploadTuning;
+  portEXIT_CRITICAL(&uploadTuningLock);
+  return tuning;
+}
+
+UploadControllerStats getUploadControllerStats() {
+  portENTER_CRITICAL(&uploadTuningLock);
+  UploadControllerStats stats = uploadControllerStats;
+  portEXIT_CRITICAL(&uploadTuningLock);
+  return stats;
+}
+
+int uploadBatchLimit(bool bulkMode) {
+  int limit = bulkMode ? BULK_UPLOAD_SIZE : BATCH_UPLOAD_SIZE;
+  int batchSize = getUploadTuning().batchSize;
+  return batchSize < limit ? batchSize : limit;
+}
+
+unsigned long uploadIntervalMs() {
+  return getUploadTuning().intervalMs;
+}
+
+unsigned long uploadRecordDelayMs() {
+  return getUploadTuning().recordDelayMs;
+}
+
+void recordUploadBatch(int records, int acknowledged, unsigned long elapsedMs, uint32_t requests, bool bulkMode) {
+  if (records <= 0) {
+    return;
+  }
+  float latency = (float)elapsedMs / (requests > 0 ? requests : 1);
+  float throughput = elapsedMs > 0 ? acknowledged * 1000.0f / elapsedMs : 0.0f;
+  bool failed = acknowledged < records;
+
+  portENTER_CRITICAL(&uploadTuningLock);
+  UploadControllerStats& stats = uploadControllerStats;
+  stats.recordsPerSec = ewma(stats.recordsPerSec, throughput, stats.batches);
+  stats.latencyMs = ewma(stats.latencyMs, latency, stats.batches);
+  stats.errorRate = ewma(stats.errorRate, failed ? 1.0f : 0.0f, stats.batches);
+  stats.batches++;
+
+  UploadTuning& tuning = uploadTuning;
+  int batchMax = bulkMode ? BULK_UPLOAD_SIZE : BATCH_UPLOAD_SIZE;
+  if (tuning.adaptive) {
+    if (failed || latency > tuning.latencyTargetMs) {
+      tuning.batchSize = clampValue((int)(tuning.batchSize * UPLOAD_BATCH_DECREASE), UPLOAD_BATCH_MIN, BULK_UPLOAD_SIZE);
+      if (failed) {
+        tuning.intervalMs = clampValue(tuning.intervalMs * 2, UPLOAD_INTERVAL_MIN_MS, UPLOAD_INTERVAL_MAX_MS);
+        if (!bulkMode) {
+          unsigned long delayMs = tuning.recordDelayMs > 0 ? tuning.recordDelayMs * 2 : UPLOAD_RECORD_DELAY_STEP_MS;
+          tuning.recordDelayMs = clampValue(delayMs, 0UL, UPLOAD_RECORD_DELAY_MAX_MS);
+        }
+      }
+      stats.decreases++;
+    } else {
+      // 只有整批用满时才增大批次，积压不足一批时成功不能说明链路还有余量
+      if (records >= tuning.batchSize && tuning.batchSize < batchMax) {
+        tuning.batchSize = clampValue(tuning.batchSize + UPLOAD_BATCH_INCREASE, UPLOAD_BATCH_MIN, batchMax);
+      }
+      tuning.intervalMs = tuning.intervalMs > UPLOAD_INTERVAL_MIN_MS + UPLOAD_INTERVAL_STEP_MS
+                              ? tuning.intervalMs - UPLOAD_INTERVAL_STEP_MS
+                              : UPLOAD_INTERVAL_MIN_MS;
+      if (!bulkMode) {
+        tuning.recordDelayMs = tuning.recordDelayMs > UPLOAD_RECORD_DELAY_STEP_MS
+                                   ? tuning.recordDelayMs - UPLOAD_RECORD_DELAY_STEP_MS
+                                   : 0;
+      }
+      stats.increases++;
+    }
+  }
+  portEXIT_CRITICAL(&uploadTuningLock);
+}
+
+bool applyUploadSetting(const char* key, const char* value) {
+  char* end = nullptr;
+  long number = strtol(value, &end, 10);
+  bool numeric = end != value && *end == '\0';
+  bool flag = strcmp(value, "on") == 0 || strcmp(value, "1") == 0 || strcmp(value, "true") == 0;
+  bool flagValid = flag || strcmp(value, "off") == 0 || strcmp(value, "0") == 0 || strcmp(value, "false") == 0;
+
+  bool applied = true;
+  portENTER_CRITICAL(&uploadTuningLock);
+  if (strcmp(key, "auto") == 0 && flagValid) {
+    uploadTuning.adaptive = flag;
+  } else if (strcmp(key, "batch") == 0 && numeric) {
+    uploadTuning.batchSize = (int)clampValue(number, (long)UPLOAD_BATCH_MIN, (long)BULK_UPLOAD_SIZE);
+  } else if (strcmp(key, "interval") == 0 && numeric) {
+    uploadTuning.intervalMs =
+        (unsigned long)clampValue(number, (long)UPLOAD_INTERVAL_MIN_MS, (long)UPLOAD_INTERVAL_MAX_MS);
+  } else if (strcmp(key, "delay") == 0 && numeric) {
+    uploadTuning.recordDelayMs = (unsigned long)clampValue(number, 0L, (long)UPLOAD_RECORD_DELAY_MAX_MS);
+  } else if (strcmp(key, "target") == 0 && numeric) {
+    uploadTuning.latencyTargetMs = (unsigned long)clampValue(number, 100L, (long)HTTP_TIMEOUT_MS);
+  } else {
+    applied = false;
+  }
+  portEXIT_CRITICAL(&uploadTuningLock);
+  return applied;
+}
+
+void printUploadTuning() {
+  UploadTuning tuning = getUploadTuning();
+  UploadControllerStats stats = getUploadControllerStats();
+  Serial.print("[上传控制] ");
+  Serial.print(tuning.adaptive ? "自动" : "手动");
+  Serial.print(": 批次 ");
+  Serial.print(tuning.batchSize);
+  Serial.print(" 条，间隔 ");
+  Serial.print(tuning.intervalMs);
+  Serial.print(" ms，逐条间隔 ");
+  Serial.print(tuning.recordDelayMs);
+  Serial.print(" ms，目标延迟 ");
+  Serial.print(tuning.latencyTargetMs);
+  Serial.println(" ms");
+  Serial.print("[上传控制] 实测: ");
+  Serial.print(stats.recordsPerSec, 1);
+  Serial.print(" 条/秒，请求耗时 ");
+  Serial.print(stats.latencyMs, 0);
+  Serial.print(" ms，失败率 ");
+  Serial.print(stats.errorRate * 100.0f, 1);
+  Serial.print("%（");
+  Serial.print(stats.batches);
+  Serial.print(" 批，增大 ");
+  Serial.print(stats.increases);
+  Serial.print(" 次，减小 ");
+  Serial.print(stats.decreases);
+  Serial.println(" 次）");
+}
+
+// 在 loop() 中调用，按行读取串口命令
+void serviceUploadConsole() {
+  while (Serial.available() > 0) {
+    char c = (char)Serial.read();
+    if (c == '\r' || c == '\n') {
+      if (consoleLength > 0) {
+        consoleLine[consoleLength] = '\0';
+        handleUploadCommand(consoleLine);
+        consoleLength = 0;
+      }
+      continue;
+    }
+    if (consoleLength < sizeof(consoleLine) - 1) {
+      consoleLine[consoleLength++] = c;
+    }
+  }
+}
+
+void handleUploadTuningGet() {
+  configServer.send(200, "application/json", uploadTuningJson());
+}
+
+// 表单字段与串口命令相同，例如 auto=0&batch=120
+void handleUploadTuningPost() {
+  static const char* const keys[] = {"auto", "batch", "interval", "delay", "target"};
+  for (const char* key : keys) {
+    if (configServer.hasArg(key) && !applyUploadSetting(key, configServer.arg(key).c_str())) {
+      configServer.send(400, "text/plain", String("无效的参数: ") + key);
+      return;
+    }
+  }
+  printUploadTuning();
+  configServer.send(200, "application/json", uploadTuningJson());
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <Arduino.h>
+
+// 上传速率自适应（AIMD）：每批上传后记录确认条数、请求耗时与吞吐量，
+//   - 整批确认且单个请求耗时不超过目标延迟 → 批次加性增大，上传间隔与逐条间隔加性减小；
+//   - 有失败或部分未确认 → 批次乘性减小，上传间隔与逐条间隔加倍退避；
+//   - 全部确认但请求耗时超过目标延迟 → 只减小批次，避免单个请求长时间占住上传任务。
+// 参数可在运行时通过串口命令 upload 或配置服务的 /upload 查看与修改（重启后恢复 Config.h 中的默认值）。
+
+struct UploadTuning {
+  bool adaptive;                  // 关闭后保持手动设置的参数不变
+  int batchSize;                  // 每次最多上传的条数（另受 BULK_UPLOAD_SIZE / BATCH_UPLOAD_SIZE 限制）
+  unsigned long intervalMs;       // 有积压时两批之间的间隔
+  unsigned long recordDelayMs;    // 逐条上传时两次请求之间的间隔
+  unsigned long latencyTargetMs;  // 单个请求的目标耗时
+};
+
+struct UploadControllerStats {
+  float recordsPerSec;  // 以下三项为指数滑动平均
+  float latencyMs;      // 单个请求的耗时
+  float errorRate;      // 有失败或未确认记录的批次比例
+  uint32_t batches;
+  uint32_t increases;
+  uint32_t decreases;
+};
+
+UploadTuning getUploadTuning();
+UploadControllerStats getUploadControllerStats();
+int uploadBatchLimit(bool bulkMode);
+unsigned long uploadIntervalMs();
+unsigned long uploadRecordDelayMs();
+// records 条中服务器确认了 acknowledged 条；elapsedMs 不含逐条上传之间的等待
+void recordUploadBatch(int records, int acknowledged, unsigned long elapsedMs, uint32_t requests, bool bulkMode);
+
+// key 为 auto / batch / interval / delay / target，超出范围的值被截断到边界
+bool applyUploadSetting(const char* key, const char* value);
+void printUploadTuning();
+void serviceUploadConsole();
+void handleUploadTuningGet();
+void handleUploadTuningPost();
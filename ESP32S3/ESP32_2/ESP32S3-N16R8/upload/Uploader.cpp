@@ -4,69 +4,318 @@
 #include <WiFi.h>
 #include <WiFiClientSecure.h>
 
+#include "../collector/SensorRegistry.h"
 #include "../config/Config.h"
+#include "../memory/JsonArena.h"
 #include "../storage/StorageManager.h"
 #include "../time/TimeUtils.h"
+#include "UploadController.h"
+
+namespace {
+// 服务器不支持批量接口时退回逐条上传，过一段时间再重新尝试批量接口
+bool bulkEndpointUnavailable = false;
+unsigned long bulkUnavailableSince = 0;
+
+// 长连接：HTTPClient 与底层 TCP/TLS 客户端在整个运行期间只创建一次，
+// 开启 HTTP/1.1 keep-alive 后 end() 只结束本次请求，不会关闭套接字。
+// 注意 HTTPClient 析构时会关闭连接，所以不能在函数内部创建临时对象。
+HTTPClient httpSession;
+WiFiClient plainClient;
+WiFiClientSecure secureClient;
+bool secureClientConfigured = false;
+unsigned long lastRequestAt = 0;
+uint32_t connectionsOpened = 0;
+uint32_t requestsSent = 0;
+
+WiFiClient& transportFor(bool useHTTPS) {
+  if (!useHTTPS) {
+    return plainClient;
+  }
+  if (!secureClientConfigured) {
+    secureClient.setInsecure();
+    secureClientConfigured = true;
+  }
+  return secureClient;
+}
 
-bool isUploading = false;
+void closeHttpSession() {
+  plainClient.stop();
+  secureClient.stop();
+}
 
-bool uploadSingleData(float distanceCm, time_t timestamp) {
-  if (WiFi.status() != WL_CONNECTED) {
-    return false;
+// 发送一次 API 请求，响应体总是读完，保证连接可以复用。
+// 复用的连接可能已被服务器悄悄关闭：此时请求在发送或读取响应头时失败，
+// 关闭连接后在新连接上透明地重试一次。
+int sendApiRequest(const char* method, const String& url, const String& payload, String* responseBody) {
+  bool useHTTPS = url.startsWith("https://");
+  WiFiClient& transport = transportFor(useHTTPS);
+
+  // 超过空闲时间的连接大概率已被服务器回收，主动关闭以免首个请求失败
+  if (transport.connected() && millis() - lastRequestAt >= HTTP_KEEPALIVE_IDLE_MS) {
+    closeHttpSession();
   }
 
-  if (!timeSynced) {
-    syncNTPTime();
+  for (int attempt = 0; attempt < 2; attempt++) {
+    bool reused = transport.connected();
+    if (!reused) {
+      connectionsOpened++;
+    }
+    if (!httpSession.begin(transport, url)) {
+      return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+    httpSession.setReuse(true);
+    httpSession.setTimeout(HTTP_TIMEOUT_MS);
+    httpSession.addHeader("X-API-Key", API_KEY);
+    httpSession.addHeader("Content-Type", "application/json");
+
+    int httpCode = httpSession.sendRequest(method, payload);
+    String body = (httpCode > 0) ? httpSession.getString() : String();
+    httpSession.end();
+    lastRequestAt = millis();
+    requestsSent++;
+
+    if (httpCode < 0) {
+      closeHttpSession();
+      if (reused && attempt == 0) {
+        Serial.println("[HTTP] 复用的连接已失效，重新建立连接");
+        continue;
+      }
+    }
+    if (responseBody) {
+      *responseBody = body;
+    }
+    return httpCode;
   }
+  return HTTPC_ERROR_CONNECTION_LOST;
+}
 
-  if (timestamp == 0) {
-    timestamp = getCurrentTimestamp();
+// 采集时尚未同步时间的数据要等同步后换算成实际时间再上传；
+// 启动后长时间同步不上（例如网络屏蔽了 NTP）则不再等待，按无时间戳上传
+bool resolveForUpload(time_t& timestamp) {
+  timestamp = resolveTimestamp(timestamp);
+  if (timestamp >= 0) {
+    return true;
   }
+  if (millis() < TIME_SYNC_UPLOAD_GRACE_MS) {
+    return false;
+  }
+  timestamp = 0;
+  return true;
+}
+
+// 传感器的接口地址：API_BASE_URL + 注册表中的端点 + 传感器 ID + 后缀
+String sensorUrl(int sensor, const char* suffix) {
+  return String(API_BASE_URL) + SENSOR_TABLE[sensor].endpoint + SENSOR_TABLE[sensor].id + suffix;
+}
 
-  String url = String(API_BASE_URL) + "/device/ultrasonicSensor/" + String(ULTRASONIC_SENSOR_ID) + "/";
+// 注册表中已删除的传感器留下的数据无处可传，只能丢弃
+void warnUnknownSensor(uint16_t key) {
+  Serial.print("[上传] ⚠️ 未知的传感器键 0x");
+  Serial.print(key, HEX);
+  Serial.println("（注册表中已不存在），丢弃该条数据");
+}
 
-  String payload = "{\"currentDistance\":";
-  payload += String(distanceCm, 2);
+// 每条窗口摘要的 JSON 大小：外层 3 个字段 + window 对象 9 个字段，另加复制进文档的字符串
+constexpr size_t SUMMARY_JSON_SIZE = JSON_OBJECT_SIZE(3) + JSON_OBJECT_SIZE(9) + 160;
 
+// currentDistance 取窗口中位数，对偶发的错误回波不敏感；完整统计量放在 window 对象中
+void fillSummaryJson(JsonObject item, const WindowSummary& summary, time_t timestamp) {
+  item["currentDistance"] = serialized(String(summary.p50Cm, 2));
   if (timestamp > 0) {
-    String dateTimeStr = formatDateTime(timestamp);
-    if (dateTimeStr.length() > 0) {
-      payload += ",\"dataUpdatedAt\":\"";
-      payload += dateTimeStr;
-      payload += "\"";
-    }
+    item["dataUpdatedAt"] = formatDateTime(timestamp);
   }
+  JsonObject window = item.createNestedObject("window");
+  window["seconds"] = serialized(String(summary.spanMs / 1000.0, 1));
+  window["count"] = summary.count;
+  window["min"] = serialized(String(summary.minCm, 2));
+  window["max"] = serialized(String(summary.maxCm, 2));
+  window["mean"] = serialized(String(summary.meanCm, 2));
+  window["stddev"] = serialized(String(summary.stddevCm, 2));
+  window["p50"] = serialized(String(summary.p50Cm, 2));
+  window["p90"] = serialized(String(summary.p90Cm, 2));
+  window["p99"] = serialized(String(summary.p99Cm, 2));
+}
 
-  payload += "}";
+bool bulkUploadAvailable() {
+  if (!BULK_UPLOAD_ENABLED) {
+    return false;
+  }
+  if (bulkEndpointUnavailable && millis() - bulkUnavailableSince >= BULK_UPLOAD_RETRY_MS) {
+    bulkEndpointUnavailable = false;
+  }
+  return !bulkEndpointUnavailable;
+}
 
-  bool useHTTPS = url.startsWith("https://");
+// 解析批量接口的确认：
+//   空响应体                     → 整批确认
+//   {"accepted": N}              → 确认前 N 条（水位线）
+//   {"results": [true, 201, ...]} → 逐条结果，取从头开始连续成功的前缀
+int parseBulkAcknowledgement(const String& body, int sentCount) {
+  if (body.length() == 0) {
+    return sentCount;
+  }
 
-  HTTPClient http;
-  http.setTimeout(10000);
+  ArenaJsonDocument doc(BULK_ACK_DOC_SIZE);
+  DeserializationError error = deserializeJson(doc, body);
+  if (error) {
+    Serial.print("[批量上传] 无法解析确认响应: ");
+    Serial.println(error.c_str());
+    return 0;
+  }
 
-  bool beginResult = false;
-  if (useHTTPS) {
-    static WiFiClientSecure secureClient;
-    secureClient.setInsecure();
-    secureClient.setTimeout(10000);
-    beginResult = http.begin(secureClient, url);
+  int acknowledged = 0;
+  if (doc.containsKey("accepted")) {
+    acknowledged = doc["accepted"].as<int>();
+  } else if (doc.containsKey("results")) {
+    JsonArray results = doc["results"].as<JsonArray>();
+    for (JsonVariant result : results) {
+      bool accepted = result.is<bool>() ? result.as<bool>()
+                                        : (result.as<int>() >= 200 && result.as<int>() < 300);
+      if (!accepted) {
+        break;
+      }
+      acknowledged++;
+    }
   } else {
-    static WiFiClient client;
-    client.setTimeout(10000);
-    beginResult = http.begin(client, url);
+    acknowledged = sentCount;
+  }
+
+  if (acknowledged < 0) {
+    acknowledged = 0;
+  }
+  return (acknowledged < sentCount) ? acknowledged : sentCount;
+}
+
+// 一个传感器的数据以一个 JSON 数组 POST 到该传感器的批量接口，返回服务器确认的前缀条数；
+// 返回 -1 表示服务器不支持批量接口
+int postSensorBatch(int sensor, const WindowSummary* summaries, const int* indices, int count) {
+  ArenaJsonDocument doc(JSON_ARRAY_SIZE(count) + count * SUMMARY_JSON_SIZE);
+  JsonArray items = doc.to<JsonArray>();
+  for (int i = 0; i < count; i++) {
+    const WindowSummary& summary = summaries[indices[i]];
+    fillSummaryJson(items.createNestedObject(), summary, summary.timestamp);
+  }
+  if (doc.overflowed()) {
+    Serial.println("[批量上传] JSON 内存池不足，无法构建请求");
+    return 0;
   }
 
-  if (!beginResult) {
+  String payload;
+  payload.reserve(measureJson(doc) + 1);
+  serializeJson(doc, payload);
+
+  String body;
+  int httpCode = sendApiRequest("POST", sensorUrl(sensor, BULK_UPLOAD_PATH), payload, &body);
+
+  if (httpCode == 404 || httpCode == 405 || httpCode == 501) {
+    return -1;
+  }
+  if (httpCode == HTTP_CODE_OK || httpCode == 201 || httpCode == 202 || httpCode == HTTP_CODE_NO_CONTENT ||
+      httpCode == HTTP_CODE_MULTI_STATUS) {
+    return parseBulkAcknowledgement(body, count);
+  }
+
+  Serial.print("[批量上传] ");
+  Serial.print(SENSOR_TABLE[sensor].id);
+  Serial.print(" 失败，状态码: ");
+  Serial.print(httpCode);
+  Serial.print(" (");
+  Serial.print(HTTPClient::errorToString(httpCode));
+  Serial.println(")");
+  return 0;
+}
+
+// 批量上传：按传感器分组，每个传感器一个请求。存储只能从头删除，所以返回的是原批次中
+// 从头开始连续被确认的条数（某条记录在其分组中的位置小于该组的确认数即视为已确认）。
+// 分组按在批次中首次出现的顺序上传，某组未被完整确认时立即停止：排在它后面的分组
+// 反正删不掉，不再上传，免得已被接受的记录下次重发（无时间戳的记录服务器无法去重）。
+// 只有排在缺口之后、属于先前分组的记录会被重发。
+// 未知传感器的记录视为已处理并丢弃。返回 -1 表示服务器不支持批量接口
+int uploadBatchData(const WindowSummary* summaries, int count) {
+  int* groupOf = new int[count];
+  int* positionInGroup = new int[count];
+  int* indices = new int[count];
+  int groupSize[SENSOR_COUNT] = {};
+  int groupAcknowledged[SENSOR_COUNT] = {};
+  int groupOrder[SENSOR_COUNT];
+  int groupCount = 0;
+
+  for (int i = 0; i < count; i++) {
+    groupOf[i] = findSensorByKey(summaries[i].sensorKey);
+    if (groupOf[i] >= 0) {
+      if (groupSize[groupOf[i]] == 0) {
+        groupOrder[groupCount++] = groupOf[i];
+      }
+      positionInGroup[i] = groupSize[groupOf[i]]++;
+    }
+  }
+
+  bool anyPosted = false;
+  bool unsupported = false;
+  for (int g = 0; g < groupCount; g++) {
+    int sensor = groupOrder[g];
+    int recordCount = 0;
+    for (int i = 0; i < count; i++) {
+      if (groupOf[i] == sensor) {
+        indices[recordCount++] = i;
+      }
+    }
+
+    int acknowledged = postSensorBatch(sensor, summaries, indices, recordCount);
+    if (acknowledged < 0) {
+      // 第一个请求就不被支持时整批改为逐条上传；之后的分组出现时按未确认处理
+      unsupported = !anyPosted;
+      break;
+    }
+    anyPosted = true;
+    groupAcknowledged[sensor] = acknowledged;
+    if (acknowledged < recordCount) {
+      break;
+    }
+  }
+
+  int prefix = 0;
+  while (prefix < count) {
+    int sensor = groupOf[prefix];
+    if (sensor < 0) {
+      warnUnknownSensor(summaries[prefix].sensorKey);
+    } else if (positionInGroup[prefix] >= groupAcknowledged[sensor]) {
+      break;
+    }
+    prefix++;
+  }
+
+  delete[] indices;
+  delete[] positionInGroup;
+  delete[] groupOf;
+  return unsupported && prefix == 0 ? -1 : prefix;
+}
+}  // namespace
+
+bool isUploading = false;
+
+bool uploadSingleData(const WindowSummary& summary) {
+  if (WiFi.status() != WL_CONNECTED) {
     return false;
   }
 
-  http.addHeader("X-API-Key", API_KEY);
-  http.addHeader("Content-Type", "application/json");
-  http.addHeader("Connection", "close");
+  time_t timestamp = summary.timestamp;
+  if (!resolveForUpload(timestamp)) {
+    return false;
+  }
+
+  int sensor = findSensorByKey(summary.sensorKey);
+  if (sensor < 0) {
+    warnUnknownSensor(summary.sensorKey);
+    return true;
+  }
+
+  ArenaJsonDocument doc(SUMMARY_JSON_SIZE);
+  fillSummaryJson(doc.to<JsonObject>(), summary, timestamp);
+  String payload;
+  serializeJson(doc, payload);
 
-  int httpCode = http.PATCH(payload);
-  String httpError = http.errorToString(httpCode);
-  http.end();
+  int httpCode = sendApiRequest("PATCH", sensorUrl(sensor, "/"), payload, nullptr);
 
   if (httpCode == HTTP_CODE_OK || httpCode == HTTP_CODE_NO_CONTENT || httpCode == 200 || httpCode == 204) {
     return true;
@@ -75,7 +324,7 @@ bool uploadSingleData(float distanceCm, time_t timestamp) {
   Serial.print("[HTTP] 上传失败，状态码: ");
   Serial.print(httpCode);
   Serial.print(" (");
-  Serial.print(httpError);
+  Serial.print(HTTPClient::errorToString(httpCode));
   Serial.println(")");
 
   return false;
@@ -97,16 +346,29 @@ void uploadLocalData() {
 
   isUploading = true;
 
-  int batchSize = (storedCount < BATCH_UPLOAD_SIZE) ? storedCount : BATCH_UPLOAD_SIZE;
+  bool bulkMode = bulkUploadAvailable();
+  int batchLimit = uploadBatchLimit(bulkMode);
+  int batchSize = (storedCount < batchLimit) ? storedCount : batchLimit;
+
+  WindowSummary* summaries = new WindowSummary[batchSize];
 
-  float* distances = new float[batchSize];
-  time_t* timestamps = new time_t[batchSize];
+  int readCount = readBatchDataFromStorage(summaries, batchSize);
 
-  int readCount = readBatchDataFromStorage(distances, timestamps, batchSize);
+  int readyCount = 0;
+  while (readyCount < readCount && resolveForUpload(summaries[readyCount].timestamp)) {
+    readyCount++;
+  }
+  if (readyCount == 0 && readCount > 0) {
+    static bool waitAnnounced = false;
+    if (!waitAnnounced) {
+      Serial.println("[批量上传] 积压数据采集于时间同步之前，等待同步后换算时间再上传");
+      waitAnnounced = true;
+    }
+  }
+  readCount = readyCount;
 
   if (readCount == 0) {
-    delete[] distances;
-    delete[] timestamps;
+    delete[] summaries;
     isUploading = false;
     return;
   }
@@ -115,25 +377,60 @@ void uploadLocalData() {
   Serial.print(readCount);
   Serial.print(" 条数据（剩余 ");
   Serial.print(storedCount);
-  Serial.println(" 条）");
+  Serial.print(" 条）");
+  Serial.println(bulkMode ? "，批量接口（每个传感器一个请求）" : "，逐条上传");
 
   int successCount = 0;
   int failCount = 0;
+  int perRecordCount = readCount;
+
+  if (bulkMode) {
+    unsigned long startedAt = millis();
+    uint32_t requestsBefore = requestsSent;
+    int acknowledged = uploadBatchData(summaries, readCount);
+    if (acknowledged < 0) {
+      Serial.println("[批量上传] 服务器不支持批量接口，暂时改为逐条上传");
+      bulkEndpointUnavailable = true;
+      bulkUnavailableSince = millis();
+      int perRecordLimit = uploadBatchLimit(false);
+      perRecordCount = (readCount < perRecordLimit) ? readCount : perRecordLimit;
+    } else {
+      recordUploadBatch(readCount, acknowledged, millis() - startedAt, requestsSent - requestsBefore, true);
+      successCount = acknowledged;
+      failCount = readCount - acknowledged;
+      Serial.print("[批量上传] 服务器确认 ");
+      Serial.print(acknowledged);
+      Serial.print("/");
+      Serial.print(readCount);
+      Serial.print(" 条，耗时 ");
+      Serial.print(millis() - startedAt);
+      Serial.println(" ms");
+      perRecordCount = 0;
+    }
+  }
 
-  for (int i = 0; i < readCount; i++) {
+  unsigned long perRecordStartedAt = millis();
+  unsigned long perRecordPacingMs = 0;
+  uint32_t perRecordRequestsBefore = requestsSent;
+  for (int i = 0; i < perRecordCount; i++) {
     Serial.print("[上传] 第 ");
     Serial.print(i + 1);
     Serial.print("/");
-    Serial.print(readCount);
+    Serial.print(perRecordCount);
     Serial.print(" 条: ");
-    Serial.print(distances[i], 2);
-    Serial.print(" cm");
-    if (timestamps[i] > 0) {
+    int sensor = findSensorByKey(summaries[i].sensorKey);
+    Serial.print(sensor >= 0 ? SENSOR_TABLE[sensor].id : "(未知传感器)");
+    Serial.print(" 中位数 ");
+    Serial.print(summaries[i].p50Cm, 2);
+    Serial.print(" cm（");
+    Serial.print(summaries[i].count);
+    Serial.print(" 条读数）");
+    if (summaries[i].timestamp > 0) {
       Serial.print(", 时间: ");
-      Serial.print(formatDateTime(timestamps[i]));
+      Serial.print(formatDateTime(summaries[i].timestamp));
     }
 
-    if (uploadSingleData(distances[i], timestamps[i])) {
+    if (uploadSingleData(summaries[i])) {
       successCount++;
       Serial.println(" ✓ 成功");
     } else {
@@ -143,7 +440,13 @@ void uploadLocalData() {
       break;
     }
 
-    delay(100);
+    unsigned long pacingMs = uploadRecordDelayMs();
+    delay(pacingMs);
+    perRecordPacingMs += pacingMs;
+  }
+  if (perRecordCount > 0) {
+    recordUploadBatch(successCount + failCount, successCount, millis() - perRecordStartedAt - perRecordPacingMs,
+                      requestsSent - perRecordRequestsBefore, false);
   }
 
   if (successCount > 0) {
@@ -153,8 +456,7 @@ void uploadLocalData() {
     Serial.println(" 条已成功上传的数据");
   }
 
-  delete[] distances;
-  delete[] timestamps;
+  delete[] summaries;
 
   int remainingCount = getStoredDataCount();
   Serial.print("[统计] 本次上传: 成功 ");
@@ -167,7 +469,11 @@ void uploadLocalData() {
   }
   Serial.print(" | 剩余待上传: ");
   Serial.print(remainingCount);
-  Serial.println(" 条\n");
+  Serial.print(" 条 | 累计请求 ");
+  Serial.print(requestsSent);
+  Serial.print(" 次，建立连接 ");
+  Serial.print(connectionsOpened);
+  Serial.println(" 次\n");
 
   isUploading = false;
 }
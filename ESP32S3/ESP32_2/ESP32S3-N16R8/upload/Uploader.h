@@ -2,8 +2,10 @@
 
 #include <Arduino.h>
 
+#include "../collector/WindowAggregator.h"
+
 extern bool isUploading;
 
-bool uploadSingleData(float distanceCm, time_t timestamp);
+bool uploadSingleData(const WindowSummary& summary);
 void uploadLocalData();
 
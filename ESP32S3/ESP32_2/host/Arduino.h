@@ -0,0 +1,10 @@
+#pragma once
+
+// 主机（PC）编译用的最小 Arduino.h：只提供 storage/SummaryCodec 与 config/Config.h 用到的标准头文件，
+// 让编解码器脱离 ESP32 工具链用普通 g++ 编译、测试与测速
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
@@ -0,0 +1,188 @@
+// SummaryCodec 主机测试：往返一致性检查 + 编解码速度与压缩率测试
+//
+// 在 ESP32S3/ESP32_2 目录下编译运行：
+//   g++ -std=gnu++17 -O2 -Ihost host/summary_codec_test.cpp ESP32S3-N16R8/storage/SummaryCodec.cpp -o summary_codec_test && ./summary_codec_test
+//
+// 全部检查通过时返回 0，否则打印失败项并返回 1。
+
+#include <chrono>
+#include <random>
+#include <stdio.h>
+#include <vector>
+
+#include "../ESP32S3-N16R8/storage/SummaryCodec.h"
+
+namespace {
+int failures = 0;
+
+#define CHECK(condition)                                               \
+  do {                                                                 \
+    if (!(condition)) {                                                \
+      printf("[失败] %s:%d: %s\n", __FILE__, __LINE__, #condition);    \
+      failures++;                                                      \
+    }                                                                  \
+  } while (0)
+
+// 上传时统计量保留两位小数，按上传格式比较，与设备上的“解码后上传内容不变”一致
+bool sameAsUploaded(float a, float b) {
+  char left[32];
+  char right[32];
+  snprintf(left, sizeof(left), "%.2f", a);
+  snprintf(right, sizeof(right), "%.2f", b);
+  return strcmp(left, right) == 0;
+}
+
+bool sameSummary(const WindowSummary& a, const WindowSummary& b) {
+  return a.timestamp == b.timestamp && a.spanMs == b.spanMs && a.sensorKey == b.sensorKey && a.count == b.count &&
+         sameAsUploaded(a.minCm, b.minCm) && sameAsUploaded(a.maxCm, b.maxCm) &&
+         sameAsUploaded(a.meanCm, b.meanCm) && sameAsUploaded(a.stddevCm, b.stddevCm) &&
+         sameAsUploaded(a.p50Cm, b.p50Cm) && sameAsUploaded(a.p90Cm, b.p90Cm) && sameAsUploaded(a.p99Cm, b.p99Cm);
+}
+
+// 模拟 sensors 个传感器轮流产生的 60 秒窗口：液位缓慢漂移，读数带噪声，偶尔有 1 秒的时间抖动
+std::vector<WindowSummary> simulateWindows(uint32_t count, uint16_t sensors, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::normal_distribution<float> noise(0.0f, 0.3f);
+  std::uniform_int_distribution<int> jitter(0, 19);
+  std::vector<WindowSummary> windows(count);
+  std::vector<float> level(sensors);
+  for (uint16_t s = 0; s < sensors; s++) {
+    level[s] = 80.0f + 25.0f * s;
+  }
+  time_t now = 1760000000;
+  for (uint32_t i = 0; i < count; i++) {
+    uint16_t s = i % sensors;
+    if (s == 0) {
+      now += 60 + (jitter(rng) == 0 ? 1 : 0);
+    }
+    level[s] += 0.02f + noise(rng) * 0.1f;
+    float mean = roundf((level[s] + noise(rng)) * 100.0f) / 100.0f;
+    WindowSummary& w = windows[i];
+    w.timestamp = now;
+    w.spanMs = 59900 + jitter(rng);
+    w.sensorKey = (uint16_t)(0x1234 + s * 0x0101);
+    w.count = 600;
+    w.minCm = mean - 0.8f;
+    w.maxCm = mean + 0.9f;
+    w.meanCm = mean;
+    w.stddevCm = 0.31f;
+    w.p50Cm = mean;
+    w.p90Cm = mean + 0.4f;
+    w.p99Cm = mean + 0.7f;
+  }
+  return windows;
+}
+
+std::vector<WindowSummary> roundTrip(const std::vector<WindowSummary>& input, size_t* encodedBytes = nullptr) {
+  std::vector<uint8_t> block(summaryBlockBound((uint32_t)input.size()));
+  size_t written = encodeSummaryBlock(input.data(), (uint32_t)input.size(), block.data(), block.size());
+  if (encodedBytes) {
+    *encodedBytes = written;
+  }
+  std::vector<WindowSummary> output(input.size() + 1);
+  uint32_t decoded = decodeSummaryBlock(block.data(), written, output.data(), (uint32_t)output.size());
+  output.resize(written == 0 ? 0 : decoded);
+  return output;
+}
+
+bool sameBlock(const std::vector<WindowSummary>& a, const std::vector<WindowSummary>& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); i++) {
+    if (!sameSummary(a[i], b[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void testRoundTrip() {
+  for (uint16_t sensors : {1, 4, 20}) {
+    std::vector<WindowSummary> input = simulateWindows(LOG_SEGMENT_RECORDS, sensors, 7 + sensors);
+    CHECK(sameBlock(input, roundTrip(input)));
+  }
+
+  std::vector<WindowSummary> single = simulateWindows(1, 1, 1);
+  CHECK(sameBlock(single, roundTrip(single)));
+
+  // 极端取值：旧版数据的键 0、时间戳回退、负数与越界统计量、NaN
+  std::vector<WindowSummary> extremes = simulateWindows(6, 2, 3);
+  extremes[0].sensorKey = 0;
+  extremes[1].timestamp = 0;
+  extremes[2].timestamp = extremes[1].timestamp - 3600;
+  extremes[3].spanMs = UINT32_MAX;
+  extremes[3].count = UINT16_MAX;
+  extremes[4].minCm = -12.34f;
+  extremes[4].maxCm = 9999.99f;
+  std::vector<WindowSummary> decoded = roundTrip(extremes);
+  CHECK(sameBlock(extremes, decoded));
+
+  extremes[5].meanCm = NAN;
+  decoded = roundTrip(extremes);
+  CHECK(decoded.size() == extremes.size() && decoded[5].meanCm == 0.0f);
+}
+
+void testRejectsBadInput() {
+  std::vector<WindowSummary> input = simulateWindows(32, 2, 11);
+  std::vector<uint8_t> block(summaryBlockBound((uint32_t)input.size()));
+  size_t written = encodeSummaryBlock(input.data(), (uint32_t)input.size(), block.data(), block.size());
+  CHECK(written > 0);
+  CHECK(encodeSummaryBlock(input.data(), (uint32_t)input.size(), block.data(), written - 1) == 0);
+
+  std::vector<WindowSummary> output(input.size());
+  CHECK(decodeSummaryBlock(block.data(), written, output.data(), (uint32_t)input.size() - 1) == 0);
+  CHECK(decodeSummaryBlock(block.data(), written - 1, output.data(), (uint32_t)output.size()) == 0);
+  CHECK(decodeSummaryBlock(block.data(), 3, output.data(), (uint32_t)output.size()) == 0);
+}
+
+// 按 blockRecords 条一块编码同一段数据：整段一块（旧段、迁移）与每次提交一块（暂存提交）
+void benchmark(uint16_t sensors, uint32_t blockRecords) {
+  const int ROUNDS = 200;
+  std::vector<WindowSummary> input = simulateWindows(LOG_SEGMENT_RECORDS, sensors, 42);
+  std::vector<uint8_t> block(summaryBlockBound(blockRecords));
+  std::vector<WindowSummary> output(blockRecords);
+
+  double encodeNs = 0;
+  double decodeNs = 0;
+  size_t written = 0;
+  uint32_t decoded = 0;
+  for (uint32_t offset = 0; offset < LOG_SEGMENT_RECORDS; offset += blockRecords) {
+    uint32_t count = LOG_SEGMENT_RECORDS - offset < blockRecords ? LOG_SEGMENT_RECORDS - offset : blockRecords;
+    size_t blockBytes = 0;
+    auto encodeStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; i++) {
+      blockBytes = encodeSummaryBlock(input.data() + offset, count, block.data(), block.size());
+    }
+    auto encodeEnd = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; i++) {
+      decoded += decodeSummaryBlock(block.data(), blockBytes, output.data(), count);
+    }
+    auto decodeEnd = std::chrono::steady_clock::now();
+    written += blockBytes;
+    encodeNs += std::chrono::duration<double, std::nano>(encodeEnd - encodeStart).count();
+    decodeNs += std::chrono::duration<double, std::nano>(decodeEnd - encodeEnd).count();
+  }
+  CHECK(decoded == (uint32_t)ROUNDS * LOG_SEGMENT_RECORDS);
+
+  double records = (double)ROUNDS * LOG_SEGMENT_RECORDS;
+  printf("%2u 个传感器、每块 %3u 条: 每条 %.1f 字节（未压缩 %zu 字节），编码 %.0f ns/条，解码 %.0f ns/条\n", sensors,
+         blockRecords, (double)written / LOG_SEGMENT_RECORDS, sizeof(WindowSummary), encodeNs / records,
+         decodeNs / records);
+}
+}  // namespace
+
+int main() {
+  testRoundTrip();
+  testRejectsBadInput();
+  benchmark(1, LOG_SEGMENT_RECORDS);
+  benchmark(4, LOG_SEGMENT_RECORDS);
+  benchmark(1, STAGING_COMMIT_RECORDS);
+  benchmark(4, STAGING_COMMIT_RECORDS);
+  if (failures > 0) {
+    printf("%d 项检查失败\n", failures);
+    return 1;
+  }
+  printf("全部检查通过\n");
+  return 0;
+}